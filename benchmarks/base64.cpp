@@ -0,0 +1,58 @@
+// base64 decoding: the table/SIMD decoder, returning a vector or writing
+// into the caller's buffer, vs. the find()-based decoder it replaced.
+
+#include "fixtures.h"
+#include "heap.h"
+#include "reference.h"
+
+#include "e7-switcher/base64_decode.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+using namespace e7_switcher;
+using namespace e7_switcher::fixtures;
+
+namespace {
+
+// Encoded lengths: 40 is a VisitPwd, 44 a WorkStatus field
+void lengths(benchmark::internal::Benchmark* b) {
+    b->Arg(40)->Arg(44)->Arg(256)->Arg(4096)->Arg(65536);
+}
+
+void BM_Base64Decode(benchmark::State& state) {
+    std::string in = base64_of_size(static_cast<size_t>(state.range(0)));
+    heap::AllocScope allocs(state);
+    for (auto _ : state) {
+        std::vector<unsigned char> out = base64_decode(in);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(state.iterations() * in.size());
+}
+BENCHMARK(BM_Base64Decode)->Apply(lengths);
+
+void BM_Base64DecodeInto(benchmark::State& state) {
+    std::string in = base64_of_size(static_cast<size_t>(state.range(0)));
+    std::vector<unsigned char> out(in.size() / 4 * 3 + 2);
+    for (auto _ : state) {
+        size_t n = base64_decode(in.data(), in.size(), out.data());
+        benchmark::DoNotOptimize(n);
+    }
+    state.SetBytesProcessed(state.iterations() * in.size());
+}
+BENCHMARK(BM_Base64DecodeInto)->Apply(lengths);
+
+void BM_Base64DecodeReference(benchmark::State& state) {
+    std::string in = base64_of_size(static_cast<size_t>(state.range(0)));
+    heap::AllocScope allocs(state);
+    for (auto _ : state) {
+        std::vector<unsigned char> out = reference::base64_decode(in);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(state.iterations() * in.size());
+}
+BENCHMARK(BM_Base64DecodeReference)->Apply(lengths);
+
+} // namespace
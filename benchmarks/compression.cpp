@@ -0,0 +1,147 @@
+// gzip decoding of IR configs: decompress_data (with the E7_INFLATE_BACKEND
+// it was built with, shown as the label) and InflateStream against zlib set up
+// afresh per call (the code they replaced).
+//
+// The corpus is synthetic code sets of growing size, or the files in the
+// directory named by E7_BENCH_IR_CORPUS: each one IR config, either the gzip
+// member as received from the hub (*.gz) or the decoded JSON (anything
+// else, gzipped here).
+
+#include "fixtures.h"
+#include "heap.h"
+
+#include "e7-switcher/compression.h"
+
+#include <benchmark/benchmark.h>
+#include <zlib.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace e7_switcher;
+using namespace e7_switcher::fixtures;
+
+namespace {
+
+struct Sample {
+    std::string name;
+    std::vector<uint8_t> gz;
+    size_t raw_size;
+};
+
+std::vector<Sample> load_corpus(const char* dir) {
+    std::vector<Sample> corpus;
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        if (!entry.is_regular_file()) continue;
+        std::ifstream in(entry.path(), std::ios::binary);
+        std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        Sample s;
+        s.name = entry.path().filename().string();
+        if (entry.path().extension() == ".gz") {
+            s.gz.assign(data.begin(), data.end());
+        } else {
+            s.gz = gzip(data);
+        }
+        s.raw_size = decompress_data(s.gz).size();
+        corpus.push_back(std::move(s));
+    }
+    return corpus;
+}
+
+std::vector<Sample> synthetic_corpus() {
+    std::vector<Sample> corpus;
+    // 41, 161, 601 and 1201 keys
+    const std::pair<int, int> shapes[] = {{2, 0}, {8, 0}, {15, 2}, {15, 4}};
+    for (const auto& shape : shapes) {
+        IRSet set;
+        set.temperatures = shape.first;
+        set.swings = shape.second;
+        set.hex_code = pulse_train_hex;
+        std::string json = ir_set_json(set);
+        std::string name = "synthetic-" + std::to_string(ac_key_names(set).size());
+        corpus.push_back({name, gzip(json), json.size()});
+    }
+    return corpus;
+}
+
+void BM_DecompressData(benchmark::State& state, const Sample& s) {
+    heap::AllocScope allocs(state);
+    for (auto _ : state) {
+        std::vector<uint8_t> out = decompress_data(s.gz);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(state.iterations() * s.raw_size);
+    state.SetLabel(inflate_backend_name());
+}
+
+void BM_InflateStream(benchmark::State& state, const Sample& s) {
+    uint8_t buf[4096];
+    heap::AllocScope allocs(state);
+    for (auto _ : state) {
+        InflateStream in(s.gz);
+        while (in.read(buf, sizeof(buf)) > 0) {
+        }
+        benchmark::DoNotOptimize(buf);
+    }
+    state.SetBytesProcessed(state.iterations() * s.raw_size);
+}
+
+// Reference point: inflateInit2/inflateEnd per call and chunked output
+void BM_ZlibFreshState(benchmark::State& state, const Sample& s) {
+    uint8_t buf[16 * 1024];
+    heap::AllocScope allocs(state);
+    for (auto _ : state) {
+        z_stream strm{};
+        strm.next_in = const_cast<Bytef*>(s.gz.data());
+        strm.avail_in = static_cast<uInt>(s.gz.size());
+        inflateInit2(&strm, 16 + MAX_WBITS);
+        std::vector<uint8_t> out;
+        int status = Z_OK;
+        while (status == Z_OK) {
+            strm.next_out = buf;
+            strm.avail_out = sizeof(buf);
+            status = inflate(&strm, Z_NO_FLUSH);
+            out.insert(out.end(), buf, buf + (sizeof(buf) - strm.avail_out));
+        }
+        inflateEnd(&strm);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(state.iterations() * s.raw_size);
+}
+
+// The IR config frame payload: the gzip member follows a 3-byte prefix. This
+// is the call the client makes, so it is the one to compare backends on.
+void BM_DecompressIRConfigPayload(benchmark::State& state, const Sample& s) {
+    std::vector<uint8_t> payload = {0, 0, 0};
+    payload.insert(payload.end(), s.gz.begin(), s.gz.end());
+    heap::AllocScope allocs(state);
+    for (auto _ : state) {
+        std::vector<uint8_t> json = decompress_data(payload, 3);
+        benchmark::DoNotOptimize(json.data());
+    }
+    state.SetBytesProcessed(state.iterations() * s.raw_size);
+    state.SetLabel(inflate_backend_name());
+}
+
+bool register_corpus() {
+    static const std::vector<Sample> corpus = [] {
+        const char* dir = std::getenv("E7_BENCH_IR_CORPUS");
+        return dir && *dir ? load_corpus(dir) : synthetic_corpus();
+    }();
+    for (const Sample& s : corpus) {
+        benchmark::RegisterBenchmark(("BM_DecompressIRConfigPayload/" + s.name).c_str(),
+                                     BM_DecompressIRConfigPayload, s);
+        benchmark::RegisterBenchmark(("BM_DecompressData/" + s.name).c_str(), BM_DecompressData, s);
+        benchmark::RegisterBenchmark(("BM_InflateStream/" + s.name).c_str(), BM_InflateStream, s);
+        benchmark::RegisterBenchmark(("BM_ZlibFreshState/" + s.name).c_str(), BM_ZlibFreshState, s);
+    }
+    return true;
+}
+
+const bool corpus_registered = register_corpus();
+
+} // namespace
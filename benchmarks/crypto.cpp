@@ -0,0 +1,113 @@
+// AES through the library's helpers and through AesEcbCipher directly, the
+// calls the ESP32 hardware backend also serves, so desktop numbers and an
+// ESP32 build of the same calls can be compared.
+
+#include "fixtures.h"
+#include "heap.h"
+
+#include "e7-switcher/constants.h"
+#include "e7-switcher/crypto.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+using namespace e7_switcher;
+using namespace e7_switcher::fixtures;
+
+namespace {
+
+// 16 and 160: device password and login request; 4096: bulk
+void payload_sizes(benchmark::internal::Benchmark* b) {
+    b->Arg(16)->Arg(160)->Arg(4096);
+}
+
+void BM_EncryptToHexEcbPkcs7(benchmark::State& state) {
+    std::vector<uint8_t> plain = bytes(static_cast<size_t>(state.range(0)));
+    heap::AllocScope allocs(state);
+    for (auto _ : state) {
+        std::vector<uint8_t> c = encrypt_to_hex_ecb_pkcs7(plain, AES_KEY_2_50);
+        benchmark::DoNotOptimize(c.data());
+    }
+    state.SetBytesProcessed(state.iterations() * plain.size());
+}
+BENCHMARK(BM_EncryptToHexEcbPkcs7)->Apply(payload_sizes);
+
+void BM_DecryptHexEcbPkcs7(benchmark::State& state) {
+    std::vector<uint8_t> cipher = encrypt_to_hex_ecb_pkcs7(bytes(static_cast<size_t>(state.range(0))), AES_KEY_2_50);
+    heap::AllocScope allocs(state);
+    for (auto _ : state) {
+        std::vector<uint8_t> p = decrypt_hex_ecb_pkcs7(cipher, AES_KEY_2_50);
+        benchmark::DoNotOptimize(p.data());
+    }
+    state.SetBytesProcessed(state.iterations() * cipher.size());
+}
+BENCHMARK(BM_DecryptHexEcbPkcs7)->Apply(payload_sizes);
+
+// Long-lived cipher, caller's buffer: the path the client takes
+void BM_AesEncryptInPlace(benchmark::State& state) {
+    size_t len = static_cast<size_t>(state.range(0));
+    std::vector<uint8_t> buf(AesEcbCipher::padded_size(len));
+    AesEcbCipher& cipher = protocol_cipher(ProtocolKey::V2_50);
+    heap::AllocScope allocs(state);
+    for (auto _ : state) {
+        size_t n = cipher.encrypt_in_place(buf, len);
+        benchmark::DoNotOptimize(n);
+    }
+    state.SetBytesProcessed(state.iterations() * len);
+}
+BENCHMARK(BM_AesEncryptInPlace)->Apply(payload_sizes);
+
+// --- Block throughput by key size ------------------------------------------------
+
+// Arguments: key bytes (16/24/32), then data bytes (32: device password,
+// 176: login request, 1024/16384: bulk)
+void key_and_data_sizes(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"key", "bytes"});
+    for (int key : {16, 24, 32}) {
+        for (int size : {32, 176, 1024, 16384}) {
+            b->Args({key, size});
+        }
+    }
+}
+
+void BM_AesEncryptBlocks(benchmark::State& state) {
+    AesEcbCipher cipher(std::string(static_cast<size_t>(state.range(0)), 'k'));
+    size_t size = static_cast<size_t>(state.range(1));
+    std::vector<uint8_t> buf = bytes(AesEcbCipher::padded_size(size));
+    for (auto _ : state) {
+        cipher.encrypt_blocks(buf.data(), buf.data(), size);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_AesEncryptBlocks)->Apply(key_and_data_sizes);
+
+void BM_AesDecryptBlocks(benchmark::State& state) {
+    AesEcbCipher cipher(std::string(static_cast<size_t>(state.range(0)), 'k'));
+    size_t size = static_cast<size_t>(state.range(1));
+    std::vector<uint8_t> buf = bytes(AesEcbCipher::padded_size(size));
+    for (auto _ : state) {
+        cipher.decrypt_blocks(buf.data(), buf.data(), size);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_AesDecryptBlocks)->Apply(key_and_data_sizes);
+
+// PKCS#7-padded encrypt into a caller buffer
+void BM_AesEncryptPkcs7(benchmark::State& state) {
+    AesEcbCipher cipher(std::string(static_cast<size_t>(state.range(0)), 'k'));
+    size_t size = static_cast<size_t>(state.range(1));
+    std::vector<uint8_t> plain = bytes(size);
+    std::vector<uint8_t> buf(AesEcbCipher::padded_size(size));
+    for (auto _ : state) {
+        cipher.encrypt(plain, buf);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(state.iterations() * size);
+}
+BENCHMARK(BM_AesEncryptPkcs7)->Apply(key_and_data_sizes);
+
+} // namespace
@@ -0,0 +1,105 @@
+// Frame building and parsing, and the CRC tail, on a device query response
+// and a switch control command.
+
+#include "fixtures.h"
+#include "heap.h"
+
+#include "e7-switcher/constants.h"
+#include "e7-switcher/crc.h"
+#include "e7-switcher/message_schemas.h"
+#include "e7-switcher/messages.h"
+#include "e7-switcher/parser.h"
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+using namespace e7_switcher;
+using namespace e7_switcher::fixtures;
+
+namespace {
+
+void BM_BuildProtocolMessage(benchmark::State& state) {
+    std::vector<uint8_t> payload = bytes(schema::SwitchControl::size);
+    SessionCrc crc(session_key());
+    heap::AllocScope allocs(state);
+    for (auto _ : state) {
+        ProtocolMessage m = build_protocol_message(CMD_DEVICE_CONTROL, 0x1234, 1, 0x0101, 1, 0, 0x20001, payload, crc);
+        benchmark::DoNotOptimize(m);
+    }
+}
+BENCHMARK(BM_BuildProtocolMessage);
+
+// The reusable-buffer path the client takes, for comparison
+void BM_BuildSwitchControlFrame(benchmark::State& state) {
+    std::vector<uint8_t> frame;
+    std::vector<uint8_t> pwd = bytes(16);
+    SessionCrc crc(session_key());
+    heap::AllocScope allocs(state);
+    for (auto _ : state) {
+        build_switch_control_frame(frame, 0x1234, 0x20001, crc, 100001, pwd, 1, 30);
+        benchmark::DoNotOptimize(frame.data());
+    }
+}
+BENCHMARK(BM_BuildSwitchControlFrame);
+
+void BM_ParseProtocolPacket(benchmark::State& state) {
+    std::vector<uint8_t> frame = switch_status_frame();
+    heap::AllocScope allocs(state);
+    for (auto _ : state) {
+        ProtocolMessage m = parse_protocol_packet(frame);
+        benchmark::DoNotOptimize(m);
+    }
+    state.SetBytesProcessed(state.iterations() * frame.size());
+}
+BENCHMARK(BM_ParseProtocolPacket);
+
+void BM_ProtocolMessageView(benchmark::State& state) {
+    std::vector<uint8_t> frame = switch_status_frame();
+    heap::AllocScope allocs(state);
+    for (auto _ : state) {
+        ProtocolMessageView v(frame);
+        benchmark::DoNotOptimize(v.payload().data());
+    }
+}
+BENCHMARK(BM_ProtocolMessageView);
+
+void BM_ParseSwitchStatus(benchmark::State& state) {
+    std::vector<uint8_t> payload = switch_status_payload();
+    heap::AllocScope allocs(state);
+    for (auto _ : state) {
+        SwitchStatus s = parse_switch_status(payload);
+        benchmark::DoNotOptimize(s);
+    }
+}
+BENCHMARK(BM_ParseSwitchStatus);
+
+// --- CRC -----------------------------------------------------------------------
+
+void BM_CompleteLegalCrc(benchmark::State& state) {
+    std::vector<uint8_t> frame = switch_status_frame();
+    frame.resize(frame.size() - CRC_TAIL_SIZE);
+    heap::AllocScope allocs(state);
+    for (auto _ : state) {
+        std::vector<uint8_t> tail = get_complete_legal_crc(frame, session_key());
+        benchmark::DoNotOptimize(tail.data());
+    }
+    state.SetBytesProcessed(state.iterations() * frame.size());
+}
+BENCHMARK(BM_CompleteLegalCrc);
+
+// With the session's key term precomputed, as FrameBuilder uses it
+void BM_SessionCrcWriteTail(benchmark::State& state) {
+    std::vector<uint8_t> frame = switch_status_frame();
+    SessionCrc crc(session_key());
+    uint8_t tail[CRC_TAIL_SIZE];
+    heap::AllocScope allocs(state);
+    for (auto _ : state) {
+        crc.write_tail(frame.data(), frame.size() - CRC_TAIL_SIZE, tail);
+        benchmark::DoNotOptimize(tail);
+    }
+    state.SetBytesProcessed(state.iterations() * (frame.size() - CRC_TAIL_SIZE));
+}
+BENCHMARK(BM_SessionCrcWriteTail);
+
+} // namespace
@@ -0,0 +1,56 @@
+#include "heap.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace e7_switcher {
+namespace heap {
+
+namespace {
+
+std::atomic<uint64_t> g_allocs{0};
+std::atomic<uint64_t> g_alloc_bytes{0};
+std::atomic<size_t> g_in_use{0};
+std::atomic<size_t> g_peak{0};
+
+// Each block is preceded by its size, so delete can account for it
+constexpr size_t HEADER = alignof(std::max_align_t);
+
+} // namespace
+
+void* counted_alloc(size_t n) {
+    void* p = std::malloc(n + HEADER);
+    if (!p) throw std::bad_alloc();
+    *static_cast<size_t*>(p) = n;
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    g_alloc_bytes.fetch_add(n, std::memory_order_relaxed);
+    size_t now = g_in_use.fetch_add(n, std::memory_order_relaxed) + n;
+    size_t peak = g_peak.load(std::memory_order_relaxed);
+    while (now > peak && !g_peak.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {
+    }
+    return static_cast<char*>(p) + HEADER;
+}
+
+void counted_free(void* p) {
+    if (!p) return;
+    void* base = static_cast<char*>(p) - HEADER;
+    g_in_use.fetch_sub(*static_cast<size_t*>(base), std::memory_order_relaxed);
+    std::free(base);
+}
+
+uint64_t allocations() { return g_allocs.load(std::memory_order_relaxed); }
+uint64_t allocated() { return g_alloc_bytes.load(std::memory_order_relaxed); }
+size_t in_use() { return g_in_use.load(std::memory_order_relaxed); }
+size_t peak() { return g_peak.load(std::memory_order_relaxed); }
+void reset_peak() { g_peak.store(in_use(), std::memory_order_relaxed); }
+
+} // namespace heap
+} // namespace e7_switcher
+
+void* operator new(size_t n) { return e7_switcher::heap::counted_alloc(n); }
+void* operator new[](size_t n) { return e7_switcher::heap::counted_alloc(n); }
+void operator delete(void* p) noexcept { e7_switcher::heap::counted_free(p); }
+void operator delete[](void* p) noexcept { e7_switcher::heap::counted_free(p); }
+void operator delete(void* p, size_t) noexcept { e7_switcher::heap::counted_free(p); }
+void operator delete[](void* p, size_t) noexcept { e7_switcher::heap::counted_free(p); }
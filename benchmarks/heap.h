@@ -0,0 +1,53 @@
+#pragma once
+
+// Heap accounting for the benchmark suite: heap.cpp replaces the global
+// operator new/delete with counting versions.
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace e7_switcher {
+namespace heap {
+
+uint64_t allocations();   // calls to operator new so far
+uint64_t allocated();     // bytes requested from operator new so far
+size_t in_use();          // bytes currently allocated
+size_t peak();            // highest in_use() since the last reset_peak()
+void reset_peak();
+
+// Covers one benchmark's timing loop: on destruction sets the allocs/op
+// and alloc_bytes/op counters
+class AllocScope {
+public:
+    explicit AllocScope(benchmark::State& state)
+        : state_(state), allocs_(allocations()), bytes_(allocated()) {}
+    ~AllocScope() {
+        state_.counters["allocs/op"] =
+            benchmark::Counter(static_cast<double>(allocations() - allocs_), benchmark::Counter::kAvgIterations);
+        state_.counters["alloc_bytes/op"] =
+            benchmark::Counter(static_cast<double>(allocated() - bytes_), benchmark::Counter::kAvgIterations);
+    }
+
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+
+private:
+    benchmark::State& state_;
+    uint64_t allocs_;
+    uint64_t bytes_;
+};
+
+// Heap in use at the peak of one call of fn, above what was in use before
+// it; includes whatever fn's result keeps alive until it returns
+template <typename Fn>
+size_t peak_of(Fn&& fn) {
+    size_t base = in_use();
+    reset_peak();
+    fn();
+    return peak() - base;
+}
+
+} // namespace heap
+} // namespace e7_switcher
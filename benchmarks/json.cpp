@@ -0,0 +1,169 @@
+// JSON payloads: device lists (streaming handler vs. the DOM approach it
+// replaced; nlohmann vs. simdjson backends) and IR code sets (eager vs.
+// lazy key decoding), plus AC control code lookup.
+//
+// The parse cases report peak_bytes, the heap in use at the peak of one
+// parse including its result. The simdjson cases are skipped unless built
+// with -DE7_USE_SIMDJSON=ON.
+
+#include "fixtures.h"
+#include "heap.h"
+#include "reference.h"
+
+#include "e7-switcher/json_backends.h"
+#include "e7-switcher/json_helpers.h"
+#include "e7-switcher/oge_ir_device_code.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+using namespace e7_switcher;
+using namespace e7_switcher::fixtures;
+
+namespace {
+
+ByteSpan bytes_of(const std::string& s) {
+    return ByteSpan(reinterpret_cast<const uint8_t*>(s.data()), s.size());
+}
+
+// --- Device list ---------------------------------------------------------------
+
+void device_counts(benchmark::internal::Benchmark* b) {
+    b->Arg(4)->Arg(32)->Arg(500)->Arg(2000);
+}
+
+// Times parse(json, devices) and reports its peak heap
+template <typename Parse>
+void run_device_list(benchmark::State& state, Parse&& parse) {
+    std::string json = device_list_json(static_cast<int>(state.range(0)));
+    state.counters["peak_bytes"] = static_cast<double>(heap::peak_of([&] {
+        std::vector<Device> devices;
+        parse(json, devices);
+    }));
+    heap::AllocScope allocs(state);
+    for (auto _ : state) {
+        std::vector<Device> devices;
+        bool ok = parse(json, devices);
+        benchmark::DoNotOptimize(ok);
+        benchmark::DoNotOptimize(devices.data());
+    }
+    state.SetBytesProcessed(state.iterations() * json.size());
+}
+
+// The public entry point (simdjson first when built in)
+void BM_ExtractDeviceList(benchmark::State& state) {
+    run_device_list(state, [](const std::string& j, std::vector<Device>& d) { return extract_device_list(j, d); });
+}
+BENCHMARK(BM_ExtractDeviceList)->Apply(device_counts);
+
+void BM_ExtractDeviceListDom(benchmark::State& state) {
+    run_device_list(state, reference::extract_device_list_dom);
+}
+BENCHMARK(BM_ExtractDeviceListDom)->Apply(device_counts);
+
+void BM_DeviceListNlohmann(benchmark::State& state) {
+    run_device_list(state, [](const std::string& j, std::vector<Device>& d) {
+        return json_backends::extract_device_list_nlohmann(bytes_of(j), d);
+    });
+}
+BENCHMARK(BM_DeviceListNlohmann)->Apply(device_counts);
+
+void BM_DeviceListSimdjson(benchmark::State& state) {
+    if (!json_backends::simdjson_enabled()) {
+        state.SkipWithError("simdjson not built");
+        return;
+    }
+    run_device_list(state, [](const std::string& j, std::vector<Device>& d) {
+        return json_backends::extract_device_list_simdjson(bytes_of(j), d).value_or(false);
+    });
+}
+BENCHMARK(BM_DeviceListSimdjson)->Apply(device_counts);
+
+// --- IR code sets --------------------------------------------------------------
+
+// Arguments: temperatures, swing tokens per key (61, 301 and 1201 keys)
+void ir_set_shapes(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"temps", "swings"})->Args({3, 0})->Args({15, 0})->Args({15, 4});
+}
+
+std::string ir_set_for(const benchmark::State& state) {
+    IRSet set;
+    set.temperatures = static_cast<int>(state.range(0));
+    set.swings = static_cast<int>(state.range(1));
+    set.para = true;
+    return ir_set_json(set);
+}
+
+// Parse from the decompressed bytes, as the client does, then resolve the
+// commands an app typically sends; reports the peak heap of one round
+template <typename Parse>
+void run_ir_config(benchmark::State& state, Parse&& parse) {
+    std::string json = ir_set_for(state);
+    auto once = [&] {
+        OgeIRDeviceCode d = parse(std::vector<uint8_t>(json.begin(), json.end()));
+        for (int temp : {22, 24, 26}) {
+            benchmark::DoNotOptimize(get_ac_control_code(4, 1, 0, temp, 1, d));
+        }
+        benchmark::DoNotOptimize(get_ac_control_code(4, 1, 0, 24, 0, d));
+    };
+    state.counters["peak_bytes"] = static_cast<double>(heap::peak_of(once));
+    heap::AllocScope allocs(state);
+    for (auto _ : state) {
+        once();
+    }
+    state.SetBytesProcessed(state.iterations() * json.size());
+}
+
+void BM_IRConfigEager(benchmark::State& state) {
+    run_ir_config(state, [](std::vector<uint8_t> data) { return parse_oge_ir_device_code(ByteSpan(data)); });
+}
+BENCHMARK(BM_IRConfigEager)->Apply(ir_set_shapes);
+
+void BM_IRConfigLazy(benchmark::State& state) {
+    run_ir_config(state, [](std::vector<uint8_t> data) { return parse_oge_ir_device_code_lazy(std::move(data)); });
+}
+BENCHMARK(BM_IRConfigLazy)->Apply(ir_set_shapes);
+
+void BM_IRCodeNlohmann(benchmark::State& state) {
+    std::string json = ir_set_for(state);
+    heap::AllocScope allocs(state);
+    for (auto _ : state) {
+        OgeIRDeviceCode code = json_backends::parse_oge_ir_device_code_nlohmann(bytes_of(json));
+        benchmark::DoNotOptimize(code.key_count);
+    }
+    state.SetBytesProcessed(state.iterations() * json.size());
+}
+BENCHMARK(BM_IRCodeNlohmann)->Apply(ir_set_shapes);
+
+void BM_IRCodeSimdjson(benchmark::State& state) {
+    if (!json_backends::simdjson_enabled()) {
+        state.SkipWithError("simdjson not built");
+        return;
+    }
+    std::string json = ir_set_for(state);
+    heap::AllocScope allocs(state);
+    for (auto _ : state) {
+        auto code = json_backends::parse_oge_ir_device_code_simdjson(bytes_of(json));
+        benchmark::DoNotOptimize(code);
+    }
+    state.SetBytesProcessed(state.iterations() * json.size());
+}
+BENCHMARK(BM_IRCodeSimdjson)->Apply(ir_set_shapes);
+
+void BM_GetAcControlCode(benchmark::State& state) {
+    OgeIRDeviceCode resolver = parse_oge_ir_device_code(ir_set_json());
+    int temperature = 16;
+    heap::AllocScope allocs(state);
+    for (auto _ : state) {
+        std::string code = get_ac_control_code(static_cast<int>(ACMode::COOL), static_cast<int>(ACFanSpeed::FAN_HIGH),
+                                               static_cast<int>(ACSwing::SWING_ON), temperature,
+                                               static_cast<int>(ACPower::POWER_ON), resolver);
+        benchmark::DoNotOptimize(code.data());
+        temperature = temperature == 30 ? 16 : temperature + 1;
+    }
+}
+BENCHMARK(BM_GetAcControlCode);
+
+} // namespace
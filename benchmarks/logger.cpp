@@ -0,0 +1,139 @@
+// Logging cost on the calling thread: a synchronous logger vs. AsyncLogger
+// with the DROP and BLOCK policies, from 1 and 4 threads, for bursts of 512
+// calls per thread that fit in the ring, with the writer caught up in
+// between (untimed), the way command-path logging arrives.
+//
+// The sink writes what the platform logger would, one flushed line per
+// message, to the null device, so the suite's own output stays readable.
+
+#include "e7-switcher/async_logger.h"
+#include "e7-switcher/logger.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdarg>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+using namespace e7_switcher;
+
+namespace {
+
+#ifdef _WIN32
+const char* const NULL_DEVICE = "NUL";
+#else
+const char* const NULL_DEVICE = "/dev/null";
+#endif
+
+constexpr int BURST = 512;
+
+// StdLogger's output path, into a file
+class FileLogger : public Logger {
+public:
+    FileLogger() : file_(std::fopen(NULL_DEVICE, "w")) {}
+    ~FileLogger() override {
+        if (file_) std::fclose(file_);
+    }
+
+    void debug(const std::string& m) override { line("[DEBUG] ", m.c_str()); }
+    void info(const std::string& m) override { line("[INFO] ", m.c_str()); }
+    void warning(const std::string& m) override { line("[WARNING] ", m.c_str()); }
+    void error(const std::string& m) override { line("[ERROR] ", m.c_str()); }
+    void set_log_level(LogLevel) override {}
+
+    void debugf(const char* format, ...) override {
+        va_list args;
+        va_start(args, format);
+        linef("[DEBUG] ", format, args);
+        va_end(args);
+    }
+    void infof(const char* format, ...) override {
+        va_list args;
+        va_start(args, format);
+        linef("[INFO] ", format, args);
+        va_end(args);
+    }
+    void warningf(const char* format, ...) override {
+        va_list args;
+        va_start(args, format);
+        linef("[WARNING] ", format, args);
+        va_end(args);
+    }
+    void errorf(const char* format, ...) override {
+        va_list args;
+        va_start(args, format);
+        linef("[ERROR] ", format, args);
+        va_end(args);
+    }
+
+private:
+    void line(const char* tag, const char* text) {
+        std::fputs(tag, file_);
+        std::fputs(text, file_);
+        std::fputc('\n', file_);
+        std::fflush(file_);
+    }
+    void linef(const char* tag, const char* format, va_list args) {
+        char buffer[256];
+        std::vsnprintf(buffer, sizeof(buffer), format, args);
+        line(tag, buffer);
+    }
+
+    std::FILE* file_;
+};
+
+// The client's per-command line
+void log_one(Logger& logger, int i) {
+    logger.infof("Sending control command to device %s (did %d, seq %d)", "Living Room AC", 100042, i);
+}
+
+std::unique_ptr<FileLogger> g_sync;
+
+void BM_LoggerSync(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        g_sync = std::make_unique<FileLogger>();
+    }
+    int i = 0;
+    for (auto _ : state) {
+        log_one(*g_sync, i++);
+    }
+    if (state.thread_index() == 0) {
+        g_sync.reset();
+    }
+}
+BENCHMARK(BM_LoggerSync)->Threads(1)->Threads(4)->UseRealTime();
+
+std::unique_ptr<AsyncLogger> g_async;
+
+// Argument: AsyncLogPolicy
+void BM_LoggerAsync(benchmark::State& state) {
+    AsyncLogPolicy policy = static_cast<AsyncLogPolicy>(state.range(0));
+    if (state.thread_index() == 0) {
+        // 4 threads' bursts still fit the ring
+        g_async = std::make_unique<AsyncLogger>(std::make_unique<FileLogger>(), 4096, policy);
+        state.SetLabel(policy == AsyncLogPolicy::DROP ? "DROP" : "BLOCK");
+    }
+    int i = 0;
+    for (auto _ : state) {
+        log_one(*g_async, i);
+        if (++i % BURST == 0) {
+            state.PauseTiming();
+            g_async->flush();
+            state.ResumeTiming();
+        }
+    }
+    if (state.thread_index() == 0) {
+        g_async->flush();
+        state.counters["dropped"] = static_cast<double>(g_async->dropped());
+        g_async.reset();
+    }
+}
+BENCHMARK(BM_LoggerAsync)
+    ->Arg(static_cast<int>(AsyncLogPolicy::DROP))
+    ->Arg(static_cast<int>(AsyncLogPolicy::BLOCK))
+    ->Threads(1)
+    ->Threads(4)
+    ->UseRealTime();
+
+} // namespace
@@ -0,0 +1,57 @@
+// Operation metrics: the cost of recording a latency, timing an operation
+// with ScopedOperation, counting a frame's traffic, and taking a snapshot.
+
+#include "e7-switcher/constants.h"
+#include "e7-switcher/metrics.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+using namespace e7_switcher;
+
+namespace {
+
+void BM_HistogramRecord(benchmark::State& state) {
+    LatencyHistogram h;
+    uint32_t i = 0;
+    for (auto _ : state) {
+        h.record(i++ * 2654435761u >> 12);
+    }
+    benchmark::DoNotOptimize(h.snapshot().count);
+}
+BENCHMARK(BM_HistogramRecord);
+
+// Includes its two clock reads
+void BM_ScopedOperation(benchmark::State& state) {
+    Metrics metrics;
+    for (auto _ : state) {
+        ScopedOperation op(metrics, CMD_DEVICE_QUERY);
+    }
+}
+BENCHMARK(BM_ScopedOperation);
+
+// What the message stream counts per frame
+void BM_StreamCounters(benchmark::State& state) {
+    Metrics metrics;
+    size_t i = 0;
+    for (auto _ : state) {
+        metrics.count_sent(64);
+        metrics.count_received(i++ & 1023);
+        metrics.count_frame_received();
+    }
+}
+BENCHMARK(BM_StreamCounters);
+
+void BM_MetricsSnapshot(benchmark::State& state) {
+    Metrics metrics;
+    for (int i = 0; i < 1000; ++i) {
+        ScopedOperation op(metrics, CMD_DEVICE_QUERY);
+    }
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(metrics.snapshot().frames_sent);
+    }
+}
+BENCHMARK(BM_MetricsSnapshot);
+
+} // namespace
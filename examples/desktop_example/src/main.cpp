@@ -8,6 +8,8 @@
 #include <sstream>
 #include "e7-switcher/e7_switcher_client.h"
 #include "e7-switcher/logger.h"
+#include "e7-switcher/wire_capture.h"
+#include "e7-switcher/tracing.h"
 #include "e7-switcher/secrets.h"
 
 using namespace e7_switcher;
@@ -81,6 +83,12 @@ int main(int argc, char* argv[]) {
         logger.info("  --temp      Temperature: 16-30 (default: 20)");
         logger.info("  --fan       Fan speed: low, medium, high, auto (default: medium)");
         logger.info("  --swing     Swing: on, off (default: on)");
+        logger.info("  --host      Hub address, e.g. 127.0.0.1 for a local e7-mock-hub (default: Switcher hub)");
+        logger.info("  --port      Hub port (default: 9091)");
+        logger.info("  --capture   Record the session's frames to this file");
+        logger.info("  --replay    Play back a capture file instead of connecting to the hub");
+        logger.info("  --replay-speed  Replay speed factor, 0 for no delays (default: 1)");
+        logger.info("  --trace     Write a Chrome trace (chrome://tracing, ui.perfetto.dev) of the run to this file");
         return 1;
     }
     
@@ -96,9 +104,40 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    // Spans are collected for the whole run and written out at exit, failed runs included
+    ChromeTraceExporter trace;
+    if (args.count("trace")) {
+        Tracer::set_sink(&trace);
+    }
+    auto save_trace = [&]() {
+        if (!args.count("trace")) return;
+        Tracer::set_sink(nullptr);
+        try {
+            trace.save(args["trace"]);
+            logger.infof("Trace written to %s (%zu spans)", args["trace"].c_str(), trace.size());
+        } catch (const std::exception& e) {
+            logger.errorf("Error: %s", e.what());
+        }
+    };
+
     try {
         // Create client
-        E7SwitcherClient client{std::string(E7_SWITCHER_ACCOUNT), std::string(E7_SWITCHER_PASSWORD)};
+        ConnectionOptions options;
+        if (args.count("host")) {
+            options.host = args["host"];
+        }
+        if (args.count("port")) {
+            options.port = std::stoi(args["port"]);
+        }
+        if (args.count("capture")) {
+            options.capture_path = args["capture"];
+        }
+        if (args.count("replay")) {
+            double speed = args.count("replay-speed") ? std::stod(args["replay-speed"]) : 1.0;
+            options.transport = std::make_unique<ReplayTransport>(args["replay"], speed);
+        }
+        E7SwitcherClient client{std::string(E7_SWITCHER_ACCOUNT), std::string(E7_SWITCHER_PASSWORD),
+                                std::move(options)};
         
         // Get device name from command line
         std::string device_name = args["device"];
@@ -186,13 +225,16 @@ int main(int argc, char* argv[]) {
         }
         else {
             logger.warning("Unknown command. Use 'switch-status', 'switch-on', 'switch-off', 'ac-status', 'ac-on', or 'ac-off'");
+            save_trace();
             return 1;
         }
     } 
     catch (const std::exception& e) {
         logger.errorf("Error: %s", e.what());
+        save_trace();
         return 1;
     }
     
+    save_trace();
     return 0;
 }
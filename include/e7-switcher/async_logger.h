@@ -0,0 +1,91 @@
+#pragma once
+
+#include "logger.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace e7_switcher {
+
+/**
+ * Logger that keeps formatting and I/O off the calling thread. A call claims
+ * a slot of a bounded lock-free MPSC ring (one CAS), copies the format string
+ * and its arguments into it (string arguments by value), and publishes it;
+ * a background thread formats the message and hands it to another Logger,
+ * normally the platform one. Formats the capture does not handle (%n, long
+ * double, wide strings, more than MAX_ARGS arguments, or too long to copy)
+ * are formatted on the calling thread instead.
+ *
+ * Messages longer than MESSAGE_SIZE - 1 are truncated, as with the *f
+ * variants of the other loggers. What happens when the ring is full is set
+ * by AsyncLogPolicy; dropped messages are counted and reported by the writer.
+ */
+class AsyncLogger : public Logger {
+public:
+    static constexpr size_t MESSAGE_SIZE = 256;
+    static constexpr size_t MAX_ARGS = 16;
+
+    // capacity is rounded up to a power of two
+    explicit AsyncLogger(std::unique_ptr<Logger> sink, size_t capacity = 1024,
+                         AsyncLogPolicy policy = AsyncLogPolicy::DROP);
+    // Writes everything still queued, then stops the writer thread
+    ~AsyncLogger() override;
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    void debug(const std::string& message) override;
+    void info(const std::string& message) override;
+    void warning(const std::string& message) override;
+    void error(const std::string& message) override;
+
+    void set_log_level(LogLevel level) override;
+
+    void debugf(const char* format, ...) override;
+    void infof(const char* format, ...) override;
+    void warningf(const char* format, ...) override;
+    void errorf(const char* format, ...) override;
+
+    // Block until every message logged before the call has been written
+    void flush();
+
+    // Messages discarded so far because the ring was full (DROP policy)
+    size_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot;
+
+    Slot* claim(size_t& pos);
+    void publish(Slot* slot, size_t pos);
+    void push(LogLevel level, const std::string& message);
+    void pushf(LogLevel level, const char* format, va_list args);
+    void wait_for_space();
+
+    void run();
+    bool drain();
+    void write(const Slot& slot);
+
+    std::unique_ptr<Logger> sink_;
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+    AsyncLogPolicy policy_;
+    std::atomic<bool> debug_enabled_;
+
+    alignas(64) std::atomic<size_t> enqueue_pos_;
+    alignas(64) std::atomic<size_t> dequeue_pos_; // advanced by the writer only
+    std::atomic<size_t> dropped_;
+    size_t dropped_reported_;                     // writer only
+
+    std::atomic<bool> writer_idle_;
+    std::atomic<bool> stop_;
+    std::mutex mutex_;
+    std::condition_variable wake_;     // the idle writer waits here
+    std::condition_variable progress_; // BLOCK producers and flush() wait here
+    std::thread writer_;
+};
+
+} // namespace e7_switcher
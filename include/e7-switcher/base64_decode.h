@@ -1,6 +1,18 @@
 #pragma once
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
+// Decoding stops at the first '=' or any character outside the base64
+// alphabet; a trailing group of 2 or 3 characters yields 1 or 2 bytes.
+
+// Exact number of bytes base64_decode() produces for this input
+size_t base64_decoded_size(const char* in, size_t len);
+
+// Decodes into out, which must hold base64_decoded_size(in, len) bytes
+// (len / 4 * 3 + 2 is always enough). Returns the number of bytes written.
+size_t base64_decode(const char* in, size_t len, unsigned char* out);
+
+std::vector<unsigned char> base64_decode(const char* in, size_t len);
 std::vector<unsigned char> base64_decode(std::string const& s);
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "e7_switcher_client.h"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace e7_switcher {
+
+/**
+ * Runs an E7SwitcherClient on its own background thread, for callers that
+ * must not block (e.g. an event loop). The client is connected and logged in
+ * on that thread; submitted jobs then run there one at a time, in order, which
+ * is also the order the hub's replies come back in. Any number of jobs can be
+ * queued without adding threads.
+ *
+ * Jobs report their own results (typically by posting them back to the
+ * caller's loop). Every submitted job runs exactly once, on the worker thread.
+ */
+class ClientWorker {
+public:
+    // client is null when there is none to run against: error then holds the
+    // connection or login failure, or says the worker was closed first
+    using Job = std::function<void(E7SwitcherClient* client, std::exception_ptr error)>;
+
+    // Returns at once; connecting happens on the worker thread
+    ClientWorker(std::string account, std::string password, ConnectionOptions options);
+    // close()
+    ~ClientWorker();
+
+    ClientWorker(const ClientWorker&) = delete;
+    ClientWorker& operator=(const ClientWorker&) = delete;
+
+    // Queue a job; throws std::runtime_error once stopped
+    void submit(Job job);
+
+    // Stop taking jobs and fail the queued ones; the running job finishes and
+    // the client disconnects after it. Returns at once.
+    void stop();
+    // stop(), then wait for the worker thread. Must not be called from a job.
+    void close();
+
+    // Jobs queued and not yet started
+    size_t pending() const;
+
+private:
+    void run(std::string account, std::string password, ConnectionOptions options);
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::deque<Job> jobs_;
+    bool closing_ = false;
+    std::thread thread_;
+};
+
+} // namespace e7_switcher
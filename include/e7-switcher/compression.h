@@ -3,6 +3,9 @@
 
 #include <vector>
 #include <cstdint>
+#include <cstddef>
+#include <memory>
+#include "span.h"
 
 namespace e7_switcher {
 
@@ -16,12 +19,49 @@ namespace e7_switcher {
 std::vector<uint8_t> compress_data(const std::vector<uint8_t>& data, int level = 6);
 
 /**
- * Decompress data using the zlib library
- * 
- * @param compressed_data The compressed data
+ * Decompress a gzip stream with the configured backend (E7_INFLATE_BACKEND:
+ * libdeflate by default on desktop, zlib on ESP32 or when selected)
+ *
+ * The output is allocated once, sized from the gzip ISIZE trailer, and
+ * inflated into directly. It only grows if the trailer turns out to be wrong.
+ *
+ * @param compressed_data Buffer holding the gzip stream
+ * @param offset Start of the gzip stream within compressed_data
  * @return Decompressed data as a vector of bytes
  */
-std::vector<uint8_t> decompress_data(const std::vector<uint8_t>& compressed_data);
+std::vector<uint8_t> decompress_data(ByteSpan compressed_data, size_t offset = 0);
+
+// Backend decompress_data was built with ("zlib" or "libdeflate")
+const char* inflate_backend_name();
+
+/**
+ * Incremental gzip decoder over an in-memory stream
+ *
+ * Produces output in caller-sized chunks so it can feed a parser directly
+ * without materializing the whole decompressed buffer.
+ */
+class InflateStream {
+public:
+    explicit InflateStream(ByteSpan compressed_data, size_t offset = 0);
+    ~InflateStream();
+
+    InflateStream(const InflateStream&) = delete;
+    InflateStream& operator=(const InflateStream&) = delete;
+
+    // Inflate up to n bytes into out; returns the number produced, 0 at end of stream
+    size_t read(uint8_t* out, size_t n);
+
+    bool done() const { return done_; }
+
+    // Uncompressed size announced by the gzip trailer (modulo 2^32)
+    size_t size_hint() const { return size_hint_; }
+
+private:
+    struct Impl; // zlib stream state
+    std::unique_ptr<Impl> impl_;
+    size_t size_hint_;
+    bool done_;
+};
 
 } // namespace e7_switcher
 
@@ -1,10 +1,44 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
 namespace e7_switcher {
 
+// Initial value of both CRC stages of a frame
+constexpr uint16_t CRC_SEED = 0x1021;
+
+// CRC-CCITT (poly 0x1021, no reflection), same as Python's binascii.crc_hqx
+uint16_t crc_hqx(const uint8_t* data, size_t len, uint16_t crc);
+
+/**
+ * Second-stage ("legal") CRC bound to a session's communication key.
+ *
+ * The tail is crc_a = crc_hqx(packet) followed by crc_b = crc_hqx(crc_a || key[32]).
+ * CRC is linear, so the key's share of crc_b is computed once here and every
+ * frame only pays a 2-byte table lookup on top of the packet CRC.
+ */
+class SessionCrc {
+public:
+    // No key (login before a session exists)
+    SessionCrc();
+    // Intentionally implicit so call sites holding the raw key keep working
+    SessionCrc(const std::vector<uint8_t>& key);
+
+    // crc_b for a given crc_a
+    uint16_t second_stage(uint16_t crc_a) const;
+
+    // Write the 4-byte CRC tail (crc_a LE, crc_b LE) for an already computed crc_a
+    void write_tail(uint16_t crc_a, uint8_t* out) const;
+
+    // Write the 4-byte CRC tail for packet[0:len]
+    void write_tail(const uint8_t* packet, size_t len, uint8_t* out) const;
+
+private:
+    uint16_t key_term_;
+};
+
 std::vector<uint8_t> get_complete_legal_crc(const std::vector<uint8_t>& payload, const std::vector<uint8_t>& key);
 
 } // namespace e7_switcher
@@ -2,6 +2,9 @@
 
 #include <vector>
 #include <string>
+#include <cstddef>
+#include <cstdint>
+#include "span.h"
 
 #ifdef ESP_PLATFORM
 #include "mbedtls/aes.h"
@@ -12,6 +15,72 @@
 
 namespace e7_switcher {
 
+/**
+ * AES-ECB cipher bound to one key.
+ *
+ * The key schedule (EVP contexts on desktop, mbedtls contexts on ESP) is set
+ * up once in the constructor and released in the destructor, so a cipher that
+ * is kept around costs no allocation or key expansion per call. Not safe for
+ * concurrent use; give each thread its own instance.
+ */
+class AesEcbCipher {
+public:
+    // key must be 16, 24 or 32 bytes
+    explicit AesEcbCipher(const std::string& key);
+    AesEcbCipher(const uint8_t* key, size_t key_len);
+    ~AesEcbCipher();
+
+    // Not copyable or movable: mbedtls contexts may point into themselves
+    AesEcbCipher(const AesEcbCipher&) = delete;
+    AesEcbCipher& operator=(const AesEcbCipher&) = delete;
+
+    static constexpr size_t BLOCK_SIZE = 16;
+
+    // Ciphertext size for `len` bytes of plaintext (PKCS7 always adds 1..16 bytes)
+    static constexpr size_t padded_size(size_t len) { return (len / BLOCK_SIZE + 1) * BLOCK_SIZE; }
+
+    // Raw ECB over whole blocks; len must be a multiple of 16. out may equal in.
+    void encrypt_blocks(const uint8_t* in, uint8_t* out, size_t len);
+    void decrypt_blocks(const uint8_t* in, uint8_t* out, size_t len);
+
+    // Encrypt with PKCS7 padding into out, which needs padded_size(plaintext.size())
+    // bytes and may start at plaintext.data(). Returns the ciphertext length.
+    size_t encrypt(ByteSpan plaintext, MutableByteSpan out);
+    // buf holds `len` bytes of plaintext followed by room for the padding
+    size_t encrypt_in_place(MutableByteSpan buf, size_t len);
+
+    // Decrypt into out (at least ciphertext.size() bytes, may alias ciphertext).
+    // Returns the plaintext length.
+    size_t decrypt(ByteSpan ciphertext, MutableByteSpan out);
+    size_t decrypt_in_place(MutableByteSpan buf);
+
+    // Allocating variants
+    std::vector<uint8_t> encrypt(const std::vector<uint8_t>& plaintext);
+    std::vector<uint8_t> decrypt(const std::vector<uint8_t>& ciphertext);
+
+private:
+    void init(const uint8_t* key, size_t key_len);
+
+#ifdef ESP_PLATFORM
+    mbedtls_aes_context enc_;
+    mbedtls_aes_context dec_;
+#else
+    EVP_CIPHER_CTX* enc_ = nullptr;
+    EVP_CIPHER_CTX* dec_ = nullptr;
+#endif
+};
+
+// Fixed keys used by the protocol (see constants.h)
+enum class ProtocolKey {
+    V2_50,   // AES_KEY_2_50: login request/response
+    NATIVE,  // AES_KEY_NATIVE: device passwords in control frames
+    PRIMARY  // AES_KEY_PRIMARY
+};
+
+// Per-thread cipher for a fixed protocol key, created on first use
+AesEcbCipher& protocol_cipher(ProtocolKey key);
+
+// One-shot helpers; prefer a long-lived AesEcbCipher on hot paths
 std::vector<uint8_t> decrypt_hex_ecb_pkcs7(const std::vector<uint8_t>& ciphertext, const std::string& key);
 std::vector<uint8_t> encrypt_to_hex_ecb_pkcs7(const std::vector<uint8_t>& plaintext, const std::string& key);
 
@@ -1,16 +1,38 @@
 #pragma once
 
 #include "message_stream.h"
+#include "constants.h"
 #include "data_structures.h"
 #include "parser.h"
 #include "oge_ir_device_code.h"
+#include "crc.h"
+#include "crypto.h"
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 
 namespace e7_switcher {
 
+// How E7SwitcherClient reaches the hub; the defaults connect to the Switcher hub over TCP
+struct ConnectionOptions {
+    // Hub address; point these at e.g. a local e7-mock-hub (tools/mock_hub)
+    std::string host = IP_HUB;
+    int port = PORT_HUB;
+    // e.g. a ReplayTransport to run against a capture instead of the hub
+    std::unique_ptr<Transport> transport;
+    // When set, every frame of the session (login included) is recorded here
+    std::string capture_path;
+};
+
+/**
+ * Session with the hub. Public calls may come from several threads: they are
+ * serialized on one lock, as the session has a single connection and reads
+ * replies in request order. metrics() does not take it, so it can be polled
+ * while a call is in flight.
+ */
 class E7SwitcherClient {
 public:
     // Device type constants
@@ -19,6 +41,7 @@ public:
     
 public:
     E7SwitcherClient(const std::string& account, const std::string& password);
+    E7SwitcherClient(const std::string& account, const std::string& password, ConnectionOptions options);
     ~E7SwitcherClient();
     
     // Device operations
@@ -30,16 +53,30 @@ public:
     SwitchStatus get_switch_status(const std::string& device_name);
     ACStatus get_ac_status(const std::string& device_name);
 
+    // Per-command latency histograms and traffic counters since construction
+    // (or the last reset); cheap enough to poll
+    MetricsSnapshot metrics() const;
+    void reset_metrics();
+
 private:
+    // Held for the whole of each public call (except metrics())
+    std::mutex call_mutex_;
+
+    // Filled once, on first use; never changes afterwards
     std::optional<std::vector<Device>> devices_;
     
     // Authentication properties
     int32_t session_id_;
     int32_t user_id_;
     std::vector<uint8_t> communication_secret_key_;
+    SessionCrc session_crc_;
+    // Keyed with communication_secret_key_ at login; decrypts device passwords
+    std::unique_ptr<AesEcbCipher> session_cipher_;
     
     // Stream message handler
     MessageStream stream_;
+    // Reused send buffer; frames are serialized straight into it
+    std::vector<uint8_t> tx_frame_;
     
     OgeIRDeviceCode get_ac_ir_config(const std::string& device_name);
     // Cache for IR device codes
@@ -48,6 +85,9 @@ private:
     // Internal methods
     PhoneLoginRecord login(const std::string& account, const std::string& password);
     
+    // list_devices() for callers already holding call_mutex_
+    const std::vector<Device>& device_list();
+
     // Helper method to find and validate a device
     const Device& find_device_by_name_and_type(
         const std::string& device_name, const std::string& expected_type);
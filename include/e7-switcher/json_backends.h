@@ -0,0 +1,35 @@
+#pragma once
+
+#include <optional>
+#include <vector>
+#include "data_structures.h"
+#include "oge_ir_device_code.h"
+#include "span.h"
+
+namespace e7_switcher {
+
+/**
+ * Desktop JSON backends behind extract_device_list() and
+ * parse_oge_ir_device_code(ByteSpan). Exposed so both can be checked
+ * against each other and benchmarked; regular callers use json_helpers.h.
+ *
+ * simdjson (On-Demand) is used when the library is built with
+ * E7_USE_SIMDJSON=ON. nlohmann::json is always available and is the
+ * fallback for anything the simdjson path does not handle.
+ */
+namespace json_backends {
+
+bool extract_device_list_nlohmann(ByteSpan json_bytes, std::vector<Device>& devices);
+OgeIRDeviceCode parse_oge_ir_device_code_nlohmann(ByteSpan json_bytes);
+
+// Whether the simdjson backend was compiled in
+bool simdjson_enabled();
+
+// std::nullopt means "use the nlohmann path": simdjson is not compiled in,
+// or the input hit an error or a value type the fast path does not replicate
+std::optional<bool> extract_device_list_simdjson(ByteSpan json_bytes, std::vector<Device>& devices);
+std::optional<OgeIRDeviceCode> parse_oge_ir_device_code_simdjson(ByteSpan json_bytes);
+
+} // namespace json_backends
+
+} // namespace e7_switcher
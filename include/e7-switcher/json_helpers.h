@@ -4,10 +4,15 @@
 #include <vector>
 #include "data_structures.h"  // For Device struct
 #include "oge_ir_device_code.h"  // For OgeIRDeviceCode struct
+#include "span.h"
 
 namespace e7_switcher {
 
-// Extract device list from JSON response
+class InflateStream;
+
+// Extract device list from JSON response. Streams the payload and fills
+// Device records directly; no document for the whole list is built.
+bool extract_device_list(ByteSpan json_bytes, std::vector<Device>& devices);
 bool extract_device_list(const std::string& json_str, std::vector<Device>& devices);
 
 // Extract is_rest_day from JSON response
@@ -15,5 +20,17 @@ bool extract_is_rest_day(const std::string& json_str, bool& is_rest_day);
 
 // Parse OgeIRDeviceCode from JSON string
 OgeIRDeviceCode parse_oge_ir_device_code(const std::string& json_str);
+// Parse OgeIRDeviceCode from JSON bytes in place
+OgeIRDeviceCode parse_oge_ir_device_code(ByteSpan json_bytes);
+// Parse OgeIRDeviceCode while inflating, without buffering the decompressed JSON.
+// On ESP32 only the fields AC control uses are filled (ProtocolPara, OnOffType,
+// switch state and IRKeyList), one value at a time, to bound peak heap.
+OgeIRDeviceCode parse_oge_ir_device_code(InflateStream& json_stream);
+// Parse OgeIRDeviceCode keeping the IRKeyList as raw text: metadata is decoded
+// now, keys are only indexed and each is decoded on its first code_by_key() hit
+OgeIRDeviceCode parse_oge_ir_device_code_lazy(std::vector<uint8_t> json_bytes);
+
+// Decode a single IRKeyList entry; false (and an empty key) if it is not valid
+bool parse_ir_key_json(ByteSpan entry_json, IRKey& key);
 
 } // namespace e7_switcher
@@ -1,7 +1,16 @@
 #pragma once
+#include <atomic>
+#include <cstddef>
 #include <string>
 #include <memory>
 
+// Compile-time floor for the E7_LOG_* macros below: calls under it are
+// removed entirely, format strings and argument evaluation included.
+// 0 = DEBUG, 1 = INFO, 2 = WARNING, 3 = ERROR, 4 = none.
+#ifndef E7_LOG_MIN_LEVEL
+#define E7_LOG_MIN_LEVEL 0
+#endif
+
 namespace e7_switcher {
 
 enum class LogLevel {
@@ -11,6 +20,12 @@ enum class LogLevel {
     ERROR
 };
 
+// What AsyncLogger does when its ring buffer is full
+enum class AsyncLogPolicy {
+    DROP,   // discard the message (counted and reported later)
+    BLOCK   // wait for the writer thread to free a slot
+};
+
 class Logger {
 public:
     virtual ~Logger() = default;
@@ -20,7 +35,9 @@ public:
     virtual void warning(const std::string& message) = 0;
     virtual void error(const std::string& message) = 0;
     
-    // Set the minimum log level (messages below this level will be ignored)
+    // Set the minimum log level (messages below this level will be ignored).
+    // The platform loggers also update the level enabled() reads, so this and
+    // Logger::set_level() are interchangeable on instance().
     virtual void set_log_level(LogLevel level) = 0;
     
     // Format string with variadic arguments (similar to printf)
@@ -32,9 +49,60 @@ public:
     // Singleton access
     static Logger& instance();
     static void initialize(LogLevel level = LogLevel::INFO);
+    // Like initialize(), but output is written by a background thread so
+    // logging calls do no I/O (see async_logger.h)
+    static void initialize_async(LogLevel level = LogLevel::INFO, size_t capacity = 1024,
+                                 AsyncLogPolicy policy = AsyncLogPolicy::DROP);
+
+    // Whether the singleton logs at this level: a relaxed load, no virtual
+    // call and no instance() check. Kept in step by every level setter.
+    static bool enabled(LogLevel level) {
+        return level >= level_.load(std::memory_order_relaxed);
+    }
+    // Same as instance().set_log_level(level)
+    static void set_level(LogLevel level);
+
+protected:
+    // For set_log_level() implementations: record the level enabled() checks
+    static void publish_level(LogLevel level) { level_.store(level, std::memory_order_relaxed); }
 
 private:
     static std::unique_ptr<Logger> instance_;
+    static std::atomic<LogLevel> level_;
 };
 
 } // namespace e7_switcher
+
+// printf-style logging through the singleton, checked against enabled()
+// before the arguments are evaluated
+#define E7_LOG_AT_(level, method, ...)                                               \
+    do {                                                                             \
+        if (::e7_switcher::Logger::enabled(::e7_switcher::LogLevel::level)) {        \
+            ::e7_switcher::Logger::instance().method(__VA_ARGS__);                   \
+        }                                                                            \
+    } while (0)
+#define E7_LOG_NOTHING_() do { } while (0)
+
+#if E7_LOG_MIN_LEVEL <= 0
+#define E7_LOG_DEBUG(...) E7_LOG_AT_(DEBUG, debugf, __VA_ARGS__)
+#else
+#define E7_LOG_DEBUG(...) E7_LOG_NOTHING_()
+#endif
+
+#if E7_LOG_MIN_LEVEL <= 1
+#define E7_LOG_INFO(...) E7_LOG_AT_(INFO, infof, __VA_ARGS__)
+#else
+#define E7_LOG_INFO(...) E7_LOG_NOTHING_()
+#endif
+
+#if E7_LOG_MIN_LEVEL <= 2
+#define E7_LOG_WARNING(...) E7_LOG_AT_(WARNING, warningf, __VA_ARGS__)
+#else
+#define E7_LOG_WARNING(...) E7_LOG_NOTHING_()
+#endif
+
+#if E7_LOG_MIN_LEVEL <= 3
+#define E7_LOG_ERROR(...) E7_LOG_AT_(ERROR, errorf, __VA_ARGS__)
+#else
+#define E7_LOG_ERROR(...) E7_LOG_NOTHING_()
+#endif
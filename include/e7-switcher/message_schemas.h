@@ -0,0 +1,163 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include "wire_schema.h"
+#include "parser.h"
+#include "data_structures.h"
+
+namespace e7_switcher {
+
+// --- Request payloads ------------------------------------------------------
+
+struct SwitchControlPayload {
+    int32_t device_id = 0;
+    int32_t user_id = 0;
+    std::array<uint8_t, 32> encrypted_pwd{};
+    uint8_t on_or_off = 0;
+    uint32_t operation_time = 0; // closing time in minutes
+};
+
+// Followed by the control string (control_len - 4 bytes)
+struct ACControlHeader {
+    int32_t device_id = 0;
+    int32_t user_id = 0;
+    std::array<uint8_t, 32> encrypted_pwd{};
+    uint16_t control_len = 0; // control string length + 4
+    uint32_t operation_time = 0;
+};
+
+struct DeviceQueryRequest {
+    int32_t device_id = 0;
+};
+
+struct IRConfigQueryRequest {
+    int32_t user_id = 0;
+    int32_t device_id = 0;
+    std::string ac_code_id;
+};
+
+// --- Response records ------------------------------------------------------
+
+// Common start of a device query response, followed by status_len status bytes
+struct DeviceQueryPrefix {
+    uint16_t original_cmd = 0;
+    uint16_t original_serial = 0;
+    uint32_t original_timestamp = 0;
+    uint8_t state_flag = 0; // needs to be 0 or 3
+    uint16_t rest_len = 0;  // length of rest of payload
+    std::array<uint8_t, 32> device_name{};
+    uint8_t online_state = 0;
+    uint16_t status_len = 0;
+};
+
+namespace schema {
+
+using namespace wire;
+
+using SwitchControl = Schema<
+    Field<&SwitchControlPayload::device_id, U32>,
+    Field<&SwitchControlPayload::user_id, U32>,
+    Field<&SwitchControlPayload::encrypted_pwd, Bytes<32>>,
+    Const<0x0A, 0x06, 0x00>,
+    Const<0x01>, // line_type
+    Field<&SwitchControlPayload::on_or_off, U8>,
+    Field<&SwitchControlPayload::operation_time, U32>
+>;
+static_assert(SwitchControl::size == 49, "switch control payload is 49 bytes");
+
+using ACControl = Schema<
+    Field<&ACControlHeader::device_id, U32>,
+    Field<&ACControlHeader::user_id, U32>,
+    Field<&ACControlHeader::encrypted_pwd, Bytes<32>>,
+    Const<0x01>,
+    Field<&ACControlHeader::control_len, U16>,
+    Field<&ACControlHeader::operation_time, U32>
+>;
+static_assert(ACControl::size == 47, "AC control header is 47 bytes");
+
+using DeviceQuery = Schema<
+    Field<&DeviceQueryRequest::device_id, U32>
+>;
+static_assert(DeviceQuery::size == 4, "device query payload is 4 bytes");
+
+using IRConfigQuery = Schema<
+    Field<&IRConfigQueryRequest::user_id, U32>,
+    Field<&IRConfigQueryRequest::device_id, U32>,
+    Field<&IRConfigQueryRequest::ac_code_id, FixedString<8>>
+>;
+static_assert(IRConfigQuery::size == 16, "IR config query payload is 16 bytes");
+
+using QueryPrefix = Schema<
+    Field<&DeviceQueryPrefix::original_cmd, U16>,
+    Field<&DeviceQueryPrefix::original_serial, U16>,
+    Field<&DeviceQueryPrefix::original_timestamp, U32>,
+    Field<&DeviceQueryPrefix::state_flag, U8>,
+    Field<&DeviceQueryPrefix::rest_len, U16>,
+    Field<&DeviceQueryPrefix::device_name, Bytes<32>>,
+    Field<&DeviceQueryPrefix::online_state, U8>,
+    Field<&DeviceQueryPrefix::status_len, U16>
+>;
+static_assert(QueryPrefix::size == 46, "device query prefix is 46 bytes");
+
+// Switch status bytes following the query prefix
+using SwitchWorkStatus = Schema<
+    Field<&SwitchStatus::wifi_power, U8>,
+    Field<&SwitchStatus::switch_state, U8>,
+    Field<&SwitchStatus::remaining_time, U32>,
+    Field<&SwitchStatus::open_time, U32>,
+    Field<&SwitchStatus::auto_closing_time, U32>,
+    Field<&SwitchStatus::is_delay, U8>
+>;
+static_assert(SwitchWorkStatus::size == 15, "switch status is 15 bytes");
+
+// AC work status (30 bytes; some firmwares append 2 more)
+// ac_data: [on_or_off_code, mode, temperature, fan_code * 16 + swing_code]
+using ACWorkStatus = Schema<
+    Field<&ACStatus::wifi_power, U8>,
+    Field<&ACStatus::temperature, U16Tenths>,
+    Field<&ACStatus::ac_data, Bytes<4>>,
+    Field<&ACStatus::temperature_unit, U8>,
+    Field<&ACStatus::device_type, U8>,
+    Field<&ACStatus::code_id, FixedString<8>>,
+    Field<&ACStatus::last_time, U32>,
+    Field<&ACStatus::open_time, U32>,
+    Field<&ACStatus::auto_closing_time, U32>,
+    Field<&ACStatus::is_delay, U8>
+>;
+static_assert(ACWorkStatus::size == 30, "AC work status is at least 30 bytes");
+
+// PhoneLoginRecord up to the u16 block length (in 2-byte units)
+using PhoneLoginHead = Schema<
+    Field<&PhoneLoginRecord::session_id, U32>,
+    Field<&PhoneLoginRecord::user_id, U32>,
+    Field<&PhoneLoginRecord::communication_secret_key, Bytes<32>>,
+    Field<&PhoneLoginRecord::app_secret_key, Bytes<32>>,
+    Field<&PhoneLoginRecord::comm_enc_mode, U8>,
+    Field<&PhoneLoginRecord::app_enc_mode, U8>,
+    Field<&PhoneLoginRecord::server_time, Bytes<4>>
+>;
+static_assert(PhoneLoginHead::size == 78, "login record head is 78 bytes");
+
+// PhoneLoginRecord after block_a and block_b
+using PhoneLoginTail = Schema<
+    Field<&PhoneLoginRecord::gateway_domain, Bytes<32>>,
+    Field<&PhoneLoginRecord::gateway_port, U16>,
+    Field<&PhoneLoginRecord::gateway_proto, U8>,
+    Field<&PhoneLoginRecord::standby_gateway_domain, Bytes<32>>,
+    Field<&PhoneLoginRecord::standby_gateway_port, U16>,
+    Field<&PhoneLoginRecord::standby_gateway_proto, U8>,
+    Field<&PhoneLoginRecord::tcp_server_ip, Bytes<4>>,
+    Field<&PhoneLoginRecord::tcp_server_port, U16>,
+    Field<&PhoneLoginRecord::tcp_server_proto, U8>,
+    Field<&PhoneLoginRecord::heartbeat_secs, U16>,
+    Field<&PhoneLoginRecord::reply_timeout_secs, U16>,
+    Field<&PhoneLoginRecord::token, Bytes<32>>,
+    Field<&PhoneLoginRecord::nickname, Bytes<32>>
+>;
+static_assert(PhoneLoginTail::size == 145, "login record tail is 145 bytes");
+
+} // namespace schema
+
+} // namespace e7_switcher
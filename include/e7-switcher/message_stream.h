@@ -2,15 +2,19 @@
 
 #include <vector>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include "parser.h"
-#include "socket_utils.h"
+#include "metrics.h"
+#include "transport.h"
+#include "wire_capture.h"
 
 namespace e7_switcher {
 
 class MessageStream {
 public:
-    MessageStream();
+    // Talks over a TCP socket unless given another transport
+    explicit MessageStream(std::unique_ptr<Transport> transport = nullptr);
     ~MessageStream();
 
     // Connection management
@@ -22,24 +26,34 @@ public:
     void send_message(const std::vector<uint8_t>& data);
     void send_message(const ProtocolMessage& message);
     ProtocolMessage receive_message(int timeout_ms = 15000); // long, per-call timeout
+    // Zero-copy variant: the view points into an internal buffer and stays
+    // valid until the next receive call
+    ProtocolMessageView receive_view(int timeout_ms = 15000);
+
+    // Traffic counters for this stream; the client adds operation latencies
+    Metrics& metrics() { return metrics_; }
+    const Metrics& metrics() const { return metrics_; }
+
+    // Record every frame sent and received from now on to a capture file
+    // (see wire_capture.h); throws std::runtime_error if it cannot be created
+    void start_capture(const std::string& path);
+    void stop_capture();
 
 private:
     // Stream helpers
     bool recv_into_buffer_until(size_t min_size, int timeout_ms);
     bool try_extract_one_packet(std::vector<uint8_t>& out);
 
-    // Socket management
-    void create_socket();
-    void set_socket_timeout(int timeout_seconds);
-    
-    std::string host_;
-    int port_;
-    int timeout_;
-    int recv_timeout_seconds_;
-    net::SocketHandle sock_;
+    std::unique_ptr<Transport> transport_;
+    bool has_connected_ = false;
+    std::unique_ptr<CaptureWriter> capture_;
     
     // Incoming stream buffer
     std::vector<uint8_t> inbuf_;
+    // Last extracted frame, backing the view returned by receive_view()
+    std::vector<uint8_t> rx_frame_;
+
+    Metrics metrics_;
 };
 
 } // namespace e7_switcher
@@ -3,13 +3,100 @@
 #include <vector>
 #include <string>
 #include <cstdint>
+#include <cstddef>
 #include "parser.h"
+#include "crc.h"
 
 namespace e7_switcher {
 
+/**
+ * Serializes one protocol frame (header, payload and CRC tail) into a single
+ * contiguous, caller-owned buffer. Reusing the same buffer across frames means
+ * no allocation once it has grown to the largest frame sent.
+ *
+ * The packet CRC is accumulated as bytes are written. Bytes handed out by
+ * reserve() are folded in on the next write, so fill them before writing on.
+ */
+class FrameBuilder {
+public:
+    explicit FrameBuilder(std::vector<uint8_t>& frame);
+
+    // Resize the buffer to the full frame and write the 40-byte header
+    void begin(
+        uint16_t cmd_code,
+        int32_t session,
+        uint16_t serial,
+        uint16_t control_attr,
+        uint8_t direction,
+        uint8_t errcode,
+        int32_t user_id,
+        size_t payload_len,
+        bool is_version_2 = false
+    );
+
+    // Payload writers (little-endian)
+    void u8(uint8_t b);
+    void u16(uint16_t s);
+    void u32(uint32_t i);
+    void put(const std::vector<uint8_t>& d);
+    void put(const std::string& s);
+    void put(const uint8_t* d, size_t n);
+    void put_constant(uint8_t b, size_t n);
+    // Write s truncated / zero-padded to exactly n bytes
+    void put_fixed(const std::string& s, size_t n);
+    // Hand out n payload bytes for the caller to fill in place
+    uint8_t* reserve(size_t n);
+
+    // Check the payload is complete and append the CRC tail
+    void finish(const SessionCrc& session_crc);
+
+    uint32_t timestamp() const { return timestamp_; }
+
+private:
+    void _need(size_t n);
+    void _fold_crc();
+
+    std::vector<uint8_t>& frame_;
+    size_t p_;
+    size_t crc_p_;
+    uint16_t crc_;
+    uint32_t timestamp_;
+};
+
+/**
+ * Writes a complete frame (header, payload, and CRC) into `frame`
+ *
+ * @param frame Output buffer, resized to the frame length
+ * @param cmd_code Command code for the message
+ * @param session Session ID
+ * @param serial Serial number
+ * @param control_attr Control attribute
+ * @param direction Direction (usually 1 for client to server)
+ * @param errcode Error code (usually 0)
+ * @param user_id User ID
+ * @param payload Payload data
+ * @param payload_len Payload length in bytes
+ * @param session_crc Keyed CRC state of the session (built from the communication key)
+ * @param is_version_2 Whether to use protocol version 2 (true) or 3 (false)
+ */
+void build_protocol_frame(
+    std::vector<uint8_t>& frame,
+    uint16_t cmd_code,
+    int32_t session,
+    uint16_t serial,
+    uint16_t control_attr,
+    uint8_t direction,
+    uint8_t errcode,
+    int32_t user_id,
+    const uint8_t* payload,
+    size_t payload_len,
+    const SessionCrc& session_crc,
+    bool is_version_2 = false
+);
+
 /**
  * Creates a complete ProtocolMessage with header, payload, and CRC
- * 
+ *
  * @param cmd_code Command code for the message
  * @param session Session ID
  * @param serial Serial number
@@ -18,7 +105,7 @@ namespace e7_switcher {
  * @param errcode Error code (usually 0)
  * @param user_id User ID
  * @param payload Payload data
- * @param communication_secret_key Key used for CRC calculation
+ * @param session_crc Keyed CRC state of the session (built from the communication key)
  * @param is_version_2 Whether to use protocol version 2 (true) or 3 (false)
  * @return A complete ProtocolMessage object
  */
@@ -31,10 +118,66 @@ ProtocolMessage build_protocol_message(
     uint8_t errcode,
     int32_t user_id,
     const std::vector<uint8_t>& payload,
-    const std::vector<uint8_t>& communication_secret_key,
+    const SessionCrc& session_crc,
     bool is_version_2 = false
 );
 
+// Frame builders: serialize straight into a reusable send buffer
+
+void build_login_frame(
+    std::vector<uint8_t>& frame,
+    const std::string& account,
+    const std::string& password
+);
+
+void build_device_list_frame(
+    std::vector<uint8_t>& frame,
+    int32_t session_id,
+    int32_t user_id,
+    const SessionCrc& session_crc
+);
+
+void build_switch_control_frame(
+    std::vector<uint8_t>& frame,
+    int32_t session_id,
+    int32_t user_id,
+    const SessionCrc& session_crc,
+    int32_t device_id,
+    const std::vector<uint8_t>& device_pwd,
+    int on_or_off,
+    int operation_time = 0
+);
+
+void build_device_query_frame(
+    std::vector<uint8_t>& frame,
+    int32_t session_id,
+    int32_t user_id,
+    const SessionCrc& session_crc,
+    int32_t device_id
+);
+
+void build_ac_ir_config_query_frame(
+    std::vector<uint8_t>& frame,
+    int32_t session_id,
+    int32_t user_id,
+    const SessionCrc& session_crc,
+    int32_t device_id,
+    const std::string& ac_code_id
+);
+
+void build_ac_control_frame(
+    std::vector<uint8_t>& frame,
+    int32_t session_id,
+    int32_t user_id,
+    const SessionCrc& session_crc,
+    int32_t device_id,
+    const std::vector<uint8_t>& device_pwd,
+    const std::string& control_str,
+    int operation_time = 0
+);
+
+// ProtocolMessage variants of the builders above
+
 ProtocolMessage build_login_message(
     const std::string& account,
     const std::string& password
@@ -43,13 +186,13 @@ ProtocolMessage build_login_message(
 ProtocolMessage build_device_list_message(
     int32_t session_id,
     int32_t user_id,
-    const std::vector<uint8_t>& communication_secret_key
+    const SessionCrc& session_crc
 );
 
 ProtocolMessage build_switch_control_message(
     int32_t session_id,
     int32_t user_id,
-    const std::vector<uint8_t>& communication_secret_key,
+    const SessionCrc& session_crc,
     int32_t device_id,
     const std::vector<uint8_t>& device_pwd,
     int on_or_off,
@@ -59,14 +202,14 @@ ProtocolMessage build_switch_control_message(
 ProtocolMessage build_device_query_message(
     int32_t session_id,
     int32_t user_id,
-    const std::vector<uint8_t>& communication_secret_key,
+    const SessionCrc& session_crc,
     int32_t device_id
 );
 
 ProtocolMessage build_ac_ir_config_query_message(
     int32_t session_id,
     int32_t user_id,
-    const std::vector<uint8_t>& communication_secret_key,
+    const SessionCrc& session_crc,
     int32_t device_id,
     std::string ac_code_id
 );
@@ -74,7 +217,7 @@ ProtocolMessage build_ac_ir_config_query_message(
 ProtocolMessage build_ac_control_message(
     int32_t session_id,
     int32_t user_id,
-    const std::vector<uint8_t>& communication_secret_key,
+    const SessionCrc& session_crc,
     int32_t device_id,
     const std::vector<uint8_t>& device_pwd,
     const std::string& control_str,
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace e7_switcher {
+
+// Summary of a LatencyHistogram; all times in microseconds
+struct HistogramSnapshot {
+    uint64_t count = 0;
+    uint32_t min_us = 0;
+    uint32_t max_us = 0;
+    double mean_us = 0;
+    uint32_t p50_us = 0;
+    uint32_t p90_us = 0;
+    uint32_t p99_us = 0;
+    uint32_t p999_us = 0;
+};
+
+/**
+ * Latency histogram with HDR-style log-linear buckets: values below 32 us
+ * get their own bucket, above that every power of two is split into 16
+ * linear sub-buckets, so a reported percentile is at most 1/16 above the
+ * recorded value. Covers the whole uint32_t microsecond range (~71 min) in
+ * a fixed 464 counters; recording is a few adds, with no allocation.
+ *
+ * record() is meant for one thread at a time; snapshot() may run
+ * concurrently from any thread.
+ */
+class LatencyHistogram {
+public:
+    static constexpr size_t BUCKET_COUNT = 464;
+
+    LatencyHistogram();
+
+    void record(uint32_t micros);
+    // Add another histogram's samples (e.g. per-thread ones into a total);
+    // same threading rule as record()
+    void merge(const LatencyHistogram& other);
+    HistogramSnapshot snapshot() const;
+    void reset();
+
+    // Bucket index of a value and the largest value that maps to a bucket
+    static size_t bucket_of(uint32_t micros);
+    static uint32_t bucket_upper(size_t bucket);
+
+private:
+    std::atomic<uint32_t> counts_[BUCKET_COUNT];
+    std::atomic<uint64_t> sum_;
+    std::atomic<uint32_t> min_;
+    std::atomic<uint32_t> max_;
+};
+
+// Latency and outcome of one kind of client operation, keyed by command code
+struct CommandMetrics {
+    uint16_t command = 0;
+    std::string name;
+    HistogramSnapshot latency; // completed operations only
+    uint64_t failures = 0;     // operations that ended with an exception
+};
+
+struct MetricsSnapshot {
+    std::vector<CommandMetrics> commands;
+    uint64_t bytes_sent = 0;
+    uint64_t bytes_received = 0;
+    uint64_t frames_sent = 0;
+    uint64_t frames_received = 0;
+    uint64_t resyncs = 0;       // times garbage was skipped to find a frame header
+    uint64_t bytes_skipped = 0; // bytes discarded by those resyncs
+    uint64_t timeouts = 0;      // socket reads that timed out
+    uint64_t reconnects = 0;
+};
+
+/**
+ * Counters and per-command latency histograms for one connection. The
+ * MessageStream counts traffic; the client times whole operations (request
+ * through final response) with ScopedOperation. Every update is a relaxed
+ * atomic add, so a snapshot can be taken at any time from any thread.
+ */
+class Metrics {
+public:
+    // The command codes with a histogram (see constants.h); others are not timed
+    static constexpr size_t COMMAND_COUNT = 5;
+
+    void record_operation(uint16_t command, uint32_t micros, bool ok);
+
+    void count_sent(size_t bytes) { add(bytes_sent_, bytes); add(frames_sent_, 1); }
+    void count_received(size_t bytes) { add(bytes_received_, bytes); }
+    void count_frame_received() { add(frames_received_, 1); }
+    void count_resync(size_t skipped) { add(resyncs_, 1); add(bytes_skipped_, skipped); }
+    void count_timeout() { add(timeouts_, 1); }
+    void count_reconnect() { add(reconnects_, 1); }
+
+    MetricsSnapshot snapshot() const;
+    void reset();
+
+private:
+    static void add(std::atomic<uint64_t>& counter, uint64_t n) {
+        counter.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    LatencyHistogram latency_[COMMAND_COUNT];
+    std::atomic<uint64_t> failures_[COMMAND_COUNT] = {};
+
+    std::atomic<uint64_t> bytes_sent_{0};
+    std::atomic<uint64_t> bytes_received_{0};
+    std::atomic<uint64_t> frames_sent_{0};
+    std::atomic<uint64_t> frames_received_{0};
+    std::atomic<uint64_t> resyncs_{0};
+    std::atomic<uint64_t> bytes_skipped_{0};
+    std::atomic<uint64_t> timeouts_{0};
+    std::atomic<uint64_t> reconnects_{0};
+};
+
+// Times an operation for as long as it is in scope; one that is left by an
+// exception counts as a failure instead
+class ScopedOperation {
+public:
+    ScopedOperation(Metrics& metrics, uint16_t command);
+    ~ScopedOperation();
+
+    ScopedOperation(const ScopedOperation&) = delete;
+    ScopedOperation& operator=(const ScopedOperation&) = delete;
+
+private:
+    Metrics& metrics_;
+    uint16_t command_;
+    int exceptions_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace e7_switcher
@@ -1,9 +1,12 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <optional>
 #include <array>
+#include <memory>
+#include <cstdint>
 
 namespace e7_switcher {
 // Forward declare IRKey
@@ -21,6 +24,26 @@ struct IRKey {
     std::string hex_code;
 };
 
+// --- IRKeySource ------------------------------------------------------------
+// IRKeyList kept as raw JSON text for lazy decoding: entries are indexed by
+// key up front and each one is decoded on its first lookup.
+struct IRKeySource {
+    struct Entry {
+        std::string key;                 // the entry's "Key"
+        uint32_t offset = 0;             // entry text within json
+        uint32_t length = 0;
+        std::unique_ptr<IRKey> decoded;  // set on first lookup
+    };
+
+    std::vector<uint8_t> json;          // the decompressed IR config
+    std::vector<Entry> entries;         // in IRKeyList order
+    std::unordered_map<std::string_view, uint32_t> by_key; // first entry per key
+
+    const IRKey* at(size_t i);
+    const IRKey* find(const std::string& key);
+    const IRKey* first_containing(const std::string& token);
+};
+
 // --- OgeIRDeviceCode -------------------------------------------------------
 struct OgeIRDeviceCode {
     // Constants
@@ -57,10 +80,16 @@ struct OgeIRDeviceCode {
     // Keys
     std::vector<IRKey> ir_key_list;
     mutable std::unordered_map<std::string, const IRKey*> index;
+    // Lazy mode (parse_oge_ir_device_code_lazy): ir_key_list stays empty and
+    // keys come from here; shared by copies, so each is decoded at most once
+    std::shared_ptr<IRKeySource> lazy_keys;
 
     // Helpers
     void ensure_index() const;
     const IRKey* code_by_key(const std::string& key) const;
+    bool is_lazy() const { return lazy_keys != nullptr; }
+    // Decode every remaining entry into ir_key_list and leave lazy mode
+    void materialize_keys();
 
     // Logic
     const IRKey* ir_code() const;
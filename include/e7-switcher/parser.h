@@ -5,6 +5,7 @@
 #include <cstdint>
 #include <map>
 #include "data_structures.h"
+#include "span.h"
 
 namespace e7_switcher {
 
@@ -34,7 +35,7 @@ struct PhoneLoginRecord {
     std::vector<uint8_t> nickname;
 };
 
-PhoneLoginRecord parse_phone_login(const std::vector<uint8_t>& payload);
+PhoneLoginRecord parse_phone_login(ByteSpan payload);
 
 struct ProtocolMessage {
     uint16_t start_flag;
@@ -54,11 +55,53 @@ struct ProtocolMessage {
 };
 
 
-ProtocolMessage parse_protocol_packet(const std::vector<uint8_t>& payload);
+/**
+ * Non-owning view of one received frame. Header fields are decoded on access
+ * straight from the underlying buffer, which must outlive the view.
+ */
+class ProtocolMessageView {
+public:
+    ProtocolMessageView() = default;
+    // Validates the frame's size and length field; throws std::out_of_range if malformed
+    explicit ProtocolMessageView(ByteSpan frame);
 
-SwitchStatus parse_switch_status(const std::vector<uint8_t>& payload);
+    uint16_t start_flag() const { return le16(0); }
+    uint16_t length() const { return le16(2); }
+    uint16_t version() const { return le16(4); }
+    uint16_t cmd() const { return le16(6); }
+    uint32_t session() const { return le32(8); }
+    uint16_t serial() const { return le16(12); }
+    uint8_t direction() const { return frame_[14]; }
+    uint8_t err_code() const { return frame_[15]; }
+    uint16_t control_attr() const { return le16(16); }
+    uint32_t user_id() const { return le32(18); }
+    uint32_t timestamp() const { return le32(24); }
 
-ACStatus parse_ac_status_from_query_payload(const std::vector<uint8_t>& payload);
-ACStatus parse_ac_status_from_work_status_bytes(const std::vector<uint8_t>& work_status_bytes);
+    ByteSpan frame() const { return frame_; }
+    ByteSpan raw_header() const;
+    ByteSpan payload() const;
+    ByteSpan crc() const;
+
+    // Owning copy, for callers that keep the message past the buffer's lifetime
+    ProtocolMessage to_message() const;
+
+private:
+    uint16_t le16(size_t off) const {
+        return static_cast<uint16_t>(frame_[off] | (frame_[off + 1] << 8));
+    }
+    uint32_t le32(size_t off) const {
+        return static_cast<uint32_t>(frame_[off]) | (static_cast<uint32_t>(frame_[off + 1]) << 8) |
+               (static_cast<uint32_t>(frame_[off + 2]) << 16) | (static_cast<uint32_t>(frame_[off + 3]) << 24);
+    }
+
+    ByteSpan frame_;
+};
+
+ProtocolMessage parse_protocol_packet(ByteSpan packet);
+
+SwitchStatus parse_switch_status(ByteSpan payload);
+
+ACStatus parse_ac_status_from_query_payload(ByteSpan payload);
+ACStatus parse_ac_status_from_work_status_bytes(ByteSpan work_status_bytes);
 
 } // namespace e7_switcher
@@ -27,12 +27,28 @@ bool create_tcp_socket(SocketHandle& out, std::string& err);
 // On success, returns true and assigns a valid SocketHandle to out. On failure, returns false and sets err.
 bool connect(SocketHandle& out, const std::string& host, int port, int timeout_ms, std::string& err);
 
+// Create a TCP socket listening on host:port (IPv4; "0.0.0.0" for all
+// interfaces, port 0 for any free port). Sets SO_REUSEADDR. Returns true on success.
+bool listen_tcp(SocketHandle& out, const std::string& host, int port, int backlog, std::string& err);
+
+// Port a bound socket is listening on, or -1 on error.
+int local_port(SocketHandle s);
+
+// Wait up to timeout_ms for an incoming connection. Return values:
+//   1  : accepted; out holds the new connection
+//   -1 : error (err populated)
+//   -2 : timeout
+int accept(SocketHandle listener, SocketHandle& out, int timeout_ms, std::string& err);
+
 // Close socket safely (idempotent). After close, handle becomes INVALID_SOCKET_HANDLE.
 void close(SocketHandle& s);
 
 // Set SO_RCVTIMEO. On POSIX this is seconds+usec; on Windows it's milliseconds. Here we accept seconds resolution.
 bool set_recv_timeout(SocketHandle s, int timeout_seconds, std::string& err);
 
+// Set TCP_NODELAY (disable Nagle's algorithm). Returns true on success.
+bool set_nodelay(SocketHandle s, bool on, std::string& err);
+
 // Send all bytes in buffer. Returns true on success; false on error (err populated).
 bool send_all(SocketHandle s, const uint8_t* data, size_t len, std::string& err);
 inline bool send_all(SocketHandle s, const std::vector<uint8_t>& v, std::string& err) {
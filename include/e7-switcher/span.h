@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace e7_switcher {
+
+// Minimal non-owning view over contiguous memory (std::span is C++20 only)
+template <typename T>
+class Span {
+public:
+    using element_type = T;
+    using iterator = T*;
+
+    constexpr Span() : data_(nullptr), size_(0) {}
+    constexpr Span(T* data, size_t size) : data_(data), size_(size) {}
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible<U (*)[], T (*)[]>::value>>
+    Span(std::vector<U>& v) : data_(v.data()), size_(v.size()) {}
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible<const U (*)[], T (*)[]>::value>>
+    Span(const std::vector<U>& v) : data_(v.data()), size_(v.size()) {}
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible<U (*)[], T (*)[]>::value>>
+    constexpr Span(const Span<U>& other) : data_(other.data()), size_(other.size()) {}
+
+    constexpr T* data() const { return data_; }
+    constexpr size_t size() const { return size_; }
+    constexpr bool empty() const { return size_ == 0; }
+
+    constexpr T* begin() const { return data_; }
+    constexpr T* end() const { return data_ + size_; }
+
+    constexpr T& operator[](size_t i) const { return data_[i]; }
+
+    // View of [offset, offset + count); count defaults to the rest of the span
+    Span subspan(size_t offset, size_t count = static_cast<size_t>(-1)) const {
+        if (offset > size_) {
+            throw std::out_of_range("Span offset out of range");
+        }
+        size_t rest = size_ - offset;
+        if (count == static_cast<size_t>(-1)) {
+            count = rest;
+        } else if (count > rest) {
+            throw std::out_of_range("Span count out of range");
+        }
+        return Span(data_ + offset, count);
+    }
+
+private:
+    T* data_;
+    size_t size_;
+};
+
+using ByteSpan = Span<const uint8_t>;
+using MutableByteSpan = Span<uint8_t>;
+
+} // namespace e7_switcher
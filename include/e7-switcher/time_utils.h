@@ -7,4 +7,8 @@ namespace e7_switcher {
 int32_t java_bug_seconds_from_now();
 uint32_t now_unix();
 
+// Pin both clocks above to `unix_seconds` so frames come out byte-identical
+// (tests); 0 goes back to the system clock
+void set_fixed_time(uint32_t unix_seconds);
+
 } // namespace e7_switcher
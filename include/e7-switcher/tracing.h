@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Set to 0 to compile E7_TRACE_SPAN out entirely (CMake: -DE7_TRACING=OFF)
+#ifndef E7_TRACING
+#define E7_TRACING 1
+#endif
+
+namespace e7_switcher {
+
+// One finished span. name and category must be string literals (or
+// otherwise outlive the sink's use of them).
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    uint64_t start_us;    // since the first traced event of the process
+    uint64_t duration_us;
+    uint32_t thread_id;   // small per-thread number, 1 for the first thread traced
+};
+
+// Receives every finished span; called on the thread that ran it
+class TraceSink {
+public:
+    virtual ~TraceSink() = default;
+    virtual void record(const TraceEvent& event) = 0;
+};
+
+/**
+ * Global switch for span recording. With no sink set (the default) a span
+ * costs one relaxed load; with one, two clock reads and a record() call.
+ * The sink is owned by the caller and must outlive any traced call that
+ * may still be running when it is replaced or cleared.
+ */
+class Tracer {
+public:
+    static void set_sink(TraceSink* sink);
+    static TraceSink* sink() { return sink_.load(std::memory_order_acquire); }
+    static bool enabled() { return sink_.load(std::memory_order_relaxed) != nullptr; }
+
+    // Microseconds on the trace clock, and the calling thread's number
+    static uint64_t now_us();
+    static uint32_t thread_id();
+
+private:
+    static std::atomic<TraceSink*> sink_;
+};
+
+// Records the enclosing scope as a span, if tracing was on when it started
+class TraceSpan {
+public:
+    TraceSpan(const char* name, const char* category)
+        : sink_(Tracer::sink()), name_(name), category_(category), start_us_(sink_ ? Tracer::now_us() : 0) {}
+    ~TraceSpan() {
+        if (sink_) {
+            sink_->record(TraceEvent{name_, category_, start_us_, Tracer::now_us() - start_us_, Tracer::thread_id()});
+        }
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    TraceSink* sink_;
+    const char* name_;
+    const char* category_;
+    uint64_t start_us_;
+};
+
+/**
+ * Collects spans in memory and writes them as Chrome trace_event JSON
+ * ("X" complete events), for chrome://tracing or https://ui.perfetto.dev.
+ * Thread-safe; spans from every thread land in one trace.
+ */
+class ChromeTraceExporter : public TraceSink {
+public:
+    void record(const TraceEvent& event) override;
+
+    // The trace so far as a JSON document
+    std::string to_json() const;
+    // Write to_json() to a file; throws std::runtime_error if it cannot be written
+    void save(const std::string& path) const;
+
+    size_t size() const;
+    void clear();
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<TraceEvent> events_;
+};
+
+} // namespace e7_switcher
+
+#define E7_TRACE_CONCAT_(a, b) a##b
+#define E7_TRACE_NAME_(line) E7_TRACE_CONCAT_(e7_trace_span_, line)
+
+// Span from here to the end of the enclosing scope
+#if E7_TRACING
+#define E7_TRACE_SPAN(name, category) ::e7_switcher::TraceSpan E7_TRACE_NAME_(__LINE__)(name, category)
+#else
+#define E7_TRACE_SPAN(name, category) do { } while (0)
+#endif
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "socket_utils.h"
+
+namespace e7_switcher {
+
+// Byte transport under MessageStream: a TCP socket to the hub by default,
+// or e.g. a ReplayTransport playing back a capture (see wire_capture.h)
+class Transport {
+public:
+    virtual ~Transport() = default;
+
+    // Throws std::runtime_error on failure
+    virtual void connect(const std::string& host, int port, int timeout_seconds) = 0;
+    virtual void close() = 0;
+    virtual bool is_open() const = 0;
+
+    // Sends all bytes; throws std::runtime_error on failure
+    virtual void send(const uint8_t* data, size_t len) = 0;
+
+    // Waits up to timeout_ms for data. Return values as for net::recv_some:
+    //   > 0 : number of bytes received
+    //   0   : peer closed
+    //   -1  : error (err populated)
+    //   -2  : timeout
+    virtual int receive(uint8_t* buf, size_t max_len, int timeout_ms, std::string& err) = 0;
+};
+
+class SocketTransport : public Transport {
+public:
+    SocketTransport() = default;
+    ~SocketTransport() override;
+
+    SocketTransport(const SocketTransport&) = delete;
+    SocketTransport& operator=(const SocketTransport&) = delete;
+
+    void connect(const std::string& host, int port, int timeout_seconds) override;
+    void close() override;
+    bool is_open() const override;
+    void send(const uint8_t* data, size_t len) override;
+    int receive(uint8_t* buf, size_t max_len, int timeout_ms, std::string& err) override;
+
+private:
+    net::SocketHandle sock_ = net::INVALID_SOCKET_HANDLE;
+    int recv_timeout_seconds_ = 0; // as last set on the socket
+};
+
+} // namespace e7_switcher
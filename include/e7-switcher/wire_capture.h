@@ -0,0 +1,95 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "transport.h"
+
+namespace e7_switcher {
+
+/**
+ * Capture files hold the raw frames of a hub session, as MessageStream sent
+ * and extracted them. Layout (integers little-endian, varints LEB128):
+ *
+ *   header:  "E7WC"  u16 version (1)  u16 reserved (0)
+ *   record:  u8 direction (0 sent, 1 received)
+ *            varint microseconds since the previous record (steady clock)
+ *            varint frame length, then the frame bytes
+ */
+enum class CaptureDirection : uint8_t {
+    SENT = 0,
+    RECEIVED = 1
+};
+
+struct CaptureRecord {
+    CaptureDirection direction;
+    uint64_t time_us; // since the start of the capture
+    std::vector<uint8_t> frame;
+};
+
+class CaptureWriter {
+public:
+    // Throws std::runtime_error if the file cannot be created
+    explicit CaptureWriter(const std::string& path);
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    // Appends one frame; each record is flushed so a capture survives a crash
+    void write(CaptureDirection direction, const uint8_t* frame, size_t len);
+
+private:
+    std::FILE* file_;
+    std::chrono::steady_clock::time_point last_;
+};
+
+// Reads a whole capture file; throws std::runtime_error if it is malformed
+std::vector<CaptureRecord> read_capture(const std::string& path);
+
+/**
+ * Transport that plays a capture back to MessageStream instead of talking to
+ * the hub. Received frames are delivered in order, each after the delay it
+ * originally had from the preceding send (or received frame), divided by
+ * speed; speed 0 delivers as fast as the client reads. What the client sends
+ * is not checked against the capture, only used to pace the replies.
+ *
+ * A receive while the capture expects the client to send first times out at
+ * once, and one past the end reports the peer closing the connection.
+ */
+class ReplayTransport : public Transport {
+public:
+    explicit ReplayTransport(std::vector<CaptureRecord> records, double speed = 1.0);
+    explicit ReplayTransport(const std::string& path, double speed = 1.0);
+
+    void connect(const std::string& host, int port, int timeout_seconds) override;
+    void close() override;
+    bool is_open() const override;
+    void send(const uint8_t* data, size_t len) override;
+    int receive(uint8_t* buf, size_t max_len, int timeout_ms, std::string& err) override;
+
+    // Sends that arrived while the capture expected a received frame
+    size_t unexpected_sends() const { return unexpected_sends_; }
+    bool finished() const { return next_ >= records_.size(); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void anchor(Clock::time_point now, uint64_t capture_time_us);
+
+    std::vector<CaptureRecord> records_;
+    double speed_;
+    bool open_ = false;
+    size_t next_ = 0;
+    size_t offset_ = 0; // into records_[next_].frame when partly delivered
+    size_t unexpected_sends_ = 0;
+
+    // Replay and capture times of the last event; later frames are scheduled from them
+    Clock::time_point anchor_time_;
+    uint64_t anchor_capture_us_ = 0;
+};
+
+} // namespace e7_switcher
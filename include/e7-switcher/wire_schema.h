@@ -0,0 +1,178 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "span.h"
+
+namespace e7_switcher {
+namespace wire {
+
+// --- Field codecs ----------------------------------------------------------
+// A codec knows its wire size and how to load/store one value at a raw pointer.
+// All integers are little-endian.
+
+struct U8 {
+    static constexpr size_t size = 1;
+    template <typename T> static void load(const uint8_t* p, T& v) { v = static_cast<T>(p[0]); }
+    template <typename T> static void store(uint8_t* p, const T& v) { p[0] = static_cast<uint8_t>(v); }
+};
+
+struct U16 {
+    static constexpr size_t size = 2;
+    static uint16_t get(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+    static void put(uint8_t* p, uint16_t v) {
+        p[0] = v & 0xFF;
+        p[1] = (v >> 8) & 0xFF;
+    }
+    template <typename T> static void load(const uint8_t* p, T& v) { v = static_cast<T>(get(p)); }
+    template <typename T> static void store(uint8_t* p, const T& v) { put(p, static_cast<uint16_t>(v)); }
+};
+
+struct U32 {
+    static constexpr size_t size = 4;
+    static uint32_t get(const uint8_t* p) {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+               (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+    static void put(uint8_t* p, uint32_t v) {
+        p[0] = v & 0xFF;
+        p[1] = (v >> 8) & 0xFF;
+        p[2] = (v >> 16) & 0xFF;
+        p[3] = (v >> 24) & 0xFF;
+    }
+    template <typename T> static void load(const uint8_t* p, T& v) { v = static_cast<T>(get(p)); }
+    template <typename T> static void store(uint8_t* p, const T& v) { put(p, static_cast<uint32_t>(v)); }
+};
+
+// u16 holding a value in tenths (e.g. 235 -> 23.5 degrees)
+struct U16Tenths {
+    static constexpr size_t size = 2;
+    template <typename T> static void load(const uint8_t* p, T& v) { v = static_cast<T>(U16::get(p) / 10.0); }
+    template <typename T> static void store(uint8_t* p, const T& v) {
+        U16::put(p, static_cast<uint16_t>(std::lround(v * 10.0)));
+    }
+};
+
+// Raw bytes; stores truncate or zero-pad a vector to N
+template <size_t N>
+struct Bytes {
+    static constexpr size_t size = N;
+    static void load(const uint8_t* p, std::vector<uint8_t>& v) { v.assign(p, p + N); }
+    static void load(const uint8_t* p, std::array<uint8_t, N>& v) { std::memcpy(v.data(), p, N); }
+    static void store(uint8_t* p, const std::vector<uint8_t>& v) {
+        size_t n = v.size() < N ? v.size() : N;
+        if (n > 0) std::memcpy(p, v.data(), n);
+        std::memset(p + n, 0, N - n);
+    }
+    static void store(uint8_t* p, const std::array<uint8_t, N>& v) { std::memcpy(p, v.data(), N); }
+};
+
+// NUL-padded string; loads drop every NUL byte, stores truncate or zero-pad
+template <size_t N>
+struct FixedString {
+    static constexpr size_t size = N;
+    static void load(const uint8_t* p, std::string& v) {
+        v.clear();
+        for (size_t i = 0; i < N; ++i) {
+            if (p[i] != '\0') v.push_back(static_cast<char>(p[i]));
+        }
+    }
+    static void store(uint8_t* p, const std::string& v) {
+        size_t n = v.size() < N ? v.size() : N;
+        std::memcpy(p, v.data(), n);
+        std::memset(p + n, 0, N - n);
+    }
+};
+
+// --- Schema elements -------------------------------------------------------
+
+// A struct member encoded with a codec
+template <auto Member, typename Codec>
+struct Field {
+    static constexpr size_t size = Codec::size;
+    template <typename T> static void load(const uint8_t* p, T& obj) { Codec::load(p, obj.*Member); }
+    template <typename T> static void store(uint8_t* p, const T& obj) { Codec::store(p, obj.*Member); }
+};
+
+// Fixed bytes; ignored on load
+template <uint8_t... B>
+struct Const {
+    static constexpr size_t size = sizeof...(B);
+    template <typename T> static void load(const uint8_t*, T&) {}
+    template <typename T> static void store(uint8_t* p, const T&) {
+        constexpr uint8_t bytes[] = {B...};
+        std::memcpy(p, bytes, size);
+    }
+};
+
+/**
+ * Fixed-size record layout. Offsets are compile-time constants, so decode()
+ * and encode() unroll into straight-line loads/stores after a single bounds
+ * check.
+ */
+template <typename... Elems>
+struct Schema {
+    static constexpr size_t size = (Elems::size + ... + 0);
+
+    // Decode from the start of `in` (trailing bytes are ignored)
+    template <typename T>
+    static void decode(ByteSpan in, T& out) {
+        if (in.size() < size) {
+            throw std::out_of_range("Not enough data in buffer");
+        }
+        decode_unchecked(in.data(), out, std::index_sequence_for<Elems...>{});
+    }
+
+    template <typename T>
+    static T decode(ByteSpan in) {
+        T out{};
+        decode(in, out);
+        return out;
+    }
+
+    // Encode into exactly `size` bytes at `out`
+    template <typename T>
+    static void encode(const T& in, uint8_t* out) {
+        encode_unchecked(in, out, std::index_sequence_for<Elems...>{});
+    }
+
+    template <typename T>
+    static void encode(const T& in, MutableByteSpan out) {
+        if (out.size() < size) {
+            throw std::out_of_range("Not enough room in buffer");
+        }
+        encode(in, out.data());
+    }
+
+private:
+    static constexpr std::array<size_t, sizeof...(Elems) + 1> offsets() {
+        std::array<size_t, sizeof...(Elems) + 1> out{};
+        size_t sizes[] = {Elems::size..., 0};
+        for (size_t i = 0; i < sizeof...(Elems); ++i) {
+            out[i + 1] = out[i] + sizes[i];
+        }
+        return out;
+    }
+
+    template <typename T, size_t... I>
+    static void decode_unchecked(const uint8_t* p, T& out, std::index_sequence<I...>) {
+        constexpr auto off = offsets();
+        (Elems::load(p + off[I], out), ...);
+    }
+
+    template <typename T, size_t... I>
+    static void encode_unchecked(const T& in, uint8_t* p, std::index_sequence<I...>) {
+        constexpr auto off = offsets();
+        (Elems::store(p + off[I], in), ...);
+    }
+};
+
+} // namespace wire
+} // namespace e7_switcher
@@ -5,14 +5,21 @@ A Python wrapper for the E7 Switcher library that allows controlling Switcher de
 """
 
 from .client import E7SwitcherClient
+from .async_client import AsyncE7SwitcherClient
 from .enums import ACMode, ACFanSpeed, ACSwing, ACPower
+from ._core import Device, DeviceList, SwitchStatus, ACStatus
 from .version import __version__
 
 __all__ = [
     'E7SwitcherClient',
+    'AsyncE7SwitcherClient',
     'ACMode',
     'ACFanSpeed',
     'ACSwing',
     'ACPower',
+    'Device',
+    'DeviceList',
+    'SwitchStatus',
+    'ACStatus',
     '__version__',
 ]
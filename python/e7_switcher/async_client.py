@@ -0,0 +1,204 @@
+"""
+E7 Switcher asyncio client
+
+An asyncio interface to the E7 Switcher library that needs no executor threads.
+"""
+
+import asyncio
+from typing import Any, Callable, Dict, Optional, Sequence
+
+from . import _core
+from .client import E7SwitcherClient
+from .enums import ACMode, ACFanSpeed, ACSwing
+
+
+def _settle(future: "asyncio.Future", result: Any, error: Optional[str]) -> None:
+    # Runs on the event loop; the awaiting task may have been cancelled meanwhile
+    if future.cancelled():
+        return
+    if error is not None:
+        future.set_exception(RuntimeError(error))
+    else:
+        future.set_result(result)
+
+
+class AsyncE7SwitcherClient:
+    """
+    asyncio client for controlling Switcher devices.
+
+    Each client owns one hub session, served by a background thread in the
+    C++ library. Calls return at once: they are queued on that thread, and
+    their results come back to the event loop through
+    ``loop.call_soon_threadsafe``. Any number of calls can be awaited at the
+    same time without a thread pool. The session has a single connection, so
+    the hub still sees them one at a time, in the order they were made.
+
+    Cancelling an awaiting task abandons its result, but a call that has
+    already reached the hub still completes there.
+
+    Usage:
+        async with await AsyncE7SwitcherClient.connect(account, password) as client:
+            devices = await client.list_devices()
+            await client.control_switch("Boiler", True)
+    """
+
+    def __init__(self, account: str, password: str, host: Optional[str] = None, port: Optional[int] = None):
+        """
+        Start connecting in the background; use ``await client.wait_connected()``
+        (or the ``connect()`` factory) to learn whether login succeeded.
+        Calls made before then are queued and run after login.
+
+        Args:
+            account: The account username for the Switcher service
+            password: The password for the Switcher service
+            host: Hub address to connect to instead of the Switcher hub (e.g. a local mock hub)
+            port: Hub port to use with host
+        """
+        kwargs = {}
+        if host is not None:
+            kwargs["host"] = host
+        if port is not None:
+            kwargs["port"] = port
+        self._worker = _core.ClientWorker(account, password, **kwargs)
+        self._closed = False
+        # The hub's device list is fetched once per session and does not change
+        self._devices: Optional[Sequence[_core.Device]] = None
+
+    @classmethod
+    async def connect(cls, account: str, password: str,
+                      host: Optional[str] = None, port: Optional[int] = None) -> "AsyncE7SwitcherClient":
+        """
+        Create a client and wait for it to log in.
+
+        Raises:
+            RuntimeError: If connection or authentication fails
+        """
+        client = cls(account, password, host, port)
+        try:
+            await client.wait_connected()
+        except BaseException:
+            await client.close()
+            raise
+        return client
+
+    def _submit(self, method: Callable[..., None], *args: Any) -> "asyncio.Future":
+        loop = asyncio.get_running_loop()
+        future = loop.create_future()
+
+        def done(result: Any, error: Optional[str]) -> None:
+            # Called on the worker thread
+            try:
+                loop.call_soon_threadsafe(_settle, future, result, error)
+            except RuntimeError:
+                pass  # the loop is closed; nobody is waiting any more
+
+        method(*args, done)
+        return future
+
+    async def wait_connected(self) -> None:
+        """
+        Wait until the client has logged in.
+
+        Raises:
+            RuntimeError: If connection or authentication failed
+        """
+        await self._submit(self._worker.ready)
+
+    async def list_devices(self) -> Sequence[_core.Device]:
+        """
+        Get a list of all available devices, as read-only Device objects;
+        fetched on the first call and returned as-is afterwards.
+
+        Raises:
+            RuntimeError: If the device list cannot be retrieved
+        """
+        if self._devices is None:
+            self._devices = tuple(await self._submit(self._worker.list_devices))
+        return self._devices
+
+    async def control_switch(self, device_name: str, turn_on: bool, operation_time: int = 0) -> None:
+        """
+        Control a switch device; see E7SwitcherClient.control_switch.
+
+        Raises:
+            RuntimeError: If the device is not found or the command fails
+        """
+        action = "on" if turn_on and turn_on != "off" else "off"
+        await self._submit(self._worker.control_switch, device_name, action, operation_time)
+
+    async def control_ac(self,
+                         device_name: str,
+                         turn_on: bool,
+                         mode: ACMode = ACMode.COOL,
+                         temperature: int = 20,
+                         fan_speed: ACFanSpeed = ACFanSpeed.FAN_MEDIUM,
+                         swing: ACSwing = ACSwing.SWING_ON,
+                         operation_time: int = 0) -> None:
+        """
+        Control an air conditioner device; see E7SwitcherClient.control_ac.
+
+        Raises:
+            RuntimeError: If the device is not found or the command fails
+            ValueError: If parameters are invalid
+        """
+        action = "on" if turn_on and turn_on != "off" else "off"
+        await self._submit(
+            self._worker.control_ac,
+            device_name,
+            action,
+            E7SwitcherClient._to_core_enum(_core.ACMode, mode),
+            temperature,
+            E7SwitcherClient._to_core_enum(_core.ACFanSpeed, fan_speed),
+            E7SwitcherClient._to_core_enum(_core.ACSwing, swing),
+            operation_time,
+        )
+
+    async def get_switch_status(self, device_name: str) -> _core.SwitchStatus:
+        """
+        Get the status of a switch device; see E7SwitcherClient.get_switch_status.
+
+        Raises:
+            RuntimeError: If the device is not found or the status cannot be retrieved
+        """
+        return await self._submit(self._worker.get_switch_status, device_name)
+
+    async def get_ac_status(self, device_name: str) -> _core.ACStatus:
+        """
+        Get the status of an air conditioner device; see E7SwitcherClient.get_ac_status.
+
+        Raises:
+            RuntimeError: If the device is not found or the status cannot be retrieved
+        """
+        return await self._submit(self._worker.get_ac_status, device_name)
+
+    async def metrics(self) -> Dict[str, Any]:
+        """Get latency and traffic metrics for this client; see E7SwitcherClient.metrics."""
+        return await self._submit(self._worker.metrics)
+
+    async def reset_metrics(self) -> None:
+        """Clear all metrics collected so far."""
+        await self._submit(self._worker.reset_metrics)
+
+    async def close(self) -> None:
+        """
+        Disconnect. Calls still queued fail with RuntimeError; the one in
+        progress is allowed to finish first. Safe to call more than once.
+        """
+        if self._closed:
+            return
+        self._closed = True
+        # Runs (failing) once the call in progress is done, i.e. when the
+        # worker is about to exit, so the final join below does not block
+        stopped = self._submit(self._worker.ready)
+        self._worker.stop()
+        try:
+            await stopped
+        except RuntimeError:
+            pass
+        self._worker.close()
+
+    async def __aenter__(self) -> "AsyncE7SwitcherClient":
+        return self
+
+    async def __aexit__(self, *exc_info: Any) -> None:
+        await self.close()
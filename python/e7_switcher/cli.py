@@ -26,7 +26,19 @@ def _make_client(args: argparse.Namespace) -> E7SwitcherClient:
     return E7SwitcherClient(account, password)
 
 
+def _plain(obj: Any) -> Any:
+    # Result objects (Device, SwitchStatus, ACStatus) and device lists -> dicts/lists
+    if hasattr(obj, "to_dict"):
+        return obj.to_dict()
+    if hasattr(obj, "to_list"):
+        return obj.to_list()
+    if isinstance(obj, (list, tuple)):
+        return [_plain(o) for o in obj]
+    return obj
+
+
 def _print(obj: Any, fmt: str) -> None:
+    obj = _plain(obj)
     if fmt == "json":
         print(json.dumps(obj, indent=2, ensure_ascii=False))
     else:
@@ -4,7 +4,7 @@ E7 Switcher Python Client
 A high-level Python wrapper for the E7 Switcher library.
 """
 
-from typing import List, Dict, Union
+from typing import Any, Dict, Optional, Sequence, Union
 
 from . import _core
 from .enums import ACMode, ACFanSpeed, ACSwing, ACPower
@@ -16,20 +16,32 @@ class E7SwitcherClient:
     
     This class provides a Pythonic interface to the E7 Switcher library,
     allowing you to control Switcher devices such as switches and air conditioners.
+
+    Calls release the GIL while they wait on the network, and one client may be
+    shared between threads; its calls are then served one at a time.
     """
     
-    def __init__(self, account: str, password: str):
+    def __init__(self, account: str, password: str, host: Optional[str] = None, port: Optional[int] = None):
         """
         Initialize a new Switcher client.
         
         Args:
             account: The account username for the Switcher service
             password: The password for the Switcher service
+            host: Hub address to connect to instead of the Switcher hub (e.g. a local mock hub)
+            port: Hub port to use with host
         
         Raises:
             RuntimeError: If connection or authentication fails
         """
-        self._client = _core.E7SwitcherClient(account, password)
+        kwargs = {}
+        if host is not None:
+            kwargs["host"] = host
+        if port is not None:
+            kwargs["port"] = port
+        self._client = _core.E7SwitcherClient(account, password, **kwargs)
+        # The hub's device list is fetched once per session and does not change
+        self._devices: Optional[Sequence[_core.Device]] = None
     
     @staticmethod
     def _to_core_enum(core_enum_cls, value):
@@ -67,17 +79,21 @@ class E7SwitcherClient:
         except Exception as exc:
             raise ValueError(f"Invalid value '{value}' for enum {core_enum_cls.__name__}") from exc
     
-    def list_devices(self) -> List[Dict[str, Union[str, bool, int]]]:
+    def list_devices(self) -> Sequence[_core.Device]:
         """
         Get a list of all available devices.
         
         Returns:
-            A list of device dictionaries, each containing device information
+            A read-only sequence of Device objects (name, ssid, mac, type,
+            firmware, online, line_no, line_type, did), fetched on the first
+            call and returned as-is afterwards; use device.to_dict() for a dict
             
         Raises:
             RuntimeError: If the device list cannot be retrieved
         """
-        return self._client.list_devices()
+        if self._devices is None:
+            self._devices = self._client.list_devices()
+        return self._devices
     
     def control_switch(self, device_name: str, turn_on: bool, operation_time: int = 0) -> None:
         """
@@ -133,7 +149,7 @@ class E7SwitcherClient:
             operation_time,
         )
     
-    def get_switch_status(self, device_name: str) -> Dict[str, Union[bool, int]]:
+    def get_switch_status(self, device_name: str) -> _core.SwitchStatus:
         """
         Get the status of a switch device.
         
@@ -141,7 +157,9 @@ class E7SwitcherClient:
             device_name: The name of the switch device
             
         Returns:
-            A dictionary containing the switch status information
+            A read-only SwitchStatus (wifi_power, switch_state, remaining_time,
+            open_time, auto_closing_time, is_delay, online_state); to_dict()
+            gives the same fields as a dict
             
         Raises:
             RuntimeError: If the device is not found or the status cannot be retrieved
@@ -149,7 +167,7 @@ class E7SwitcherClient:
         """
         return self._client.get_switch_status(device_name)
     
-    def get_ac_status(self, device_name: str) -> Dict[str, Union[str, int, float, bool]]:
+    def get_ac_status(self, device_name: str) -> _core.ACStatus:
         """
         Get the status of an air conditioner device.
         
@@ -157,7 +175,9 @@ class E7SwitcherClient:
             device_name: The name of the AC device
             
         Returns:
-            A dictionary containing the AC status information
+            A read-only ACStatus; power_status, mode, fan_speed and swing are
+            ints that compare equal to the ACPower/ACMode/ACFanSpeed/ACSwing
+            members. to_dict() gives the same fields as a dict
             
         Raises:
             RuntimeError: If the device is not found or the status cannot be retrieved
@@ -165,6 +185,23 @@ class E7SwitcherClient:
         """
         return self._client.get_ac_status(device_name)
     
+    def metrics(self) -> Dict[str, Any]:
+        """
+        Get latency and traffic metrics for this client.
+        
+        Returns:
+            A dictionary with per-command latency summaries under "commands"
+            (keyed by command name: count, min/mean/max and p50/p90/p99/p999
+            in microseconds, plus a failure count), and connection counters:
+            bytes_sent, bytes_received, frames_sent, frames_received,
+            resyncs, bytes_skipped, timeouts and reconnects
+        """
+        return self._client.metrics()
+    
+    def reset_metrics(self) -> None:
+        """Clear all metrics collected so far."""
+        self._client.reset_metrics()
+    
     def control_ac_fluent(self, device_name: str) -> "ACFluentControl":
         """Start a fluent AC control sequence for the given device."""
         return ACFluentControl(self, device_name)
@@ -184,20 +221,20 @@ class ACFluentControl:
         status = client.get_ac_status(device_name)
         # Map current status to Python enums/values (they align with core values)
         try:
-            self._power: ACPower = ACPower(int(status.get("power_status", 0)))
+            self._power: ACPower = ACPower(status.power_status)
         except Exception:
             self._power = ACPower.POWER_OFF
         try:
-            self._mode: ACMode = ACMode(int(status.get("mode", ACMode.COOL)))
+            self._mode: ACMode = ACMode(status.mode)
         except Exception:
             self._mode = ACMode.COOL
-        self._temperature: int = int(status.get("ac_temperature", status.get("temperature", 20)))
+        self._temperature: int = int(status.ac_temperature)
         try:
-            self._fan_speed: ACFanSpeed = ACFanSpeed(int(status.get("fan_speed", ACFanSpeed.FAN_MEDIUM)))
+            self._fan_speed: ACFanSpeed = ACFanSpeed(status.fan_speed)
         except Exception:
             self._fan_speed = ACFanSpeed.FAN_MEDIUM
         try:
-            self._swing: ACSwing = ACSwing(int(status.get("swing", ACSwing.SWING_ON)))
+            self._swing: ACSwing = ACSwing(status.swing)
         except Exception:
             self._swing = ACSwing.SWING_ON
         self._operation_time: int = 0
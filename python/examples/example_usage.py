@@ -66,16 +66,16 @@ def main():
             devices = client.list_devices()
             print(f"Found {len(devices)} devices:")
             for device in devices:
-                device_type = "Switch" if device["type"] == "0F04" else "AC" if device["type"] == "0E01" else "Unknown"
-                status = "Online" if device["online"] else "Offline"
-                print(f"  - {device['name']} ({device_type}): {status}")
+                device_type = "Switch" if device.type == "0F04" else "AC" if device.type == "0E01" else "Unknown"
+                status = "Online" if device.online else "Offline"
+                print(f"  - {device.name} ({device_type}): {status}")
         
         elif args.command == "switch-status":
             status = client.get_switch_status(args.device)
-            state = "ON" if status["switch_state"] else "OFF"
+            state = "ON" if status.switch_state else "OFF"
             print(f"Switch {args.device} is {state}")
-            print(f"  WiFi Power: {status['wifi_power']}")
-            print(f"  Remaining Time: {status['remaining_time']} minutes")
+            print(f"  WiFi Power: {status.wifi_power}")
+            print(f"  Remaining Time: {status.remaining_time} minutes")
         
         elif args.command == "switch-on":
             print(f"Turning ON switch: {args.device}")
@@ -89,16 +89,16 @@ def main():
         
         elif args.command == "ac-status":
             status = client.get_ac_status(args.device)
-            power = "ON" if status["power_status"] == 1 else "OFF"
+            power = "ON" if status.power_status == 1 else "OFF"
             mode_map = {1: "AUTO", 2: "DRY", 3: "FAN", 4: "COOL", 5: "HEAT"}
             fan_map = {1: "LOW", 2: "MEDIUM", 3: "HIGH", 4: "AUTO"}
-            swing = "ON" if status["swing"] == 1 else "OFF"
+            swing = "ON" if status.swing == 1 else "OFF"
             
             print(f"AC {args.device} is {power}")
-            if status["power_status"] == 1:
-                print(f"  Mode: {mode_map.get(status['mode'], 'Unknown')}")
-                print(f"  Temperature: {status['ac_temperature']}°C")
-                print(f"  Fan Speed: {fan_map.get(status['fan_speed'], 'Unknown')}")
+            if status.power_status == 1:
+                print(f"  Mode: {mode_map.get(status.mode, 'Unknown')}")
+                print(f"  Temperature: {status.ac_temperature}°C")
+                print(f"  Fan Speed: {fan_map.get(status.fan_speed, 'Unknown')}")
                 print(f"  Swing: {swing}")
         
         elif args.command == "ac-on":
@@ -3,8 +3,12 @@
 #include <pybind11/functional.h>
 
 #include "e7-switcher/e7_switcher_client.h"
+#include "e7-switcher/client_worker.h"
 #include "e7-switcher/data_structures.h"
 
+#include <optional>
+#include <type_traits>
+
 namespace py = pybind11;
 using namespace e7_switcher;
 
@@ -57,8 +61,226 @@ py::dict ac_status_to_dict(const ACStatus& status) {
     return result;
 }
 
+// obj["field"] for code written against the dict results: same keys and
+// values as to_dict(), read-only, KeyError for anything else
+template <typename T, py::dict (*ToDict)(const T&)>
+py::object dict_item(const T& value, const std::string& key) {
+    py::dict fields = ToDict(value);
+    py::str name(key);
+    if (!fields.contains(name)) {
+        throw py::key_error(key);
+    }
+    return fields[name];
+}
+
+// Helper function to convert HistogramSnapshot to Python dict
+py::dict histogram_to_dict(const HistogramSnapshot& h) {
+    py::dict result;
+    result["count"] = h.count;
+    result["min_us"] = h.min_us;
+    result["max_us"] = h.max_us;
+    result["mean_us"] = h.mean_us;
+    result["p50_us"] = h.p50_us;
+    result["p90_us"] = h.p90_us;
+    result["p99_us"] = h.p99_us;
+    result["p999_us"] = h.p999_us;
+    return result;
+}
+
+// Helper function to convert MetricsSnapshot to Python dict; commands are keyed by name
+py::dict metrics_to_dict(const MetricsSnapshot& metrics) {
+    py::dict commands;
+    for (const auto& c : metrics.commands) {
+        py::dict command;
+        command["command"] = c.command;
+        command["latency"] = histogram_to_dict(c.latency);
+        command["failures"] = c.failures;
+        commands[py::str(c.name)] = command;
+    }
+    py::dict result;
+    result["commands"] = commands;
+    result["bytes_sent"] = metrics.bytes_sent;
+    result["bytes_received"] = metrics.bytes_received;
+    result["frames_sent"] = metrics.frames_sent;
+    result["frames_received"] = metrics.frames_received;
+    result["resyncs"] = metrics.resyncs;
+    result["bytes_skipped"] = metrics.bytes_skipped;
+    result["timeouts"] = metrics.timeouts;
+    result["reconnects"] = metrics.reconnects;
+    return result;
+}
+
+// Read-only sequence over a client's device list. The client fetches the list
+// once per session and never changes it afterwards, so the view (and the
+// Device objects it hands out) refer to it instead of copying; Python keeps
+// the client alive for as long as the view exists.
+struct DeviceListView {
+    const std::vector<Device>* devices;
+
+    const Device& at(py::ssize_t index) const {
+        py::ssize_t size = static_cast<py::ssize_t>(devices->size());
+        if (index < 0) index += size;
+        if (index < 0 || index >= size) throw py::index_error("device index out of range");
+        return (*devices)[static_cast<size_t>(index)];
+    }
+};
+
+// --- ClientWorker glue (AsyncE7SwitcherClient) ---------------------------------
+
+// A Python callable owned by a worker job; released with the GIL held, on
+// whichever thread drops the last reference
+using PyCallback = std::shared_ptr<py::function>;
+
+PyCallback hold_callback(py::function fn) {
+    return PyCallback(new py::function(std::move(fn)), [](py::function* f) {
+        py::gil_scoped_acquire gil;
+        delete f;
+    });
+}
+
+// done(None, message) for a failed call; needs the GIL
+void report_error(const py::function& done, std::exception_ptr error) {
+    std::string message;
+    try {
+        std::rethrow_exception(error);
+    } catch (const std::exception& e) {
+        message = e.what();
+    } catch (...) {
+        message = "Unknown error";
+    }
+    done(py::none(), py::str(message));
+}
+
+// Queue call(client) on the worker; when it returns, take the GIL and report
+// to done(result, error): convert(value) and None, or None and the error
+// message. convert is unused (pass nullptr) when call returns void.
+template <typename Call, typename Convert>
+void submit_call(ClientWorker& worker, py::function done, Call call, Convert convert) {
+    PyCallback callback = hold_callback(std::move(done));
+    worker.submit([callback, call, convert](E7SwitcherClient* client, std::exception_ptr error) {
+        using Result = decltype(call(*client));
+        std::conditional_t<std::is_void_v<Result>, bool, std::optional<Result>> result{};
+        if (!error) {
+            try {
+                if constexpr (std::is_void_v<Result>) {
+                    call(*client);
+                } else {
+                    result = call(*client);
+                }
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+
+        py::gil_scoped_acquire gil;
+        try {
+            if (error) {
+                report_error(*callback, error);
+            } else if constexpr (std::is_void_v<Result>) {
+                (*callback)(py::none(), py::none());
+            } else {
+                (*callback)(convert(*result), py::none());
+            }
+        } catch (py::error_already_set& e) {
+            // Raised by done itself; there is no caller to hand it to
+            e.discard_as_unraisable("e7_switcher ClientWorker callback");
+        }
+    });
+}
+
+// Owns the worker for Python. Stopping it waits for the running job, which may
+// itself be waiting for the GIL to report back, so the GIL is released around it.
+struct PyClientWorker {
+    std::unique_ptr<ClientWorker> worker;
+
+    ~PyClientWorker() { close(); }
+    void close() {
+        // Detach first, so calls made while the GIL is released see it closed
+        std::unique_ptr<ClientWorker> closing = std::move(worker);
+        if (closing) {
+            py::gil_scoped_release release;
+            closing.reset();
+        }
+    }
+    ClientWorker& get() {
+        if (!worker) throw std::runtime_error("Client worker is closed");
+        return *worker;
+    }
+};
+
 PYBIND11_MODULE(_core, m) {
     m.doc() = "E7 Switcher Python bindings";
+
+    // Result types: read-only views of the C++ structs. Fields are converted
+    // when read, not up front; to_dict() gives the previous dict form (enum
+    // fields as ints, as there) and obj["field"] still reads like it did.
+    py::class_<Device>(m, "Device")
+        .def_readonly("name", &Device::name)
+        .def_readonly("ssid", &Device::ssid)
+        .def_readonly("mac", &Device::mac)
+        .def_readonly("type", &Device::type)
+        .def_readonly("firmware", &Device::firmware)
+        .def_readonly("online", &Device::online)
+        .def_readonly("line_no", &Device::line_no)
+        .def_readonly("line_type", &Device::line_type)
+        .def_readonly("did", &Device::did)
+        .def("to_dict", &device_to_dict)
+        .def("__getitem__", &dict_item<Device, device_to_dict>)
+        .def("__repr__", [](const Device& d) {
+            return "<Device name='" + d.name + "' type=" + d.type + " did=" + std::to_string(d.did) +
+                   (d.online ? " online>" : " offline>");
+        });
+
+    py::class_<SwitchStatus>(m, "SwitchStatus")
+        .def_readonly("wifi_power", &SwitchStatus::wifi_power)
+        .def_readonly("switch_state", &SwitchStatus::switch_state)
+        .def_readonly("remaining_time", &SwitchStatus::remaining_time)
+        .def_readonly("open_time", &SwitchStatus::open_time)
+        .def_readonly("auto_closing_time", &SwitchStatus::auto_closing_time)
+        .def_readonly("is_delay", &SwitchStatus::is_delay)
+        .def_readonly("online_state", &SwitchStatus::online_state)
+        .def("to_dict", &switch_status_to_dict)
+        .def("__getitem__", &dict_item<SwitchStatus, switch_status_to_dict>)
+        .def("__repr__", [](const SwitchStatus& s) { return "<SwitchStatus " + s.to_string() + ">"; });
+
+    // power_status, mode, fan_speed and swing read as ints, which compare
+    // equal to the e7_switcher.enums members
+    py::class_<ACStatus>(m, "ACStatus")
+        .def_readonly("wifi_power", &ACStatus::wifi_power)
+        .def_readonly("temperature", &ACStatus::temperature)
+        .def_property_readonly("power_status", [](const ACStatus& s) { return static_cast<int>(s.power_status); })
+        .def_property_readonly("mode", [](const ACStatus& s) { return static_cast<int>(s.mode); })
+        .def_readonly("ac_temperature", &ACStatus::ac_temperature)
+        .def_property_readonly("fan_speed", [](const ACStatus& s) { return static_cast<int>(s.fan_speed); })
+        .def_property_readonly("swing", [](const ACStatus& s) { return static_cast<int>(s.swing); })
+        .def_readonly("temperature_unit", &ACStatus::temperature_unit)
+        .def_readonly("device_type", &ACStatus::device_type)
+        .def_readonly("code_id", &ACStatus::code_id)
+        .def_readonly("last_time", &ACStatus::last_time)
+        .def_readonly("open_time", &ACStatus::open_time)
+        .def_readonly("auto_closing_time", &ACStatus::auto_closing_time)
+        .def_readonly("is_delay", &ACStatus::is_delay)
+        .def_readonly("online_state", &ACStatus::online_state)
+        .def("to_dict", &ac_status_to_dict)
+        .def("__getitem__", &dict_item<ACStatus, ac_status_to_dict>)
+        .def("__repr__", [](const ACStatus& s) { return "<ACStatus " + s.to_string() + ">"; });
+
+    py::class_<DeviceListView>(m, "DeviceList")
+        .def("__len__", [](const DeviceListView& v) { return v.devices->size(); })
+        .def("__getitem__", &DeviceListView::at, py::return_value_policy::reference_internal)
+        .def("__iter__", [](const DeviceListView& v) {
+            return py::make_iterator(v.devices->begin(), v.devices->end());
+        }, py::keep_alive<0, 1>())
+        .def("to_list", [](const DeviceListView& v) {
+            py::list result;
+            for (const auto& device : *v.devices) {
+                result.append(device_to_dict(device));
+            }
+            return result;
+        })
+        .def("__repr__", [](const DeviceListView& v) {
+            return "<DeviceList of " + std::to_string(v.devices->size()) + " devices>";
+        });
     
     // Enums
     py::enum_<ACMode>(m, "ACMode")
@@ -86,30 +308,107 @@ PYBIND11_MODULE(_core, m) {
         .value("POWER_ON", ACPower::POWER_ON)
         .export_values();
     
-    // E7SwitcherClient class
+    // E7SwitcherClient class. Calls block on the network for up to the receive
+    // timeout, so the GIL is released around the C++ work and taken back only
+    // to build the result objects; the client serializes concurrent calls itself.
     py::class_<E7SwitcherClient>(m, "E7SwitcherClient")
-        .def(py::init<const std::string&, const std::string&>(),
-             py::arg("account"), py::arg("password"))
+        .def(py::init([](const std::string& account, const std::string& password,
+                         const std::string& host, int port) {
+                 ConnectionOptions options;
+                 options.host = host;
+                 options.port = port;
+                 py::gil_scoped_release release;
+                 return std::make_unique<E7SwitcherClient>(account, password, std::move(options));
+             }),
+             py::arg("account"), py::arg("password"),
+             py::arg("host") = std::string(IP_HUB), py::arg("port") = PORT_HUB)
         .def("list_devices", [](E7SwitcherClient& self) {
-            const std::vector<Device>& devices = self.list_devices();
-            py::list result;
-            for (const auto& device : devices) {
-                result.append(device_to_dict(device));
+            const std::vector<Device>* devices;
+            {
+                py::gil_scoped_release release;
+                devices = &self.list_devices();
             }
-            return result;
-        })
+            return DeviceListView{devices};
+        }, py::keep_alive<0, 1>())
         .def("control_switch", &E7SwitcherClient::control_switch,
-             py::arg("device_name"), py::arg("action"), py::arg("operation_time") = 0)
+             py::arg("device_name"), py::arg("action"), py::arg("operation_time") = 0,
+             py::call_guard<py::gil_scoped_release>())
         .def("control_ac", &E7SwitcherClient::control_ac,
              py::arg("device_name"), py::arg("action"), py::arg("mode"),
              py::arg("temperature"), py::arg("fan_speed"), py::arg("swing"),
-             py::arg("operation_time") = 0)
-        .def("get_switch_status", [](E7SwitcherClient& self, const std::string& device_name) {
-            SwitchStatus status = self.get_switch_status(device_name);
-            return switch_status_to_dict(status);
-        }, py::arg("device_name"))
-        .def("get_ac_status", [](E7SwitcherClient& self, const std::string& device_name) {
-            ACStatus status = self.get_ac_status(device_name);
-            return ac_status_to_dict(status);
-        }, py::arg("device_name"));
+             py::arg("operation_time") = 0,
+             py::call_guard<py::gil_scoped_release>())
+        .def("get_switch_status", &E7SwitcherClient::get_switch_status, py::arg("device_name"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("get_ac_status", &E7SwitcherClient::get_ac_status, py::arg("device_name"),
+             py::call_guard<py::gil_scoped_release>())
+        .def("metrics", [](const E7SwitcherClient& self) {
+            return metrics_to_dict(self.metrics());
+        })
+        // Waits for any call in flight, so the GIL is released here too
+        .def("reset_metrics", &E7SwitcherClient::reset_metrics,
+             py::call_guard<py::gil_scoped_release>());
+
+    // Background session for AsyncE7SwitcherClient: each method queues the call
+    // on the worker thread and returns at once; done(result, error) is called
+    // later on that thread, with the GIL held
+    py::class_<PyClientWorker>(m, "ClientWorker")
+        .def(py::init([](const std::string& account, const std::string& password,
+                         const std::string& host, int port) {
+                 ConnectionOptions options;
+                 options.host = host;
+                 options.port = port;
+                 auto result = std::make_unique<PyClientWorker>();
+                 result->worker = std::make_unique<ClientWorker>(account, password, std::move(options));
+                 return result;
+             }),
+             py::arg("account"), py::arg("password"),
+             py::arg("host") = std::string(IP_HUB), py::arg("port") = PORT_HUB)
+        // Reports the connection (login) result once every job queued before it has run
+        .def("ready", [](PyClientWorker& self, py::function done) {
+            submit_call(self.get(), std::move(done), [](E7SwitcherClient&) {}, nullptr);
+        }, py::arg("done"))
+        .def("list_devices", [](PyClientWorker& self, py::function done) {
+            submit_call(self.get(), std::move(done),
+                        [](E7SwitcherClient& c) { return c.list_devices(); },
+                        // copies: the worker's client may be gone before Python is done with them
+                        [](const std::vector<Device>& devices) { return py::cast(devices); });
+        }, py::arg("done"))
+        .def("control_switch", [](PyClientWorker& self, const std::string& device_name,
+                                  const std::string& action, int operation_time, py::function done) {
+            submit_call(self.get(), std::move(done), [=](E7SwitcherClient& c) {
+                c.control_switch(device_name, action, operation_time);
+            }, nullptr);
+        }, py::arg("device_name"), py::arg("action"), py::arg("operation_time"), py::arg("done"))
+        .def("control_ac", [](PyClientWorker& self, const std::string& device_name, const std::string& action,
+                              ACMode mode, int temperature, ACFanSpeed fan_speed, ACSwing swing,
+                              int operation_time, py::function done) {
+            submit_call(self.get(), std::move(done), [=](E7SwitcherClient& c) {
+                c.control_ac(device_name, action, mode, temperature, fan_speed, swing, operation_time);
+            }, nullptr);
+        }, py::arg("device_name"), py::arg("action"), py::arg("mode"), py::arg("temperature"),
+           py::arg("fan_speed"), py::arg("swing"), py::arg("operation_time"), py::arg("done"))
+        .def("get_switch_status", [](PyClientWorker& self, const std::string& device_name, py::function done) {
+            submit_call(self.get(), std::move(done),
+                        [=](E7SwitcherClient& c) { return c.get_switch_status(device_name); },
+                        [](const SwitchStatus& status) { return py::cast(status); });
+        }, py::arg("device_name"), py::arg("done"))
+        .def("get_ac_status", [](PyClientWorker& self, const std::string& device_name, py::function done) {
+            submit_call(self.get(), std::move(done),
+                        [=](E7SwitcherClient& c) { return c.get_ac_status(device_name); },
+                        [](const ACStatus& status) { return py::cast(status); });
+        }, py::arg("device_name"), py::arg("done"))
+        .def("reset_metrics", [](PyClientWorker& self, py::function done) {
+            submit_call(self.get(), std::move(done), [](E7SwitcherClient& c) { c.reset_metrics(); }, nullptr);
+        }, py::arg("done"))
+        .def("metrics", [](PyClientWorker& self, py::function done) {
+            submit_call(self.get(), std::move(done),
+                        [](E7SwitcherClient& c) { return c.metrics(); },
+                        [](const MetricsSnapshot& metrics) { return metrics_to_dict(metrics); });
+        }, py::arg("done"))
+        .def("pending", [](PyClientWorker& self) { return self.get().pending(); })
+        // Fail queued jobs and let the running one finish; returns at once
+        .def("stop", [](PyClientWorker& self) { self.get().stop(); })
+        // stop() and wait for the worker thread
+        .def("close", &PyClientWorker::close);
 }
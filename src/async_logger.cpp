@@ -0,0 +1,475 @@
+#include "e7-switcher/async_logger.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+namespace e7_switcher {
+
+namespace {
+
+// How long the idle writer sleeps before looking at the ring again. Producers
+// wake it sooner; this only bounds the delay if such a wake-up is missed.
+constexpr auto IDLE_WAIT = std::chrono::milliseconds(20);
+
+size_t ring_size(size_t capacity) {
+    size_t n = 2;
+    while (n < capacity) n <<= 1;
+    return n;
+}
+
+// --- Deferred printf ----------------------------------------------------------
+//
+// capture() walks the format on the calling thread and takes each argument
+// off the va_list with its real type; render() walks it again on the writer
+// thread and formats one conversion at a time. Integers are widened to
+// (unsigned) long long and re-emitted with an "ll" modifier.
+
+// One captured argument; strings are copied into the slot text
+union LogArg {
+    long long i;
+    unsigned long long u;
+    double d;
+    const void* p;
+    size_t offset; // of the string within the slot text
+};
+
+enum class ArgKind { NONE, SIGNED, UNSIGNED, CHAR, DOUBLE, STRING, POINTER, UNSUPPORTED };
+enum class Length { NONE, HH, H, L, LL, J, Z, T, LONG_DOUBLE };
+
+struct Spec {
+    const char* begin;        // at '%'
+    const char* length_begin; // length modifier, or the conversion if none
+    const char* end;          // past the conversion
+    bool star_width;
+    bool star_precision;
+    Length length;
+    ArgKind kind;
+};
+
+Spec parse_spec(const char* percent) {
+    Spec spec{percent, nullptr, nullptr, false, false, Length::NONE, ArgKind::UNSUPPORTED};
+    const char* p = percent + 1;
+    while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0') ++p;
+    if (*p == '*') {
+        spec.star_width = true;
+        ++p;
+    } else {
+        while (*p >= '0' && *p <= '9') ++p;
+    }
+    if (*p == '.') {
+        ++p;
+        if (*p == '*') {
+            spec.star_precision = true;
+            ++p;
+        } else {
+            while (*p >= '0' && *p <= '9') ++p;
+        }
+    }
+
+    spec.length_begin = p;
+    switch (*p) {
+        case 'h': spec.length = p[1] == 'h' ? Length::HH : Length::H; p += p[1] == 'h' ? 2 : 1; break;
+        case 'l': spec.length = p[1] == 'l' ? Length::LL : Length::L; p += p[1] == 'l' ? 2 : 1; break;
+        case 'j': spec.length = Length::J; ++p; break;
+        case 'z': spec.length = Length::Z; ++p; break;
+        case 't': spec.length = Length::T; ++p; break;
+        case 'L': spec.length = Length::LONG_DOUBLE; ++p; break;
+        default: break;
+    }
+
+    char conversion = *p;
+    spec.end = conversion ? p + 1 : p;
+    bool plain = spec.length == Length::NONE;
+    switch (conversion) {
+        case '%': spec.kind = ArgKind::NONE; break;
+        case 'd': case 'i': spec.kind = ArgKind::SIGNED; break;
+        case 'u': case 'o': case 'x': case 'X': spec.kind = ArgKind::UNSIGNED; break;
+        case 'c': spec.kind = plain ? ArgKind::CHAR : ArgKind::UNSUPPORTED; break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            spec.kind = spec.length == Length::LONG_DOUBLE ? ArgKind::UNSUPPORTED : ArgKind::DOUBLE; break;
+        case 's': spec.kind = plain ? ArgKind::STRING : ArgKind::UNSUPPORTED; break;
+        case 'p': spec.kind = ArgKind::POINTER; break;
+        default: spec.kind = ArgKind::UNSUPPORTED; break; // %n, %ls, %lc, a cut-off spec
+    }
+    if ((spec.kind == ArgKind::SIGNED || spec.kind == ArgKind::UNSIGNED) && spec.length == Length::LONG_DOUBLE) {
+        spec.kind = ArgKind::UNSUPPORTED;
+    }
+    return spec;
+}
+
+long long fetch_signed(va_list& args, Length length) {
+    switch (length) {
+        case Length::HH: return static_cast<signed char>(va_arg(args, int));
+        case Length::H:  return static_cast<short>(va_arg(args, int));
+        case Length::L:  return va_arg(args, long);
+        case Length::LL: return va_arg(args, long long);
+        case Length::J:  return va_arg(args, intmax_t);
+        case Length::Z:  return static_cast<std::make_signed<size_t>::type>(va_arg(args, size_t));
+        case Length::T:  return va_arg(args, ptrdiff_t);
+        default:         return va_arg(args, int);
+    }
+}
+
+unsigned long long fetch_unsigned(va_list& args, Length length) {
+    switch (length) {
+        case Length::HH: return static_cast<unsigned char>(va_arg(args, unsigned int));
+        case Length::H:  return static_cast<unsigned short>(va_arg(args, unsigned int));
+        case Length::L:  return va_arg(args, unsigned long);
+        case Length::LL: return va_arg(args, unsigned long long);
+        case Length::J:  return va_arg(args, uintmax_t);
+        case Length::Z:  return va_arg(args, size_t);
+        case Length::T:  return static_cast<std::make_unsigned<ptrdiff_t>::type>(va_arg(args, ptrdiff_t));
+        default:         return va_arg(args, unsigned int);
+    }
+}
+
+// Copies the format and its arguments into text/out; false when the message
+// has to be formatted on the calling thread instead
+bool capture(const char* format, va_list& args, char* text, LogArg* out, uint8_t& count) {
+    size_t used = std::strlen(format) + 1;
+    if (used > AsyncLogger::MESSAGE_SIZE) {
+        return false;
+    }
+    std::memcpy(text, format, used);
+
+    count = 0;
+    for (const char* p = std::strchr(format, '%'); p; p = std::strchr(p, '%')) {
+        Spec spec = parse_spec(p);
+        p = spec.end;
+        if (spec.kind == ArgKind::NONE) {
+            continue;
+        }
+        size_t needed = 1 + spec.star_width + spec.star_precision;
+        if (spec.kind == ArgKind::UNSUPPORTED || count + needed > AsyncLogger::MAX_ARGS) {
+            return false;
+        }
+        if (spec.star_width) out[count++].i = va_arg(args, int);
+        if (spec.star_precision) out[count++].i = va_arg(args, int);
+
+        LogArg& arg = out[count++];
+        switch (spec.kind) {
+            case ArgKind::SIGNED:   arg.i = fetch_signed(args, spec.length); break;
+            case ArgKind::UNSIGNED: arg.u = fetch_unsigned(args, spec.length); break;
+            case ArgKind::CHAR:     arg.i = va_arg(args, int); break;
+            case ArgKind::DOUBLE:   arg.d = va_arg(args, double); break;
+            case ArgKind::POINTER:  arg.p = va_arg(args, void*); break;
+            case ArgKind::STRING: {
+                const char* s = va_arg(args, const char*);
+                if (!s) s = "(null)";
+                size_t len = std::strlen(s) + 1;
+                if (used + len > AsyncLogger::MESSAGE_SIZE) {
+                    return false;
+                }
+                std::memcpy(text + used, s, len);
+                arg.offset = used;
+                used += len;
+                break;
+            }
+            default: return false;
+        }
+    }
+    return true;
+}
+
+// Output buffer that silently truncates like snprintf
+struct LineBuffer {
+    char data[AsyncLogger::MESSAGE_SIZE];
+    size_t len = 0;
+
+    size_t room() const { return sizeof(data) - len; }
+
+    void append(const char* s, size_t n) {
+        size_t fit = n < room() - 1 ? n : room() - 1;
+        std::memcpy(data + len, s, fit);
+        len += fit;
+        data[len] = '\0';
+    }
+
+    template <typename T>
+    void appendf(const char* spec, T value) {
+        int n = std::snprintf(data + len, room(), spec, value);
+        if (n > 0) len += static_cast<size_t>(n) < room() ? static_cast<size_t>(n) : room() - 1;
+    }
+};
+
+// Formats a captured message: text holds the format, then any strings
+void render(const char* text, const LogArg* args, LineBuffer& line) {
+    line.data[0] = '\0';
+    size_t next = 0;
+    const char* p = text;
+    for (const char* percent = std::strchr(p, '%'); percent; percent = std::strchr(p, '%')) {
+        line.append(p, static_cast<size_t>(percent - p));
+        Spec spec = parse_spec(percent);
+        p = spec.end;
+        if (spec.kind == ArgKind::NONE) {
+            line.append("%", 1);
+            continue;
+        }
+
+        // Rebuild the spec with '*' filled in and the integer length widened
+        char fmt[48];
+        size_t n = 0;
+        for (const char* c = spec.begin; c < spec.length_begin; ++c) {
+            if (*c != '*') {
+                fmt[n++] = *c;
+                continue;
+            }
+            int value = static_cast<int>(args[next++].i);
+            if (c[-1] == '.' && value < 0) {
+                --n; // negative precision: as if none was given
+                continue;
+            }
+            n += static_cast<size_t>(std::snprintf(fmt + n, sizeof(fmt) - n, "%d", value));
+        }
+        if (spec.kind == ArgKind::SIGNED || spec.kind == ArgKind::UNSIGNED) {
+            fmt[n++] = 'l';
+            fmt[n++] = 'l';
+        }
+        fmt[n++] = spec.end[-1];
+        fmt[n] = '\0';
+
+        const LogArg& arg = args[next++];
+        switch (spec.kind) {
+            case ArgKind::SIGNED:   line.appendf(fmt, arg.i); break;
+            case ArgKind::UNSIGNED: line.appendf(fmt, arg.u); break;
+            case ArgKind::CHAR:     line.appendf(fmt, static_cast<int>(arg.i)); break;
+            case ArgKind::DOUBLE:   line.appendf(fmt, arg.d); break;
+            case ArgKind::POINTER:  line.appendf(fmt, arg.p); break;
+            case ArgKind::STRING:   line.appendf(fmt, text + arg.offset); break;
+            default: break;
+        }
+    }
+    line.append(p, std::strlen(p));
+}
+
+} // namespace
+
+struct AsyncLogger::Slot {
+    std::atomic<size_t> sequence;
+    LogLevel level;
+    bool deferred; // text holds the format and strings, args the other arguments
+    uint8_t arg_count;
+    LogArg args[MAX_ARGS];
+    char text[MESSAGE_SIZE];
+};
+
+AsyncLogger::AsyncLogger(std::unique_ptr<Logger> sink, size_t capacity, AsyncLogPolicy policy)
+    : sink_(std::move(sink)),
+      slots_(new Slot[ring_size(capacity)]),
+      mask_(ring_size(capacity) - 1),
+      policy_(policy),
+      debug_enabled_(false),
+      enqueue_pos_(0),
+      dequeue_pos_(0),
+      dropped_(0),
+      dropped_reported_(0),
+      writer_idle_(false),
+      stop_(false) {
+    for (size_t i = 0; i <= mask_; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    writer_ = std::thread(&AsyncLogger::run, this);
+}
+
+AsyncLogger::~AsyncLogger() {
+    stop_.store(true);
+    wake_.notify_one();
+    writer_.join();
+}
+
+// --- Producer side ------------------------------------------------------------
+
+// Bounded MPMC ring (Vyukov) used with a single consumer: a slot is free for
+// position pos when its sequence equals pos, and ready to read at pos + 1
+AsyncLogger::Slot* AsyncLogger::claim(size_t& pos) {
+    pos = enqueue_pos_.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot& slot = slots_[pos & mask_];
+        size_t seq = slot.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+        if (diff == 0) {
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                return &slot;
+            }
+        } else if (diff < 0) {
+            // full: the writer has not released this slot from the previous lap
+            if (policy_ == AsyncLogPolicy::DROP) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+            wait_for_space();
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        } else {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void AsyncLogger::publish(Slot* slot, size_t pos) {
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    if (writer_idle_.load(std::memory_order_relaxed)) {
+        wake_.notify_one();
+    }
+}
+
+void AsyncLogger::wait_for_space() {
+    wake_.notify_one();
+    std::unique_lock<std::mutex> lock(mutex_);
+    progress_.wait_for(lock, std::chrono::milliseconds(1));
+}
+
+void AsyncLogger::push(LogLevel level, const std::string& message) {
+    size_t pos;
+    Slot* slot = claim(pos);
+    if (!slot) {
+        return;
+    }
+    size_t len = message.size() < MESSAGE_SIZE - 1 ? message.size() : MESSAGE_SIZE - 1;
+    std::memcpy(slot->text, message.data(), len);
+    slot->text[len] = '\0';
+    slot->level = level;
+    slot->deferred = false;
+    publish(slot, pos);
+}
+
+void AsyncLogger::pushf(LogLevel level, const char* format, va_list args) {
+    size_t pos;
+    Slot* slot = claim(pos);
+    if (!slot) {
+        return;
+    }
+    va_list copy;
+    va_copy(copy, args);
+    slot->deferred = capture(format, copy, slot->text, slot->args, slot->arg_count);
+    va_end(copy);
+    if (!slot->deferred) {
+        vsnprintf(slot->text, MESSAGE_SIZE, format, args);
+    }
+    slot->level = level;
+    publish(slot, pos);
+}
+
+void AsyncLogger::debug(const std::string& message) {
+    if (debug_enabled_.load(std::memory_order_relaxed)) {
+        push(LogLevel::DEBUG, message);
+    }
+}
+
+void AsyncLogger::info(const std::string& message) {
+    push(LogLevel::INFO, message);
+}
+
+void AsyncLogger::warning(const std::string& message) {
+    push(LogLevel::WARNING, message);
+}
+
+void AsyncLogger::error(const std::string& message) {
+    push(LogLevel::ERROR, message);
+}
+
+void AsyncLogger::set_log_level(LogLevel level) {
+    debug_enabled_.store(level <= LogLevel::DEBUG, std::memory_order_relaxed);
+    sink_->set_log_level(level);
+}
+
+void AsyncLogger::debugf(const char* format, ...) {
+    if (debug_enabled_.load(std::memory_order_relaxed)) {
+        va_list args;
+        va_start(args, format);
+        pushf(LogLevel::DEBUG, format, args);
+        va_end(args);
+    }
+}
+
+void AsyncLogger::infof(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    pushf(LogLevel::INFO, format, args);
+    va_end(args);
+}
+
+void AsyncLogger::warningf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    pushf(LogLevel::WARNING, format, args);
+    va_end(args);
+}
+
+void AsyncLogger::errorf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    pushf(LogLevel::ERROR, format, args);
+    va_end(args);
+}
+
+void AsyncLogger::flush() {
+    size_t target = enqueue_pos_.load();
+    wake_.notify_one();
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (dequeue_pos_.load(std::memory_order_acquire) < target) {
+        progress_.wait_for(lock, IDLE_WAIT);
+    }
+}
+
+// --- Writer thread ------------------------------------------------------------
+
+void AsyncLogger::write(const Slot& slot) {
+    LineBuffer line;
+    const char* text = slot.text;
+    if (slot.deferred) {
+        render(slot.text, slot.args, line);
+        text = line.data;
+    }
+    switch (slot.level) {
+        case LogLevel::DEBUG:   sink_->debugf("%s", text); break;
+        case LogLevel::INFO:    sink_->infof("%s", text); break;
+        case LogLevel::WARNING: sink_->warningf("%s", text); break;
+        case LogLevel::ERROR:   sink_->errorf("%s", text); break;
+    }
+}
+
+// Writes every published message; returns whether there were any
+bool AsyncLogger::drain() {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    size_t start = pos;
+    for (;;) {
+        Slot& slot = slots_[pos & mask_];
+        if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+            break;
+        }
+        write(slot);
+        slot.sequence.store(pos + mask_ + 1, std::memory_order_release);
+        dequeue_pos_.store(++pos, std::memory_order_release);
+    }
+
+    size_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != dropped_reported_) {
+        sink_->warningf("%zu log messages dropped (ring full)", dropped - dropped_reported_);
+        dropped_reported_ = dropped;
+    }
+    return pos != start;
+}
+
+void AsyncLogger::run() {
+    for (;;) {
+        if (drain()) {
+            progress_.notify_all();
+            continue;
+        }
+        if (stop_.load()) {
+            break;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        writer_idle_.store(true);
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        if (slots_[pos & mask_].sequence.load(std::memory_order_acquire) != pos + 1 && !stop_.load()) {
+            wake_.wait_for(lock, IDLE_WAIT);
+        }
+        writer_idle_.store(false);
+    }
+    progress_.notify_all();
+}
+
+} // namespace e7_switcher
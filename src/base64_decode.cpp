@@ -1,60 +1,238 @@
 #include "e7-switcher/base64_decode.h"
+#include <cstdint>
 #include <string>
 #include <vector>
 
-static const std::string base64_chars =
-    "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-    "abcdefghijklmnopqrstuvwxyz"
-    "0123456789+/";
+// SIMD fast paths for long inputs: SSSE3 on x86 (checked at runtime, so the
+// library still runs on CPUs without it) and NEON on AArch64
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define E7_BASE64_SSSE3
+#include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#define E7_BASE64_NEON
+#include <arm_neon.h>
+#endif
 
-static inline bool is_base64(unsigned char c)
+namespace {
+
+constexpr unsigned char INVALID = 0xFF;
+
+struct DecodeTable {
+  unsigned char value[256];
+
+  constexpr DecodeTable() : value() {
+    for (int i = 0; i < 256; i++)
+      value[i] = INVALID;
+    for (int i = 0; i < 26; i++) {
+      value['A' + i] = static_cast<unsigned char>(i);
+      value['a' + i] = static_cast<unsigned char>(26 + i);
+    }
+    for (int i = 0; i < 10; i++)
+      value['0' + i] = static_cast<unsigned char>(52 + i);
+    value['+'] = 62;
+    value['/'] = 63;
+  }
+};
+
+constexpr DecodeTable decode_table;
+
+inline unsigned char lookup(char c)
 {
-  return (isalnum(c) || (c == '+') || (c == '/'));
+  return decode_table.value[static_cast<unsigned char>(c)];
 }
 
-std::vector<unsigned char> base64_decode(std::string const &encoded_string)
+size_t size_for_prefix(size_t n)
 {
-  int in_len = encoded_string.size();
-  int i = 0;
-  int j = 0;
-  int in_ = 0;
-  unsigned char char_array_4[4], char_array_3[3];
-  std::vector<unsigned char> ret;
-
-  while (in_len-- && (encoded_string[in_] != '=') && is_base64(encoded_string[in_]))
-  {
-    char_array_4[i++] = encoded_string[in_];
-    in_++;
-    if (i == 4)
-    {
-      for (i = 0; i < 4; i++)
-        char_array_4[i] = base64_chars.find(char_array_4[i]);
-
-      char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-      char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-      char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
-
-      for (i = 0; (i < 3); i++)
-        ret.push_back(char_array_3[i]);
-      i = 0;
-    }
+  size_t rem = n % 4;
+  return n / 4 * 3 + (rem > 1 ? rem - 1 : 0);
+}
+
+// Decodes n alphabet characters starting at in[i] with the table; returns bytes written
+size_t decode_scalar(const char* in, size_t i, size_t n, unsigned char* out)
+{
+  size_t o = 0;
+  for (; i + 4 <= n; i += 4) {
+    uint32_t v = (uint32_t(lookup(in[i])) << 18) | (uint32_t(lookup(in[i + 1])) << 12) |
+                 (uint32_t(lookup(in[i + 2])) << 6) | uint32_t(lookup(in[i + 3]));
+    out[o++] = static_cast<unsigned char>(v >> 16);
+    out[o++] = static_cast<unsigned char>(v >> 8);
+    out[o++] = static_cast<unsigned char>(v);
   }
 
-  if (i)
-  {
-    for (j = i; j < 4; j++)
-      char_array_4[j] = 0;
+  size_t rem = n - i;
+  if (rem >= 2) {
+    uint32_t v = (uint32_t(lookup(in[i])) << 18) | (uint32_t(lookup(in[i + 1])) << 12);
+    if (rem == 3)
+      v |= uint32_t(lookup(in[i + 2])) << 6;
+    out[o++] = static_cast<unsigned char>(v >> 16);
+    if (rem == 3)
+      out[o++] = static_cast<unsigned char>(v >> 8);
+  }
+  return o;
+}
+
+#ifdef E7_BASE64_SSSE3
 
-    for (j = 0; j < 4; j++)
-      char_array_4[j] = base64_chars.find(char_array_4[j]);
+// 16 characters -> 12 bytes per step (the store writes 16, so the caller keeps
+// at least 24 characters ahead). Input is known to be in the alphabet, so the
+// character-to-value mapping is a per-high-nibble offset, with '/' singled out.
+__attribute__((target("ssse3")))
+size_t decode_ssse3(const char* in, size_t n, unsigned char* out, size_t& consumed)
+{
+  const __m128i roll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m128i slash = _mm_set1_epi8('/');
+  const __m128i nibble = _mm_set1_epi8(0x0F);
+  const __m128i merge_pairs = _mm_set1_epi32(0x01400140);
+  const __m128i merge_quads = _mm_set1_epi32(0x00011000);
+  const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
 
-    char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
-    char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
-    char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+  size_t i = 0;
+  size_t o = 0;
+  for (; i + 24 <= n; i += 16, o += 12) {
+    __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    __m128i hi = _mm_and_si128(_mm_srli_epi32(chars, 4), nibble);
+    __m128i idx = _mm_add_epi8(hi, _mm_cmpeq_epi8(chars, slash));
+    __m128i values = _mm_add_epi8(chars, _mm_shuffle_epi8(roll, idx));
+    __m128i words = _mm_madd_epi16(_mm_maddubs_epi16(values, merge_pairs), merge_quads);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + o), _mm_shuffle_epi8(words, pack));
+  }
+  consumed = i;
+  return o;
+}
 
-    for (j = 0; (j < i - 1); j++)
-      ret.push_back(char_array_3[j]);
+// Number of leading characters in whole 16-character blocks that are all in
+// the alphabet (signed compares also reject bytes >= 0x80)
+__attribute__((target("ssse3")))
+size_t valid_blocks_ssse3(const char* in, size_t len)
+{
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+    __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('Z' + 1)));
+    __m128i lower = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('z' + 1)));
+    __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(c, _mm_set1_epi8('9' + 1)));
+    __m128i other = _mm_or_si128(_mm_cmpeq_epi8(c, _mm_set1_epi8('+')), _mm_cmpeq_epi8(c, _mm_set1_epi8('/')));
+    __m128i ok = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, other));
+    if (_mm_movemask_epi8(ok) != 0xFFFF)
+      break;
   }
+  return i;
+}
+
+bool have_ssse3()
+{
+  static const bool supported = __builtin_cpu_supports("ssse3");
+  return supported;
+}
 
+#endif
+
+#ifdef E7_BASE64_NEON
+
+uint8x16_t neon_values(uint8x16_t chars, uint8x16_t roll)
+{
+  uint8x16_t idx = vaddq_u8(vshrq_n_u8(chars, 4), vceqq_u8(chars, vdupq_n_u8('/')));
+  return vaddq_u8(chars, vqtbl1q_u8(roll, idx));
+}
+
+// Marks bytes of c within [lo, hi] in ok
+void mark_range(uint8x16_t c, uint8_t lo, uint8_t hi, uint8x16_t& ok)
+{
+  ok = vorrq_u8(ok, vandq_u8(vcgeq_u8(c, vdupq_n_u8(lo)), vcleq_u8(c, vdupq_n_u8(hi))));
+}
+
+// Number of leading characters in whole 16-character blocks that are all in the alphabet
+size_t valid_blocks_neon(const char* in, size_t len)
+{
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    uint8x16_t c = vld1q_u8(reinterpret_cast<const uint8_t*>(in + i));
+    uint8x16_t ok = vorrq_u8(vceqq_u8(c, vdupq_n_u8('+')), vceqq_u8(c, vdupq_n_u8('/')));
+    mark_range(c, 'A', 'Z', ok);
+    mark_range(c, 'a', 'z', ok);
+    mark_range(c, '0', '9', ok);
+    if (vminvq_u8(ok) != 0xFF)
+      break;
+  }
+  return i;
+}
+
+// 64 characters -> 48 bytes per step, de-interleaved by vld4/vst3
+size_t decode_neon(const char* in, size_t n, unsigned char* out, size_t& consumed)
+{
+  static const uint8_t roll_bytes[16] = {0, 16, 19, 4, 191, 191, 185, 185, 0, 0, 0, 0, 0, 0, 0, 0};
+  const uint8x16_t roll = vld1q_u8(roll_bytes);
+
+  size_t i = 0;
+  size_t o = 0;
+  for (; i + 64 <= n; i += 64, o += 48) {
+    uint8x16x4_t c = vld4q_u8(reinterpret_cast<const uint8_t*>(in + i));
+    uint8x16_t a = neon_values(c.val[0], roll);
+    uint8x16_t b = neon_values(c.val[1], roll);
+    uint8x16_t d2 = neon_values(c.val[2], roll);
+    uint8x16_t d3 = neon_values(c.val[3], roll);
+    uint8x16x3_t bytes;
+    bytes.val[0] = vorrq_u8(vshlq_n_u8(a, 2), vshrq_n_u8(b, 4));
+    bytes.val[1] = vorrq_u8(vshlq_n_u8(b, 4), vshrq_n_u8(d2, 2));
+    bytes.val[2] = vorrq_u8(vshlq_n_u8(d2, 6), d3);
+    vst3q_u8(out + o, bytes);
+  }
+  consumed = i;
+  return o;
+}
+
+#endif
+
+// Length of the leading run of alphabet characters ('=' is not one)
+size_t valid_prefix(const char* in, size_t len)
+{
+  size_t n = 0;
+#if defined(E7_BASE64_SSSE3)
+  if (len >= 16 && have_ssse3())
+    n = valid_blocks_ssse3(in, len);
+#elif defined(E7_BASE64_NEON)
+  n = valid_blocks_neon(in, len);
+#endif
+  while (n < len && lookup(in[n]) != INVALID)
+    n++;
+  return n;
+}
+
+// Decodes the first n characters, all known to be in the alphabet
+size_t decode_prefix(const char* in, size_t n, unsigned char* out)
+{
+  size_t i = 0;
+  size_t o = 0;
+#if defined(E7_BASE64_SSSE3)
+  if (n >= 24 && have_ssse3())
+    o = decode_ssse3(in, n, out, i);
+#elif defined(E7_BASE64_NEON)
+  o = decode_neon(in, n, out, i);
+#endif
+  return o + decode_scalar(in, i, n, out + o);
+}
+
+} // namespace
+
+size_t base64_decoded_size(const char* in, size_t len)
+{
+  return size_for_prefix(valid_prefix(in, len));
+}
+
+size_t base64_decode(const char* in, size_t len, unsigned char* out)
+{
+  return decode_prefix(in, valid_prefix(in, len), out);
+}
+
+std::vector<unsigned char> base64_decode(const char* in, size_t len)
+{
+  size_t n = valid_prefix(in, len);
+  std::vector<unsigned char> ret(size_for_prefix(n));
+  decode_prefix(in, n, ret.data());
   return ret;
 }
+
+std::vector<unsigned char> base64_decode(std::string const &encoded_string)
+{
+  return base64_decode(encoded_string.data(), encoded_string.size());
+}
@@ -0,0 +1,79 @@
+#include "e7-switcher/client_worker.h"
+#include "e7-switcher/logger.h"
+#include <stdexcept>
+
+namespace e7_switcher {
+
+ClientWorker::ClientWorker(std::string account, std::string password, ConnectionOptions options)
+    : thread_(&ClientWorker::run, this, std::move(account), std::move(password), std::move(options)) {}
+
+ClientWorker::~ClientWorker() {
+    close();
+}
+
+void ClientWorker::submit(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closing_) throw std::runtime_error("Client worker is closed");
+        jobs_.push_back(std::move(job));
+    }
+    wake_.notify_one();
+}
+
+void ClientWorker::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closing_ = true;
+    }
+    wake_.notify_one();
+}
+
+void ClientWorker::close() {
+    stop();
+    if (thread_.joinable()) thread_.join();
+}
+
+size_t ClientWorker::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return jobs_.size();
+}
+
+void ClientWorker::run(std::string account, std::string password, ConnectionOptions options) {
+    std::unique_ptr<E7SwitcherClient> client;
+    std::exception_ptr connect_error;
+    try {
+        client = std::make_unique<E7SwitcherClient>(account, password, std::move(options));
+    } catch (...) {
+        connect_error = std::current_exception();
+    }
+    const std::exception_ptr closed_error =
+        std::make_exception_ptr(std::runtime_error("Client worker is closed"));
+
+    while (true) {
+        Job job;
+        bool closing;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [this] { return closing_ || !jobs_.empty(); });
+            if (jobs_.empty()) break;  // closing, nothing left to fail
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+            closing = closing_;
+        }
+
+        // A throwing job must not take the worker (and every later job) down
+        try {
+            if (closing) {
+                job(nullptr, closed_error);
+            } else {
+                job(client.get(), connect_error);
+            }
+        } catch (const std::exception& e) {
+            E7_LOG_ERROR("Client worker job failed: %s", e.what());
+        } catch (...) {
+            E7_LOG_ERROR("Client worker job failed");
+        }
+    }
+}
+
+} // namespace e7_switcher
@@ -1,8 +1,16 @@
 #include "e7-switcher/compression.h"
 #include <zlib.h>
 #include "e7-switcher/logger.h"
+#include <algorithm>
+#include <cstring>
 #include <stdexcept>
 
+// decompress_data backend, chosen at configure time (E7_INFLATE_BACKEND in
+// CMake); InflateStream and compress_data always use zlib
+#if defined(E7_INFLATE_LIBDEFLATE)
+#include <libdeflate.h>
+#endif
+
 namespace e7_switcher {
 
 std::vector<uint8_t> compress_data(const std::vector<uint8_t>& data, int level) {
@@ -10,8 +18,6 @@ std::vector<uint8_t> compress_data(const std::vector<uint8_t>& data, int level)
         return {};
     }
 
-    auto& logger = Logger::instance();
-    
     // Ensure compression level is within valid range
     if (level < 0) level = 0;
     if (level > 9) level = 9;  // zlib uses 0-9 compression levels
@@ -31,55 +37,205 @@ std::vector<uint8_t> compress_data(const std::vector<uint8_t>& data, int level)
     );
     
     if (status != Z_OK) {
-        logger.errorf("Compression failed with status %d", status);
+        E7_LOG_ERROR("Compression failed with status %d", status);
         throw std::runtime_error("Compression failed");
     }
     
     // Resize the output vector to the actual compressed size
     compressed_data.resize(compressed_size);
-    logger.debugf("Compressed %zu bytes to %zu bytes (ratio: %.2f%%)", 
-                 data.size(), compressed_size, 
+    E7_LOG_DEBUG("Compressed %zu bytes to %zu bytes (ratio: %.2f%%)", 
+                 data.size(), static_cast<size_t>(compressed_size), 
                  (float)compressed_size / data.size() * 100.0f);
     
     return compressed_data;
 }
 
-std::vector<uint8_t> decompress_data(const std::vector<uint8_t>& compressed_data) {
-    auto src = compressed_data.data();
-    auto src_len = compressed_data.size();
-    if (!src || src_len == 0) {
+namespace {
+
+// Largest output we preallocate from ISIZE alone; deflate cannot expand
+// beyond ~1032:1, so anything larger than that means a bogus trailer
+constexpr size_t MAX_DEFLATE_RATIO = 1032;
+
+ByteSpan gzip_member(ByteSpan compressed_data, size_t offset) {
+    if (!compressed_data.data() || offset >= compressed_data.size()) {
         throw std::runtime_error("Invalid input data");
     }
-    z_stream strm{};
-    strm.next_in  = const_cast<Bytef*>(src);
-    strm.avail_in = static_cast<uInt>(src_len);
-
-    // 16 + 15 => accept gzip stream (GZIP header + max window)
-    // If you want auto zlib/gzip detection, use (32 + MAX_WBITS) instead.
-    int rc = inflateInit2(&strm, 16 + MAX_WBITS);
-    if (rc != Z_OK) {
+    return compressed_data.subspan(offset);
+}
+
+// ISIZE: last 4 bytes of a gzip member, uncompressed length mod 2^32 (LE)
+size_t gzip_isize(ByteSpan gz) {
+    if (gz.size() < 18) { // 10-byte header + empty deflate block + 8-byte trailer
+        return 0;
+    }
+    const uint8_t* p = gz.data() + gz.size() - 4;
+    size_t isize = static_cast<size_t>(p[0]) | (static_cast<size_t>(p[1]) << 8) |
+                   (static_cast<size_t>(p[2]) << 16) | (static_cast<size_t>(p[3]) << 24);
+    return isize <= gz.size() * MAX_DEFLATE_RATIO ? isize : 0;
+}
+
+// Initial output size when the trailer is unusable
+size_t initial_output_size(ByteSpan gz) {
+    size_t isize = gzip_isize(gz);
+    return isize > 0 ? isize : gz.size() * 4;
+}
+
+// gzip inflate state that is initialized once and reset for each new stream
+class GzipInflater {
+public:
+    GzipInflater() : strm_{}, ready_(false) {}
+    ~GzipInflater() {
+        if (ready_) {
+            inflateEnd(&strm_);
+        }
+    }
+
+    GzipInflater(const GzipInflater&) = delete;
+    GzipInflater& operator=(const GzipInflater&) = delete;
+
+    void start(ByteSpan gz) {
+        if (ready_) {
+            if (inflateReset(&strm_) != Z_OK) {
+                throw std::runtime_error("Decompression failed");
+            }
+        } else {
+            // 16 + 15 => accept gzip stream (GZIP header + max window)
+            // If you want auto zlib/gzip detection, use (32 + MAX_WBITS) instead.
+            if (inflateInit2(&strm_, 16 + MAX_WBITS) != Z_OK) {
+                throw std::runtime_error("Decompression failed");
+            }
+            ready_ = true;
+        }
+        strm_.next_in  = const_cast<uint8_t*>(gz.data());
+        strm_.avail_in = static_cast<uint32_t>(gz.size());
+        done_ = false;
+    }
+
+    // Inflate into out[0:n]; returns the number of bytes produced, 0 at end of stream
+    size_t read(uint8_t* out, size_t n) {
+        if (done_ || n == 0) {
+            return 0;
+        }
+        strm_.next_out  = out;
+        strm_.avail_out = static_cast<uint32_t>(n);
+
+        // Loop until some output is produced: a call may only consume header bytes
+        while (strm_.avail_out == n) {
+            int status = inflate(&strm_, Z_NO_FLUSH);
+            if (status == Z_STREAM_END) {
+                done_ = true;
+                break;
+            }
+            if (status != Z_OK) {
+                throw std::runtime_error("Decompression failed");
+            }
+        }
+        return n - strm_.avail_out;
+    }
+
+    bool done() const { return done_; }
+
+private:
+    z_stream strm_;
+    bool ready_;
+    bool done_ = false;
+};
+
+#if defined(E7_INFLATE_LIBDEFLATE)
+
+// The decompressor holds no per-stream state, so one per thread serves every call
+libdeflate_decompressor* thread_decompressor() {
+    struct Holder {
+        libdeflate_decompressor* d = libdeflate_alloc_decompressor();
+        ~Holder() { libdeflate_free_decompressor(d); }
+    };
+    static thread_local Holder holder;
+    if (!holder.d) {
         throw std::runtime_error("Decompression failed");
     }
+    return holder.d;
+}
+
+#endif
+
+} // namespace
 
-    std::string out;
-    std::vector<unsigned char> buf(64 * 1024);
+#if defined(E7_INFLATE_LIBDEFLATE)
 
-    int status = Z_OK;
-    while (status != Z_STREAM_END) {
-        strm.next_out  = buf.data();
-        strm.avail_out = static_cast<uInt>(buf.size());
+std::vector<uint8_t> decompress_data(ByteSpan compressed_data, size_t offset) {
+    ByteSpan gz = gzip_member(compressed_data, offset);
+    libdeflate_decompressor* d = thread_decompressor();
 
-        status = inflate(&strm, Z_NO_FLUSH);
-        if (status != Z_OK && status != Z_STREAM_END) {
-            inflateEnd(&strm);
+    // Whole member in one call; only retried if the ISIZE trailer was wrong
+    std::vector<uint8_t> out(initial_output_size(gz));
+    for (;;) {
+        size_t produced = 0;
+        libdeflate_result rc = libdeflate_gzip_decompress(
+            d, gz.data(), gz.size(), out.data(), out.size(), &produced);
+        if (rc == LIBDEFLATE_SUCCESS) {
+            out.resize(produced);
+            return out;
+        }
+        if (rc != LIBDEFLATE_INSUFFICIENT_SPACE) {
             throw std::runtime_error("Decompression failed");
         }
+        out.resize(out.size() * 2);
+    }
+}
+
+#else
+
+std::vector<uint8_t> decompress_data(ByteSpan compressed_data, size_t offset) {
+    ByteSpan gz = gzip_member(compressed_data, offset);
+
+#ifdef ESP_PLATFORM
+    // Not cached on ESP: the 32 KiB window would stay allocated for good
+    GzipInflater inflater;
+#else
+    static thread_local GzipInflater inflater;
+#endif
+    inflater.start(gz);
 
-        size_t produced = buf.size() - strm.avail_out;
-        out.append(reinterpret_cast<const char*>(buf.data()), produced);
+    std::vector<uint8_t> out(initial_output_size(gz));
+    size_t produced = 0;
+    while (!inflater.done()) {
+        if (produced == out.size()) {
+            out.resize(out.size() * 2);
+        }
+        produced += inflater.read(out.data() + produced, out.size() - produced);
     }
 
-    inflateEnd(&strm);
-    return std::vector<uint8_t>(out.begin(), out.end());
+    out.resize(produced);
+    return out;
+}
+
+#endif
+
+struct InflateStream::Impl {
+    GzipInflater inflater;
+};
+
+InflateStream::InflateStream(ByteSpan compressed_data, size_t offset)
+    : impl_(new Impl()), size_hint_(0), done_(false) {
+    ByteSpan gz = gzip_member(compressed_data, offset);
+    impl_->inflater.start(gz);
+    size_hint_ = gzip_isize(gz);
 }
+
+size_t InflateStream::read(uint8_t* out, size_t n) {
+    size_t produced = impl_->inflater.read(out, n);
+    done_ = impl_->inflater.done();
+    return produced;
+}
+
+InflateStream::~InflateStream() = default;
+
+const char* inflate_backend_name() {
+#if defined(E7_INFLATE_LIBDEFLATE)
+    return "libdeflate";
+#else
+    return "zlib";
+#endif
+}
+
 } // namespace e7_switcher
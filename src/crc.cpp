@@ -1,48 +1,91 @@
 #include "e7-switcher/crc.h"
+#include <array>
 #include <vector>
 
 namespace e7_switcher {
 
-uint16_t crc_hqx(const uint8_t *data, size_t len, uint16_t crc) {
-    while (len--) {
-        crc ^= (uint16_t)(*data++) << 8;
+namespace {
+
+constexpr size_t LEGAL_KEY_SIZE = 32;
+
+constexpr std::array<uint16_t, 256> make_crc_table() {
+    std::array<uint16_t, 256> table{};
+    for (int n = 0; n < 256; ++n) {
+        uint16_t crc = static_cast<uint16_t>(n << 8);
         for (int i = 0; i < 8; i++) {
             if (crc & 0x8000) {
-                crc = (crc << 1) ^ 0x1021;
+                crc = static_cast<uint16_t>((crc << 1) ^ 0x1021);
             } else {
-                crc <<= 1;
+                crc = static_cast<uint16_t>(crc << 1);
             }
         }
+        table[n] = crc;
     }
-    return crc;
+    return table;
 }
 
-std::vector<uint8_t> get_complete_legal_crc(const std::vector<uint8_t>& payload, const std::vector<uint8_t>& key) {
-    // 1) first CRC over payload
-    uint16_t crc_a = crc_hqx(payload.data(), payload.size(), 0x1021);
-
-    // 2) build the 34-byte block
-    std::vector<uint8_t> block(34, 0);
-    block[0] = crc_a & 0xFF;
-    block[1] = (crc_a >> 8) & 0xFF;
-
-    if (key.empty()) {
-        // block[2:34] are already 0
-    } else {
-        for (size_t i = 0; i < key.size() && i < 32; ++i) {
-            block[i + 2] = key[i];
+constexpr std::array<uint16_t, 256> CRC_TABLE = make_crc_table();
+
+constexpr uint16_t crc_step(uint16_t crc, uint8_t b) {
+    return static_cast<uint16_t>((crc << 8) ^ CRC_TABLE[((crc >> 8) ^ b) & 0xFF]);
+}
+
+// Contribution of a crc_a byte at position `pos` (0 or 1) of the 34-byte
+// second-stage block, starting from a zero CRC state.
+constexpr std::array<uint16_t, 256> make_second_stage_table(size_t pos) {
+    std::array<uint16_t, 256> table{};
+    for (int n = 0; n < 256; ++n) {
+        uint16_t crc = crc_step(0, static_cast<uint8_t>(n));
+        for (size_t i = pos + 1; i < 2 + LEGAL_KEY_SIZE; ++i) {
+            crc = crc_step(crc, 0);
         }
+        table[n] = crc;
     }
+    return table;
+}
 
-    // 3) second CRC over block
-    uint16_t crc_b = crc_hqx(block.data(), block.size(), 0x1021);
+constexpr std::array<uint16_t, 256> SECOND_STAGE_LO = make_second_stage_table(0);
+constexpr std::array<uint16_t, 256> SECOND_STAGE_HI = make_second_stage_table(1);
 
-    // 4) return 4 bytes: first crcA, then crcB (same endianness)
-    std::vector<uint8_t> out(4);
+} // namespace
+
+uint16_t crc_hqx(const uint8_t *data, size_t len, uint16_t crc) {
+    while (len--) {
+        crc = crc_step(crc, *data++);
+    }
+    return crc;
+}
+
+SessionCrc::SessionCrc() : SessionCrc(std::vector<uint8_t>{}) {}
+
+SessionCrc::SessionCrc(const std::vector<uint8_t>& key) {
+    // CRC of [0, 0, key[0:32] zero-padded]; crc_a's share is XORed in per frame
+    uint16_t crc = crc_step(crc_step(CRC_SEED, 0), 0);
+    for (size_t i = 0; i < LEGAL_KEY_SIZE; ++i) {
+        crc = crc_step(crc, i < key.size() ? key[i] : 0);
+    }
+    key_term_ = crc;
+}
+
+uint16_t SessionCrc::second_stage(uint16_t crc_a) const {
+    return key_term_ ^ SECOND_STAGE_LO[crc_a & 0xFF] ^ SECOND_STAGE_HI[(crc_a >> 8) & 0xFF];
+}
+
+void SessionCrc::write_tail(uint16_t crc_a, uint8_t* out) const {
+    uint16_t crc_b = second_stage(crc_a);
     out[0] = crc_a & 0xFF;
     out[1] = (crc_a >> 8) & 0xFF;
     out[2] = crc_b & 0xFF;
     out[3] = (crc_b >> 8) & 0xFF;
+}
+
+void SessionCrc::write_tail(const uint8_t* packet, size_t len, uint8_t* out) const {
+    write_tail(crc_hqx(packet, len, CRC_SEED), out);
+}
+
+std::vector<uint8_t> get_complete_legal_crc(const std::vector<uint8_t>& payload, const std::vector<uint8_t>& key) {
+    std::vector<uint8_t> out(4);
+    SessionCrc(key).write_tail(payload.data(), payload.size(), out.data());
     return out;
 }
 
@@ -1,128 +1,273 @@
 #include "e7-switcher/crypto.h"
+#include "e7-switcher/constants.h"
+#include <cstring>
 #include <stdexcept>
 
-#ifdef ESP_PLATFORM
-
 namespace e7_switcher {
 
-std::vector<uint8_t> decrypt_hex_ecb_pkcs7(const std::vector<uint8_t>& ciphertext, const std::string& key) {
-    mbedtls_aes_context aes;
-    std::vector<uint8_t> plaintext(ciphertext.size());
+namespace {
 
-    mbedtls_aes_init(&aes);
-    mbedtls_aes_setkey_dec(&aes, (const unsigned char*)key.c_str(), key.length() * 8);
+constexpr size_t BLOCK_SIZE = AesEcbCipher::BLOCK_SIZE;
 
-    for (size_t i = 0; i < ciphertext.size(); i += 16) {
-        mbedtls_aes_crypt_ecb(&aes, MBEDTLS_AES_DECRYPT, ciphertext.data() + i, plaintext.data() + i);
+void check_key_len(size_t key_len) {
+    if (key_len != 16 && key_len != 24 && key_len != 32) {
+        throw std::runtime_error("Invalid AES key length: " + std::to_string(key_len));
     }
+}
 
-    mbedtls_aes_free(&aes);
-
-    // PKCS7 padding removal
-    size_t padding = plaintext.back();
-    if (padding > 0 && padding <= 16) {
-        plaintext.resize(plaintext.size() - padding);
+void check_whole_blocks(size_t len) {
+    if (len % BLOCK_SIZE != 0) {
+        throw std::runtime_error("Ciphertext is not a whole number of AES blocks");
     }
+}
 
-    return plaintext;
+// Length handed back to callers after decryption (platform specific, below)
+size_t unpadded_len(const uint8_t* plaintext, size_t len);
+
+} // namespace
+
+AesEcbCipher::AesEcbCipher(const std::string& key)
+    : AesEcbCipher(reinterpret_cast<const uint8_t*>(key.data()), key.size()) {}
+
+AesEcbCipher::AesEcbCipher(const uint8_t* key, size_t key_len) {
+    check_key_len(key_len);
+    init(key, key_len);
 }
 
-std::vector<uint8_t> encrypt_to_hex_ecb_pkcs7(const std::vector<uint8_t>& plaintext, const std::string& key) {
-    mbedtls_aes_context aes;
-    std::vector<uint8_t> ciphertext;
-    
-    mbedtls_aes_init(&aes);
-    mbedtls_aes_setkey_enc(&aes, (const unsigned char*)key.c_str(), key.length() * 8);
+AesEcbCipher& protocol_cipher(ProtocolKey key) {
+    switch (key) {
+        case ProtocolKey::V2_50: {
+            static thread_local AesEcbCipher cipher{std::string(AES_KEY_2_50)};
+            return cipher;
+        }
+        case ProtocolKey::NATIVE: {
+            static thread_local AesEcbCipher cipher{std::string(AES_KEY_NATIVE)};
+            return cipher;
+        }
+        case ProtocolKey::PRIMARY: {
+            static thread_local AesEcbCipher cipher{std::string(AES_KEY_PRIMARY)};
+            return cipher;
+        }
+    }
+    throw std::invalid_argument("Unknown protocol key");
+}
 
-    // PKCS7 padding
-    size_t padding = 16 - (plaintext.size() % 16);
-    std::vector<uint8_t> padded_plaintext = plaintext;
-    for (size_t i = 0; i < padding; ++i) {
-        padded_plaintext.push_back(padding);
+size_t AesEcbCipher::encrypt(ByteSpan plaintext, MutableByteSpan out) {
+    size_t full = plaintext.size() - plaintext.size() % BLOCK_SIZE;
+    size_t rest = plaintext.size() - full;
+    if (out.size() < full + BLOCK_SIZE) {
+        throw std::out_of_range("Not enough room in buffer");
     }
 
-    ciphertext.resize(padded_plaintext.size());
+    // PKCS7: the partial tail (possibly empty) is padded to one extra block
+    uint8_t last[BLOCK_SIZE];
+    if (rest > 0) {
+        std::memcpy(last, plaintext.data() + full, rest);
+    }
+    std::memset(last + rest, static_cast<int>(BLOCK_SIZE - rest), BLOCK_SIZE - rest);
+
+    encrypt_blocks(plaintext.data(), out.data(), full);
+    encrypt_blocks(last, out.data() + full, BLOCK_SIZE);
+    return full + BLOCK_SIZE;
+}
 
-    for (size_t i = 0; i < padded_plaintext.size(); i += 16) {
-        mbedtls_aes_crypt_ecb(&aes, MBEDTLS_AES_ENCRYPT, padded_plaintext.data() + i, ciphertext.data() + i);
+size_t AesEcbCipher::encrypt_in_place(MutableByteSpan buf, size_t len) {
+    return encrypt(ByteSpan(buf.data(), len), buf);
+}
+
+size_t AesEcbCipher::decrypt(ByteSpan ciphertext, MutableByteSpan out) {
+    check_whole_blocks(ciphertext.size());
+    if (out.size() < ciphertext.size()) {
+        throw std::out_of_range("Not enough room in buffer");
     }
+    decrypt_blocks(ciphertext.data(), out.data(), ciphertext.size());
+    return unpadded_len(out.data(), ciphertext.size());
+}
 
-    mbedtls_aes_free(&aes);
+size_t AesEcbCipher::decrypt_in_place(MutableByteSpan buf) {
+    return decrypt(buf, buf);
+}
 
+std::vector<uint8_t> AesEcbCipher::encrypt(const std::vector<uint8_t>& plaintext) {
+    std::vector<uint8_t> ciphertext(padded_size(plaintext.size()));
+    encrypt(plaintext, ciphertext);
     return ciphertext;
 }
 
+std::vector<uint8_t> AesEcbCipher::decrypt(const std::vector<uint8_t>& ciphertext) {
+    std::vector<uint8_t> plaintext(ciphertext.size());
+    plaintext.resize(decrypt(ciphertext, plaintext));
+    return plaintext;
+}
+
+std::vector<uint8_t> decrypt_hex_ecb_pkcs7(const std::vector<uint8_t>& ciphertext, const std::string& key) {
+    return AesEcbCipher(key).decrypt(ciphertext);
+}
+
+std::vector<uint8_t> encrypt_to_hex_ecb_pkcs7(const std::vector<uint8_t>& plaintext, const std::string& key) {
+    return AesEcbCipher(key).encrypt(plaintext);
+}
+
 } // namespace e7_switcher
 
-#else // ESP_PLATFORM
+#ifdef ESP_PLATFORM
 
-#include <openssl/evp.h>
-#include <openssl/aes.h>
+// ESP-IDF routes mbedtls AES to the on-chip accelerator when
+// CONFIG_MBEDTLS_HARDWARE_AES is set (the default on ESP32 targets)
+#include "sdkconfig.h"
+#include <algorithm>
 
 namespace e7_switcher {
 
-std::vector<uint8_t> decrypt_hex_ecb_pkcs7(const std::vector<uint8_t>& ciphertext, const std::string& key) {
-    EVP_CIPHER_CTX *ctx;
-    int len;
-    int plaintext_len;
-    std::vector<uint8_t> plaintext(ciphertext.size());
+namespace {
 
-    if(!(ctx = EVP_CIPHER_CTX_new())) throw std::runtime_error("Failed to create new cipher context");
+// Blocks per accelerator call when batching decryption (stack buffer size)
+constexpr size_t BATCH_BLOCKS = 16;
 
-    auto key_len_fn = EVP_aes_128_ecb;
-    if (key.length() == 24) {
-        key_len_fn = EVP_aes_192_ecb;
+} // namespace
+
+void AesEcbCipher::init(const uint8_t* key, size_t key_len) {
+    mbedtls_aes_init(&enc_);
+    mbedtls_aes_init(&dec_);
+    if (mbedtls_aes_setkey_enc(&enc_, key, key_len * 8) != 0 ||
+        mbedtls_aes_setkey_dec(&dec_, key, key_len * 8) != 0) {
+        mbedtls_aes_free(&enc_);
+        mbedtls_aes_free(&dec_);
+        throw std::runtime_error("Failed to set AES key");
     }
-    else if (key.length() == 32) {
-        key_len_fn = EVP_aes_256_ecb;
+}
+
+AesEcbCipher::~AesEcbCipher() {
+    mbedtls_aes_free(&enc_);
+    mbedtls_aes_free(&dec_);
+}
+
+void AesEcbCipher::encrypt_blocks(const uint8_t* in, uint8_t* out, size_t len) {
+    check_whole_blocks(len);
+    // There is no multi-block ECB encrypt entry point, so this stays one
+    // accelerator call per block (key schedule and context are reused)
+    for (size_t i = 0; i < len; i += BLOCK_SIZE) {
+        mbedtls_aes_crypt_ecb(&enc_, MBEDTLS_AES_ENCRYPT, in + i, out + i);
     }
-    
-    if(1 != EVP_DecryptInit_ex(ctx, key_len_fn(), NULL, (const unsigned char*)key.c_str(), NULL)) throw std::runtime_error("Failed to initialize decryption");
+}
 
-    EVP_CIPHER_CTX_set_padding(ctx, 0);
+void AesEcbCipher::decrypt_blocks(const uint8_t* in, uint8_t* out, size_t len) {
+    check_whole_blocks(len);
+#if defined(CONFIG_MBEDTLS_HARDWARE_AES)
+    // Every accelerator call takes the hardware lock and reloads the key, so
+    // runs of blocks go through one CBC call instead. CBC decryption yields
+    // D(C[i]) ^ C[i-1]; with a zero IV and that XOR undone below it is ECB.
+    uint8_t chunk[BATCH_BLOCKS * BLOCK_SIZE];
+    for (size_t off = 0; off < len; off += sizeof(chunk)) {
+        size_t n = std::min(sizeof(chunk), len - off);
+        std::memcpy(chunk, in + off, n); // keep the ciphertext, out may alias in
+        uint8_t iv[BLOCK_SIZE] = {0};
+        if (mbedtls_aes_crypt_cbc(&dec_, MBEDTLS_AES_DECRYPT, n, iv, chunk, out + off) != 0) {
+            throw std::runtime_error("Failed to decrypt blocks");
+        }
+        for (size_t i = BLOCK_SIZE; i < n; ++i) {
+            out[off + i] ^= chunk[i - BLOCK_SIZE];
+        }
+    }
+#else
+    for (size_t i = 0; i < len; i += BLOCK_SIZE) {
+        mbedtls_aes_crypt_ecb(&dec_, MBEDTLS_AES_DECRYPT, in + i, out + i);
+    }
+#endif
+}
 
-    if(1 != EVP_DecryptUpdate(ctx, plaintext.data(), &len, ciphertext.data(), ciphertext.size())) throw std::runtime_error("Failed to decrypt update");
-    plaintext_len = len;
+namespace {
 
-    if(1 != EVP_DecryptFinal_ex(ctx, plaintext.data() + len, &len)) throw std::runtime_error("Failed to finalize decryption");
-    plaintext_len += len;
+// PKCS7 padding removal
+size_t unpadded_len(const uint8_t* plaintext, size_t len) {
+    if (len == 0) {
+        return 0;
+    }
+    size_t padding = plaintext[len - 1];
+    if (padding > 0 && padding <= BLOCK_SIZE) {
+        return len - padding;
+    }
+    return len;
+}
 
-    EVP_CIPHER_CTX_free(ctx);
+} // namespace
 
-    plaintext.resize(plaintext_len);
-    return plaintext;
+} // namespace e7_switcher
+
+#else // ESP_PLATFORM
+
+namespace e7_switcher {
+
+namespace {
+
+const EVP_CIPHER* ecb_cipher_for(size_t key_len) {
+    if (key_len == 24) {
+        return EVP_aes_192_ecb();
+    }
+    if (key_len == 32) {
+        return EVP_aes_256_ecb();
+    }
+    return EVP_aes_128_ecb();
 }
 
-std::vector<uint8_t> encrypt_to_hex_ecb_pkcs7(const std::vector<uint8_t>& plaintext, const std::string& key) {
-    EVP_CIPHER_CTX *ctx;
-    int len;
-    int ciphertext_len;
-    std::vector<uint8_t> ciphertext(plaintext.size() + AES_BLOCK_SIZE);
+} // namespace
 
-    if(!(ctx = EVP_CIPHER_CTX_new())) throw std::runtime_error("Failed to create new cipher context");
+void AesEcbCipher::init(const uint8_t* key, size_t key_len) {
+    enc_ = EVP_CIPHER_CTX_new();
+    dec_ = EVP_CIPHER_CTX_new();
+    if (!enc_ || !dec_) {
+        EVP_CIPHER_CTX_free(enc_);
+        EVP_CIPHER_CTX_free(dec_);
+        throw std::runtime_error("Failed to create new cipher context");
+    }
 
-    auto key_len_fn = EVP_aes_128_ecb;
-    if (key.length() == 24) {
-        key_len_fn = EVP_aes_192_ecb;
+    const EVP_CIPHER* cipher = ecb_cipher_for(key_len);
+    if (1 != EVP_EncryptInit_ex(enc_, cipher, NULL, key, NULL) ||
+        1 != EVP_DecryptInit_ex(dec_, cipher, NULL, key, NULL)) {
+        EVP_CIPHER_CTX_free(enc_);
+        EVP_CIPHER_CTX_free(dec_);
+        throw std::runtime_error("Failed to initialize cipher");
     }
-    else if (key.length() == 32) {
-        key_len_fn = EVP_aes_256_ecb;
+
+    // Padding is handled here, so the contexts only ever see whole blocks.
+    // ECB keeps no state between whole-block updates, which lets the same
+    // context serve every call without Final/re-init.
+    EVP_CIPHER_CTX_set_padding(enc_, 0);
+    EVP_CIPHER_CTX_set_padding(dec_, 0);
+}
+
+AesEcbCipher::~AesEcbCipher() {
+    EVP_CIPHER_CTX_free(enc_);
+    EVP_CIPHER_CTX_free(dec_);
+}
+
+void AesEcbCipher::encrypt_blocks(const uint8_t* in, uint8_t* out, size_t len) {
+    check_whole_blocks(len);
+    int out_len = 0;
+    if (1 != EVP_EncryptUpdate(enc_, out, &out_len, in, static_cast<int>(len)) ||
+        static_cast<size_t>(out_len) != len) {
+        throw std::runtime_error("Failed to encrypt update");
     }
-    
-    if(1 != EVP_EncryptInit_ex(ctx, key_len_fn(), NULL, (const unsigned char*)key.c_str(), NULL)) throw std::runtime_error("Failed to initialize encryption");
-    
-    if(1 != EVP_EncryptUpdate(ctx, ciphertext.data(), &len, plaintext.data(), plaintext.size())) throw std::runtime_error("Failed to encrypt update");
-    ciphertext_len = len;
+}
 
-    if(1 != EVP_EncryptFinal_ex(ctx, ciphertext.data() + len, &len)) throw std::runtime_error("Failed to finalize encryption");
-    ciphertext_len += len;
+void AesEcbCipher::decrypt_blocks(const uint8_t* in, uint8_t* out, size_t len) {
+    check_whole_blocks(len);
+    int out_len = 0;
+    if (1 != EVP_DecryptUpdate(dec_, out, &out_len, in, static_cast<int>(len)) ||
+        static_cast<size_t>(out_len) != len) {
+        throw std::runtime_error("Failed to decrypt update");
+    }
+}
 
-    EVP_CIPHER_CTX_free(ctx);
+namespace {
 
-    ciphertext.resize(ciphertext_len);
-    return ciphertext;
+// Padding is left in place, as the device password and login parsers expect
+size_t unpadded_len(const uint8_t*, size_t len) {
+    return len;
 }
 
+} // namespace
+
 } // namespace e7_switcher
 
 #endif // ESP_PLATFORM
@@ -1,7 +1,12 @@
 #include "e7-switcher/json_helpers.h"
 #include "e7-switcher/base64_decode.h"
+#include "e7-switcher/compression.h"
 #include <algorithm>
+#include <cstring>
+#include <memory>
 #include <stdexcept>
+#include <string>
+#include <utility>
 
 #if defined(ARDUINO) || defined(ESP_PLATFORM) || defined(ESP32) || defined(ESP8266)
 #define E7_PLATFORM_ESP 1
@@ -9,83 +14,548 @@
 #else
 #define E7_PLATFORM_DESKTOP 1
 #include <nlohmann/json.hpp>
+#include <istream>
+#include <streambuf>
 #include "e7-switcher/oge_ir_device_code.h"
+#include "e7-switcher/json_backends.h"
 using json = nlohmann::json;
 #endif
 
 namespace e7_switcher {
 
+namespace {
+
+// Byte sources for BasicJsonScanner: peek() returns the next byte, or -1 at
+// the end of the text, and next() consumes it
+
+// JSON text already in memory
+class SpanSource {
+public:
+    SpanSource(const char* begin, const char* end) : p_(begin), end_(end) {}
+
+    const char* pos() const { return p_; }
+    int peek() const { return p_ < end_ ? static_cast<unsigned char>(*p_) : -1; }
+    void next() { ++p_; }
+
+private:
+    const char* p_;
+    const char* end_;
+};
+
+// JSON text as it comes out of an InflateStream, buffered
+class InflateReader {
+public:
+    explicit InflateReader(InflateStream& stream) : stream_(stream), pos_(0), len_(0) {}
+
+    int peek() {
+        if (pos_ == len_ && !fill()) {
+            return -1;
+        }
+        return buf_[pos_];
+    }
+
+    void next() { ++pos_; }
+
+private:
+    bool fill() {
+        len_ = stream_.read(buf_, sizeof(buf_));
+        pos_ = 0;
+        return len_ > 0;
+    }
+
+    InflateStream& stream_;
+    uint8_t buf_[256];
+    size_t pos_;
+    size_t len_;
+};
+
+/**
+ * Minimal forward scanner over raw JSON text. It walks a top-level object
+ * and finds value extents, so ArduinoJson only ever holds one small
+ * element at a time instead of the whole payload's document, and IR key
+ * lists can be indexed without decoding their entries.
+ *
+ * Over a SpanSource, values can be referred to in place through pos();
+ * over a stream they are skipped, or copied out when asked for.
+ */
+template <typename Source>
+class BasicJsonScanner {
+public:
+    template <typename... Args>
+    explicit BasicJsonScanner(Args&&... args) : src_(std::forward<Args>(args)...) {}
+
+    // In-memory sources only
+    const char* pos() const { return src_.pos(); }
+
+    // Skip whitespace; if the next character is c, consume it
+    bool consume(char c) {
+        skip_ws();
+        if (src_.peek() == static_cast<unsigned char>(c)) {
+            src_.next();
+            return true;
+        }
+        return false;
+    }
+
+    // Read a string token, returning its raw (still escaped) contents in
+    // place; in-memory sources only
+    bool string(const char*& out, size_t& len) {
+        if (!consume('"')) {
+            return false;
+        }
+        const char* start = src_.pos();
+        if (!skip_string_body(nullptr)) {
+            return false;
+        }
+        out = start;
+        len = static_cast<size_t>(src_.pos() - 1 - start);
+        return true;
+    }
+
+    // Read a string token, copying its raw (still escaped) contents
+    bool string(std::string& out) {
+        out.clear();
+        if (!consume('"') || !skip_string_body(&out)) {
+            return false;
+        }
+        out.pop_back(); // closing quote
+        return true;
+    }
+
+    // Skip one value of any type; if out is given, its raw text is copied there
+    bool skip_value(std::string* out = nullptr) {
+        if (out) out->clear();
+        skip_ws();
+        int c = src_.peek();
+        if (c < 0) {
+            return false;
+        }
+        if (c == '"') {
+            take(out);
+            return skip_string_body(out);
+        }
+        if (c == '{' || c == '[') {
+            int depth = 0;
+            while ((c = take(out)) >= 0) {
+                if (c == '"') {
+                    if (!skip_string_body(out)) return false;
+                } else if (c == '{' || c == '[') {
+                    ++depth;
+                } else if (c == '}' || c == ']') {
+                    if (--depth == 0) return true;
+                }
+            }
+            return false;
+        }
+        // number / true / false / null
+        size_t len = 0;
+        while ((c = src_.peek()) >= 0 && c != ',' && c != '}' && c != ']' && !is_ws(c)) {
+            take(out);
+            ++len;
+        }
+        return len > 0;
+    }
+
+private:
+    static bool is_ws(int c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+    void skip_ws() {
+        while (is_ws(src_.peek())) src_.next();
+    }
+
+    // Consume one byte, copying it to out if given; -1 at the end
+    int take(std::string* out) {
+        int c = src_.peek();
+        if (c >= 0) {
+            src_.next();
+            if (out) out->push_back(static_cast<char>(c));
+        }
+        return c;
+    }
+
+    // Just past the opening quote; consumes through the closing one
+    bool skip_string_body(std::string* out) {
+        int c;
+        while ((c = take(out)) >= 0) {
+            if (c == '\\') {
+                if (take(out) < 0) return false;
+            } else if (c == '"') {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Source src_;
+};
+
+using JsonScanner = BasicJsonScanner<SpanSource>;
+
+bool key_equals(const char* key, size_t len, const char* expected) {
+    return std::strlen(expected) == len && std::memcmp(key, expected, len) == 0;
+}
+
+} // namespace
+
 #ifdef E7_PLATFORM_ESP
 // ESP32 implementation using ArduinoJson
 
-bool extract_device_list(const std::string& json_str, std::vector<Device>& devices) {
-    JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, json_str);
-    
-    if (error) {
+namespace {
+
+Device device_from_json(JsonObject item) {
+    Device dev;
+    dev.name     = item["DeviceName"].as<std::string>();
+    dev.ssid     = item["APSSID"].as<std::string>();
+    dev.mac      = item["DMAC"].as<std::string>();
+    dev.type     = item["DeviceType"].as<std::string>();
+    dev.firmware = item["FirmwareMark"].as<std::string>() + " " + item["FirmwareVersion"].as<std::string>();
+    dev.online   = item["OnlineStatus"].as<int>() == 1;
+    dev.line_no  = item["LineNo"].as<int>();
+    dev.line_type= item["LineType"].as<int>();
+    dev.did      = item["DID"].as<int>();
+    dev.visit_pwd= item["VisitPwd"].as<std::string>();
+    dev.work_status_bytes = base64_decode(item["WorkStatus"].as<std::string>());
+    return dev;
+}
+
+} // namespace
+
+bool extract_device_list(ByteSpan json_bytes, std::vector<Device>& devices) {
+    JsonScanner scanner(reinterpret_cast<const char*>(json_bytes.begin()),
+                        reinterpret_cast<const char*>(json_bytes.end()));
+    if (!scanner.consume('{')) {
         return false;
     }
-    
-    if (!doc["DevList"].is<JsonArray>()) {
-        return false;
+
+    // Only the fields we use are kept in each element's document
+    JsonDocument filter;
+    for (const char* field : {"DeviceName", "APSSID", "DMAC", "DeviceType", "FirmwareMark",
+                              "FirmwareVersion", "OnlineStatus", "LineNo", "LineType", "DID",
+                              "VisitPwd", "WorkStatus"}) {
+        filter[field] = true;
     }
-    
-    JsonArray dev_list = doc["DevList"].as<JsonArray>();
+
+    bool found = false;
     devices.clear();
-    
-    for (JsonObject item : dev_list) {
-        Device dev;
-        dev.name     = item["DeviceName"].as<std::string>();
-        dev.ssid     = item["APSSID"].as<std::string>();
-        dev.mac      = item["DMAC"].as<std::string>();
-        dev.type     = item["DeviceType"].as<std::string>();
-        dev.firmware = item["FirmwareMark"].as<std::string>() + " " + item["FirmwareVersion"].as<std::string>();
-        dev.online   = item["OnlineStatus"].as<int>() == 1;
-        dev.line_no  = item["LineNo"].as<int>();
-        dev.line_type= item["LineType"].as<int>();
-        dev.did      = item["DID"].as<int>();
-        dev.visit_pwd= item["VisitPwd"].as<std::string>();
-        auto work_status_b64 = item["WorkStatus"].as<std::string>();
-        dev.work_status_bytes = base64_decode(work_status_b64);
-        devices.push_back(dev);
+    while (!scanner.consume('}')) {
+        const char* key;
+        size_t key_len;
+        if (!scanner.string(key, key_len) || !scanner.consume(':')) {
+            return false;
+        }
+
+        if (!key_equals(key, key_len, "DevList")) {
+            if (!scanner.skip_value()) return false;
+        } else {
+            if (!scanner.consume('[')) {
+                return false;
+            }
+            found = true;
+            while (!scanner.consume(']')) {
+                const char* start = scanner.pos();
+                if (!scanner.skip_value()) {
+                    return false;
+                }
+                JsonDocument doc;
+                DeserializationError error = deserializeJson(
+                    doc, start, static_cast<size_t>(scanner.pos() - start),
+                    DeserializationOption::Filter(filter));
+                if (error) {
+                    return false;
+                }
+                devices.push_back(device_from_json(doc.as<JsonObject>()));
+                scanner.consume(',');
+            }
+        }
+        scanner.consume(',');
     }
-    
-    return true;
+
+    return found;
+}
+
+bool extract_device_list(const std::string& json_str, std::vector<Device>& devices) {
+    return extract_device_list(
+        ByteSpan(reinterpret_cast<const uint8_t*>(json_str.data()), json_str.size()), devices);
 }
 
 #else
 // Linux/Mac implementation using nlohmann/json
 
-bool extract_device_list(const std::string& json_str, std::vector<Device>& devices) {
-    try {
-        json j = json::parse(json_str);
-        
-        if (!j.contains("DevList")) {
+namespace {
+
+// Device fields we keep; everything else in a DevList entry is skipped
+enum class DeviceField {
+    NONE,
+    NAME,
+    SSID,
+    MAC,
+    TYPE,
+    FIRMWARE_MARK,
+    FIRMWARE_VERSION,
+    ONLINE_STATUS,
+    LINE_NO,
+    LINE_TYPE,
+    DID,
+    VISIT_PWD,
+    WORK_STATUS
+};
+
+DeviceField device_field(const std::string& key) {
+    static const std::pair<const char*, DeviceField> fields[] = {
+        {"DeviceName", DeviceField::NAME},
+        {"APSSID", DeviceField::SSID},
+        {"DMAC", DeviceField::MAC},
+        {"DeviceType", DeviceField::TYPE},
+        {"FirmwareMark", DeviceField::FIRMWARE_MARK},
+        {"FirmwareVersion", DeviceField::FIRMWARE_VERSION},
+        {"OnlineStatus", DeviceField::ONLINE_STATUS},
+        {"LineNo", DeviceField::LINE_NO},
+        {"LineType", DeviceField::LINE_TYPE},
+        {"DID", DeviceField::DID},
+        {"VisitPwd", DeviceField::VISIT_PWD},
+        {"WorkStatus", DeviceField::WORK_STATUS},
+    };
+    for (const auto& f : fields) {
+        if (key == f.first) {
+            return f.second;
+        }
+    }
+    return DeviceField::NONE;
+}
+
+bool is_int_field(DeviceField f) {
+    return f == DeviceField::ONLINE_STATUS || f == DeviceField::LINE_NO ||
+           f == DeviceField::LINE_TYPE || f == DeviceField::DID;
+}
+
+// Bit for f in DeviceListSax's per-entry set of fields seen
+uint32_t field_bit(DeviceField f) {
+    return 1u << static_cast<unsigned>(f);
+}
+
+constexpr uint32_t ALL_DEVICE_FIELDS = ((1u << (static_cast<unsigned>(DeviceField::WORK_STATUS) + 1)) - 1) & ~1u;
+
+/**
+ * SAX handler filling Device records straight from the DevList payload.
+ * No DOM is built: only the current device and its firmware parts are held.
+ *
+ * Accepts what the DOM extraction accepted. DevList is iterated the way
+ * its range-for did: an array's elements or an object's member values are
+ * the devices, and null holds none. Each device must be an object with
+ * every field above. String fields must be strings. Integer fields take
+ * numbers (floats are truncated) and booleans. Anything else stops the
+ * parse.
+ *
+ * Depth 1 is the top-level object, 2 the DevList container, 3 a device
+ * object; anything nested deeper is ignored.
+ */
+class DeviceListSax : public nlohmann::json_sax<json> {
+public:
+    explicit DeviceListSax(std::vector<Device>& devices) : devices_(devices) {}
+
+    bool found_list() const { return found_list_; }
+
+    bool null() override {
+        if (depth_ == 1 && list_key_) {
+            return value_done(); // "DevList": null, no devices
+        }
+        return scalar(false);
+    }
+    // get<int>() read booleans as 0 / 1, so integer fields still accept them
+    bool boolean(bool v) override { return int_value(v ? 1 : 0); }
+    bool number_integer(number_integer_t v) override { return int_value(static_cast<int64_t>(v)); }
+    bool number_unsigned(number_unsigned_t v) override { return int_value(static_cast<int64_t>(v)); }
+    bool number_float(number_float_t v, const string_t&) override { return int_value(static_cast<int64_t>(v)); }
+    bool binary(binary_t&) override { return scalar(false); }
+
+    bool string(string_t& v) override {
+        if (in_device() && field_ != DeviceField::NONE) {
+            if (is_int_field(field_)) {
+                return false;
+            }
+            switch (field_) {
+                case DeviceField::NAME: dev_.name = std::move(v); break;
+                case DeviceField::SSID: dev_.ssid = std::move(v); break;
+                case DeviceField::MAC: dev_.mac = std::move(v); break;
+                case DeviceField::TYPE: dev_.type = std::move(v); break;
+                case DeviceField::FIRMWARE_MARK: firmware_mark_ = std::move(v); break;
+                case DeviceField::FIRMWARE_VERSION: firmware_version_ = std::move(v); break;
+                case DeviceField::VISIT_PWD: dev_.visit_pwd = std::move(v); break;
+                case DeviceField::WORK_STATUS: dev_.work_status_bytes = base64_decode(v); break;
+                default: break;
+            }
+            return scalar(true);
+        }
+        return scalar(false);
+    }
+
+    bool start_object(std::size_t) override {
+        if (!container_allowed(false)) {
             return false;
         }
-        
-        devices.clear();
-        for (const auto& item : j["DevList"]) {
-            Device dev;
-            dev.name     = item["DeviceName"].get<std::string>();
-            dev.ssid     = item["APSSID"].get<std::string>();
-            dev.mac      = item["DMAC"].get<std::string>();
-            dev.type     = item["DeviceType"].get<std::string>();
-            dev.firmware = item["FirmwareMark"].get<std::string>() + " " + item["FirmwareVersion"].get<std::string>();
-            dev.online   = item["OnlineStatus"].get<int>() == 1;
-            dev.line_no  = item["LineNo"].get<int>();
-            dev.line_type= item["LineType"].get<int>();
-            dev.did      = item["DID"].get<int>();
-            dev.visit_pwd= item["VisitPwd"].get<std::string>();
-            auto work_status_b64 = item["WorkStatus"].get<std::string>();
-            dev.work_status_bytes = base64_decode(work_status_b64);
-            devices.push_back(dev);
-        }
-        
+        ++depth_;
+        if (depth_ == 2 && list_key_) {
+            in_list_ = true; // DevList as an object: its member values are the devices
+            list_key_ = false;
+        }
+        if (in_list_ && depth_ == 3) {
+            dev_ = Device{};
+            firmware_mark_.clear();
+            firmware_version_.clear();
+            seen_ = 0;
+        }
+        field_ = DeviceField::NONE;
+        return true;
+    }
+
+    bool end_object() override {
+        if (in_list_ && depth_ == 3) {
+            if (seen_ != ALL_DEVICE_FIELDS) {
+                return false;
+            }
+            dev_.firmware = firmware_mark_ + " " + firmware_version_;
+            devices_.push_back(std::move(dev_));
+        }
+        if (depth_ == 2) {
+            in_list_ = false;
+        }
+        --depth_;
+        return value_done();
+    }
+
+    bool start_array(std::size_t) override {
+        if (!container_allowed(true)) {
+            return false;
+        }
+        ++depth_;
+        if (depth_ == 2 && list_key_) {
+            in_list_ = true;
+            list_key_ = false;
+        }
+        field_ = DeviceField::NONE;
         return true;
+    }
+
+    bool end_array() override {
+        if (depth_ == 2) {
+            in_list_ = false;
+        }
+        --depth_;
+        return value_done();
+    }
+
+    bool key(string_t& k) override {
+        if (depth_ == 1) {
+            list_key_ = (k == "DevList");
+            if (list_key_) {
+                found_list_ = true;
+            }
+        } else if (in_device()) {
+            field_ = device_field(k);
+        }
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception&) override {
+        return false;
+    }
+
+private:
+    bool in_device() const { return in_list_ && depth_ == 3; }
+
+    // Whether an object or array may start here
+    bool container_allowed(bool array) const {
+        if (depth_ == 1 && list_key_) {
+            return true; // DevList itself
+        }
+        if (in_list_ && depth_ == 2) {
+            return !array; // devices are objects
+        }
+        return !(in_device() && field_ != DeviceField::NONE); // device fields are scalars
+    }
+
+    bool int_value(int64_t v) {
+        if (in_device() && field_ != DeviceField::NONE) {
+            if (!is_int_field(field_)) {
+                return false;
+            }
+            switch (field_) {
+                case DeviceField::ONLINE_STATUS: dev_.online = v == 1; break;
+                case DeviceField::LINE_NO: dev_.line_no = static_cast<int>(v); break;
+                case DeviceField::LINE_TYPE: dev_.line_type = static_cast<int>(v); break;
+                case DeviceField::DID: dev_.did = static_cast<int>(v); break;
+                default: break;
+            }
+            return scalar(true);
+        }
+        return scalar(false);
+    }
+
+    // A scalar value; stored says whether it filled the current device field
+    bool scalar(bool stored) {
+        if (in_device() && field_ != DeviceField::NONE && !stored) {
+            return false; // wrong type for a device field
+        }
+        if (in_list_ && depth_ == 2) {
+            return false; // DevList elements must be objects
+        }
+        if (depth_ == 1 && list_key_) {
+            return false; // DevList must be a container or null
+        }
+        if (stored) {
+            seen_ |= field_bit(field_);
+        }
+        return value_done();
+    }
+
+    bool value_done() {
+        field_ = DeviceField::NONE;
+        if (depth_ == 1) {
+            list_key_ = false;
+        }
+        return true;
+    }
+
+    std::vector<Device>& devices_;
+    Device dev_{};
+    std::string firmware_mark_;
+    std::string firmware_version_;
+    DeviceField field_ = DeviceField::NONE;
+    uint32_t seen_ = 0;
+    int depth_ = 0;
+    bool list_key_ = false;
+    bool in_list_ = false;
+    bool found_list_ = false;
+};
+
+} // namespace
+
+bool json_backends::extract_device_list_nlohmann(ByteSpan json_bytes, std::vector<Device>& devices) {
+    devices.clear();
+    DeviceListSax sax(devices);
+    bool ok = false;
+    try {
+        ok = json::sax_parse(json_bytes.begin(), json_bytes.end(), &sax);
     } catch (const std::exception& e) {
+        ok = false;
+    }
+    if (!ok || !sax.found_list()) {
+        devices.clear();
         return false;
     }
+    return true;
+}
+
+bool extract_device_list(ByteSpan json_bytes, std::vector<Device>& devices) {
+    if (auto result = json_backends::extract_device_list_simdjson(json_bytes, devices)) {
+        return *result;
+    }
+    return json_backends::extract_device_list_nlohmann(json_bytes, devices);
+}
+
+bool extract_device_list(const std::string& json_str, std::vector<Device>& devices) {
+    return extract_device_list(
+        ByteSpan(reinterpret_cast<const uint8_t*>(json_str.data()), json_str.size()), devices);
 }
 
 #endif
@@ -111,15 +581,19 @@ static bool parse_ir_key(const void* json_obj, IRKey& k) {
     return true;
 }
 
-OgeIRDeviceCode parse_oge_ir_device_code(const std::string& json_str) {
-    OgeIRDeviceCode d;
+bool parse_ir_key_json(ByteSpan entry_json, IRKey& key) {
     JsonDocument doc;
-    DeserializationError error = deserializeJson(doc, json_str);
-    
-    if (error) {
-        return d; // Return empty object on error
+    if (deserializeJson(doc, reinterpret_cast<const char*>(entry_json.data()), entry_json.size())) {
+        key = IRKey();
+        return false;
     }
-    
+    JsonObject key_obj = doc.as<JsonObject>();
+    return parse_ir_key(&key_obj, key);
+}
+
+static OgeIRDeviceCode ir_device_code_from_doc(JsonDocument& doc) {
+    OgeIRDeviceCode d;
+
     auto get_or_empty = [&](const char* k) -> std::string {
         return doc[k].is<const char*>() ? doc[k].as<std::string>() : "";
     };
@@ -172,6 +646,92 @@ OgeIRDeviceCode parse_oge_ir_device_code(const std::string& json_str) {
     return d;
 }
 
+OgeIRDeviceCode parse_oge_ir_device_code(const std::string& json_str) {
+    JsonDocument doc;
+    if (deserializeJson(doc, json_str)) {
+        return OgeIRDeviceCode(); // Return empty object on error
+    }
+    return ir_device_code_from_doc(doc);
+}
+
+OgeIRDeviceCode parse_oge_ir_device_code(ByteSpan json_bytes) {
+    JsonDocument doc;
+    if (deserializeJson(doc, reinterpret_cast<const char*>(json_bytes.data()), json_bytes.size())) {
+        return OgeIRDeviceCode(); // Return empty object on error
+    }
+    return ir_device_code_from_doc(doc);
+}
+
+// Only what building AC commands needs is kept: the protocol parameters, the
+// on/off behaviour and the key list. Each value is decoded on its own as it
+// streams past, so the heap holds the result plus one IRKeyList entry.
+OgeIRDeviceCode parse_oge_ir_device_code(InflateStream& json_stream) {
+    BasicJsonScanner<InflateReader> scanner(json_stream);
+    if (!scanner.consume('{')) {
+        return OgeIRDeviceCode();
+    }
+
+    JsonDocument key_filter;
+    key_filter["Key"] = true;
+    key_filter["Para"] = true;
+    key_filter["HexCode"] = true;
+
+    OgeIRDeviceCode d;
+    JsonDocument switch_state;
+    JsonDocument switch_state_alt;
+    std::string key;
+    std::string text; // raw JSON of the value being decoded, reused
+
+    while (!scanner.consume('}')) {
+        if (!scanner.string(key) || !scanner.consume(':')) {
+            return OgeIRDeviceCode(); // Return empty object on error
+        }
+
+        if (key == "IRKeyList") {
+            d.ir_key_list.clear();
+            if (!scanner.consume('[')) {
+                // not an array: no keys, as with the full document
+                if (!scanner.skip_value()) return OgeIRDeviceCode();
+            } else {
+                while (!scanner.consume(']')) {
+                    JsonDocument doc;
+                    if (!scanner.skip_value(&text) ||
+                        deserializeJson(doc, text, DeserializationOption::Filter(key_filter))) {
+                        return OgeIRDeviceCode();
+                    }
+                    JsonObject key_obj = doc.as<JsonObject>();
+                    IRKey ir_key;
+                    parse_ir_key(&key_obj, ir_key);
+                    d.ir_key_list.push_back(std::move(ir_key));
+                    scanner.consume(',');
+                }
+            }
+        } else if (key == "ProtocolPara" || key == "OnOffType" || key == "switchState" || key == "switch_state") {
+            JsonDocument doc;
+            if (!scanner.skip_value(&text) || deserializeJson(doc, text)) {
+                return OgeIRDeviceCode();
+            }
+            if (key == "ProtocolPara") {
+                d.protocol_para = doc.is<const char*>() ? doc.as<std::string>() : "";
+            } else if (key == "OnOffType") {
+                d.on_off_type = doc.is<int>() ? doc.as<int>() : 0;
+            } else if (key == "switchState") {
+                switch_state = std::move(doc);
+            } else {
+                switch_state_alt = std::move(doc);
+            }
+        } else if (!scanner.skip_value()) {
+            return OgeIRDeviceCode();
+        }
+        scanner.consume(',');
+    }
+
+    d.switch_state = switch_state.is<int>() ? switch_state.as<int>() :
+                     (switch_state_alt.is<int>() ? switch_state_alt.as<int>() : 0);
+    d.index.clear();
+    return d;
+}
+
 #else
     // Linux/Mac implementation using nlohmann/json
 
@@ -193,63 +753,204 @@ OgeIRDeviceCode parse_oge_ir_device_code(const std::string& json_str) {
     return true;
 }
 
-OgeIRDeviceCode parse_oge_ir_device_code(const std::string& json_str) {
-    OgeIRDeviceCode d;
+bool parse_ir_key_json(ByteSpan entry_json, IRKey& key) {
     try {
-        json j = json::parse(json_str);
-        
-        auto get_or_empty = [&](const char* k) -> std::string {
-            return j.contains(k) && !j.at(k).is_null() ? j.at(k).get<std::string>() : "";
-        };
-        
-        auto get_or_int = [&](const char* k, int def) -> int {
-            return j.contains(k) && j.at(k).is_number() ? j.at(k).get<int>() : def;
-        };
-        
-        auto get_or_bool = [&](const char* k, bool def) -> bool {
-            return j.contains(k) && j.at(k).is_boolean() ? j.at(k).get<bool>() : def;
-        };
-        
-        d.brand_name         = get_or_empty("BrandName");
-        d.edit_time          = get_or_empty("EditTime");
-        d.file_type          = get_or_empty("FileType");
-        d.ir_device_type     = get_or_int("IRDeviceType", 0);
-        d.ir_set_feature     = get_or_empty("IRSetFeature");
-        d.ir_set_id          = get_or_empty("IRSetID");
-        d.ir_set_state_masks = get_or_empty("IRSetStateMasks");
-        d.is_reviewed        = get_or_bool("IsReviewed", false);
-        d.key_count          = get_or_int("KeyCount", 0);
-        d.local_analyse_para = get_or_empty("LocalAnalysePara");
-        d.on_off_type        = get_or_int("OnOffType", 0);
-        d.protocol           = get_or_empty("Protocol");
-        d.protocol_para      = get_or_empty("ProtocolPara");
-        d.wind_dirction_type = get_or_int("WindDirctionType", 0);
-        
-        d.fan_speed       = j.value("fanSpeed", j.value("fan_speed", 0));
-        d.last_action_type= j.value("lastActionType", j.value("last_action_type", 0));
-        d.mode            = j.value("mode", 0);
-        d.power           = j.value("power", 0);
-        d.swing           = j.value("swing", 0);
-        d.switch_state    = j.value("switchState", j.value("switch_state", 0));
-        d.temperature     = j.value("temperature", 0);
-        
-        d.ir_key_list.clear();
-        if (j.contains("IRKeyList") && j.at("IRKeyList").is_array()) {
-            for (const auto& key_obj : j.at("IRKeyList")) {
-                IRKey key;
-                parse_ir_key(&key_obj, key);
-                d.ir_key_list.push_back(key);
-            }
-        }
-        
-        d.index.clear();
+        json j = json::parse(entry_json.begin(), entry_json.end());
+        return parse_ir_key(&j, key);
     } catch (const std::exception& e) {
-        // Return empty object on error
+        key = IRKey();
+        return false;
+    }
+}
+
+// std::streambuf over an InflateStream so nlohmann can parse while inflating
+class InflateStreamBuf : public std::streambuf {
+public:
+    explicit InflateStreamBuf(InflateStream& stream) : stream_(stream) {}
+
+protected:
+    int_type underflow() override {
+        size_t n = stream_.read(reinterpret_cast<uint8_t*>(buf_), sizeof(buf_));
+        if (n == 0) {
+            return traits_type::eof();
+        }
+        setg(buf_, buf_, buf_ + n);
+        return traits_type::to_int_type(buf_[0]);
     }
+
+private:
+    InflateStream& stream_;
+    char buf_[4096];
+};
+
+static OgeIRDeviceCode ir_device_code_from_json(const json& j) {
+    OgeIRDeviceCode d;
+
+    auto get_or_empty = [&](const char* k) -> std::string {
+        return j.contains(k) && !j.at(k).is_null() ? j.at(k).get<std::string>() : "";
+    };
+    
+    auto get_or_int = [&](const char* k, int def) -> int {
+        return j.contains(k) && j.at(k).is_number() ? j.at(k).get<int>() : def;
+    };
+    
+    auto get_or_bool = [&](const char* k, bool def) -> bool {
+        return j.contains(k) && j.at(k).is_boolean() ? j.at(k).get<bool>() : def;
+    };
     
+    d.brand_name         = get_or_empty("BrandName");
+    d.edit_time          = get_or_empty("EditTime");
+    d.file_type          = get_or_empty("FileType");
+    d.ir_device_type     = get_or_int("IRDeviceType", 0);
+    d.ir_set_feature     = get_or_empty("IRSetFeature");
+    d.ir_set_id          = get_or_empty("IRSetID");
+    d.ir_set_state_masks = get_or_empty("IRSetStateMasks");
+    d.is_reviewed        = get_or_bool("IsReviewed", false);
+    d.key_count          = get_or_int("KeyCount", 0);
+    d.local_analyse_para = get_or_empty("LocalAnalysePara");
+    d.on_off_type        = get_or_int("OnOffType", 0);
+    d.protocol           = get_or_empty("Protocol");
+    d.protocol_para      = get_or_empty("ProtocolPara");
+    d.wind_dirction_type = get_or_int("WindDirctionType", 0);
+    
+    d.fan_speed       = j.value("fanSpeed", j.value("fan_speed", 0));
+    d.last_action_type= j.value("lastActionType", j.value("last_action_type", 0));
+    d.mode            = j.value("mode", 0);
+    d.power           = j.value("power", 0);
+    d.swing           = j.value("swing", 0);
+    d.switch_state    = j.value("switchState", j.value("switch_state", 0));
+    d.temperature     = j.value("temperature", 0);
+    
+    d.ir_key_list.clear();
+    if (j.contains("IRKeyList") && j.at("IRKeyList").is_array()) {
+        for (const auto& key_obj : j.at("IRKeyList")) {
+            IRKey key;
+            parse_ir_key(&key_obj, key);
+            d.ir_key_list.push_back(key);
+        }
+    }
+    
+    d.index.clear();
     return d;
 }
 
+OgeIRDeviceCode json_backends::parse_oge_ir_device_code_nlohmann(ByteSpan json_bytes) {
+    try {
+        return ir_device_code_from_json(json::parse(json_bytes.begin(), json_bytes.end()));
+    } catch (const std::exception& e) {
+        return OgeIRDeviceCode(); // Return empty object on error
+    }
+}
+
+OgeIRDeviceCode parse_oge_ir_device_code(ByteSpan json_bytes) {
+    if (auto result = json_backends::parse_oge_ir_device_code_simdjson(json_bytes)) {
+        return std::move(*result);
+    }
+    return json_backends::parse_oge_ir_device_code_nlohmann(json_bytes);
+}
+
+OgeIRDeviceCode parse_oge_ir_device_code(const std::string& json_str) {
+    return parse_oge_ir_device_code(
+        ByteSpan(reinterpret_cast<const uint8_t*>(json_str.data()), json_str.size()));
+}
+
+OgeIRDeviceCode parse_oge_ir_device_code(InflateStream& json_stream) {
+    try {
+        InflateStreamBuf buf(json_stream);
+        std::istream in(&buf);
+        return ir_device_code_from_json(json::parse(in));
+    } catch (const std::exception& e) {
+        return OgeIRDeviceCode(); // Return empty object on error
+    }
+}
+
 #endif
 
+OgeIRDeviceCode parse_oge_ir_device_code_lazy(std::vector<uint8_t> json_bytes) {
+    const char* text = reinterpret_cast<const char*>(json_bytes.data());
+    JsonScanner scanner(text, text + json_bytes.size());
+
+    // Find the (last) IRKeyList and the extent and key of each entry
+    const char* list_begin = nullptr;
+    const char* list_end = nullptr;
+    auto source = std::make_shared<IRKeySource>();
+    bool ok = scanner.consume('{');
+    while (ok && !scanner.consume('}')) {
+        const char* key;
+        size_t key_len;
+        if (!scanner.string(key, key_len) || !scanner.consume(':')) {
+            ok = false;
+            break;
+        }
+        const char* value = scanner.pos();
+        if (!key_equals(key, key_len, "IRKeyList") || !scanner.consume('[')) {
+            ok = scanner.skip_value();
+            scanner.consume(',');
+            continue;
+        }
+
+        list_begin = value;
+        source->entries.clear();
+        while (ok && !scanner.consume(']')) {
+            const char* start = scanner.pos();
+            if (!scanner.skip_value()) {
+                ok = false;
+                break;
+            }
+            IRKeySource::Entry entry;
+            entry.offset = static_cast<uint32_t>(start - text);
+            entry.length = static_cast<uint32_t>(scanner.pos() - start);
+
+            // Pull out "Key" without decoding the rest of the entry
+            JsonScanner item(start, scanner.pos());
+            if (item.consume('{')) {
+                while (!item.consume('}')) {
+                    const char* name;
+                    size_t name_len;
+                    const char* v;
+                    size_t v_len;
+                    if (!item.string(name, name_len) || !item.consume(':')) break;
+                    if (key_equals(name, name_len, "Key") && item.string(v, v_len)) {
+                        entry.key.assign(v, v_len);
+                    } else if (!item.skip_value()) {
+                        break;
+                    }
+                    item.consume(',');
+                }
+            }
+            if (entry.key.find('\\') != std::string::npos) {
+                // escaped key: let the JSON parser unescape it
+                IRKey decoded;
+                parse_ir_key_json(ByteSpan(json_bytes.data() + entry.offset, entry.length), decoded);
+                entry.key = decoded.key;
+            }
+            source->entries.push_back(std::move(entry));
+            scanner.consume(',');
+        }
+        list_end = scanner.pos();
+        scanner.consume(',');
+    }
+    if (!ok || !list_begin) {
+        return parse_oge_ir_device_code(ByteSpan(json_bytes)); // nothing to defer
+    }
+
+    // Metadata: the same document with the key list replaced by null
+    size_t list_offset = static_cast<size_t>(list_begin - text);
+    size_t list_len = static_cast<size_t>(list_end - list_begin);
+    std::string rest;
+    rest.reserve(json_bytes.size() - list_len + 4);
+    rest.append(text, list_offset).append("null").append(list_end, text + json_bytes.size() - list_end);
+    OgeIRDeviceCode d = parse_oge_ir_device_code(rest);
+    d.ir_key_list.clear();
+
+    // The text is kept as is (the key list is nearly all of it) rather than copied
+    source->json = std::move(json_bytes);
+    for (size_t i = 0; i < source->entries.size(); ++i) {
+        source->by_key.emplace(source->entries[i].key, static_cast<uint32_t>(i));
+    }
+    d.lazy_keys = std::move(source);
+    d.index.clear();
+    return d;
+}
+
 } // namespace e7_switcher
@@ -0,0 +1,375 @@
+#if defined(ARDUINO) || defined(ESP_PLATFORM) || defined(ESP32) || defined(ESP8266)
+// ESP32 builds use ArduinoJson only (see json_helpers.cpp)
+#else
+
+#include "e7-switcher/json_backends.h"
+
+#ifdef E7_USE_SIMDJSON
+
+#include "e7-switcher/base64_decode.h"
+#include <simdjson.h>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace e7_switcher {
+namespace json_backends {
+
+namespace {
+
+using namespace simdjson;
+
+// Parser and padded input buffer, reused per thread. simdjson needs
+// SIMDJSON_PADDING readable bytes past the input, which received frames
+// do not guarantee, so the payload is copied into this buffer first.
+struct SimdState {
+    ondemand::parser parser;
+    std::string buffer;
+};
+
+SimdState& simd_state() {
+    static thread_local SimdState state;
+    return state;
+}
+
+// Parses the input, returning the document; false on any error
+bool iterate(ByteSpan json_bytes, ondemand::document& doc) {
+    SimdState& st = simd_state();
+    st.buffer.resize(json_bytes.size() + SIMDJSON_PADDING);
+    std::memcpy(&st.buffer[0], json_bytes.data(), json_bytes.size());
+    return !st.parser.iterate(st.buffer.data(), json_bytes.size(), st.buffer.size()).get(doc);
+}
+
+// get<int>() semantics of nlohmann for a number: integers are narrowed,
+// floats truncated. Returns false for big integers.
+bool number_to_int(ondemand::value value, int& out) {
+    ondemand::number n;
+    if (value.get_number().get(n)) {
+        return false;
+    }
+    switch (n.get_number_type()) {
+        case ondemand::number_type::signed_integer: out = static_cast<int>(n.get_int64()); return true;
+        case ondemand::number_type::unsigned_integer: out = static_cast<int>(n.get_uint64()); return true;
+        case ondemand::number_type::floating_point_number: out = static_cast<int>(n.get_double()); return true;
+        default: return false;
+    }
+}
+
+// --- Device list -------------------------------------------------------------
+
+// Mirrors the nlohmann SAX handler: every field must be present, string
+// fields must be strings and integer fields numbers (floats truncated).
+// Returns false otherwise, leaving the verdict to the nlohmann fallback;
+// that includes booleans in integer fields, which the handler reads as 0 / 1.
+bool read_device(ondemand::object obj, Device& dev) {
+    static const char* const string_keys[] = {
+        "DeviceName", "APSSID", "DMAC", "DeviceType", "FirmwareMark", "FirmwareVersion", "VisitPwd", "WorkStatus"
+    };
+    static const char* const int_keys[] = {"OnlineStatus", "LineNo", "LineType", "DID"};
+    std::string firmware_mark;
+    std::string firmware_version;
+    uint32_t seen = 0;
+    for (auto field_result : obj) {
+        ondemand::field field;
+        std::string_view key;
+        if (std::move(field_result).get(field) || field.unescaped_key().get(key)) {
+            return false;
+        }
+        ondemand::value value = field.value();
+
+        size_t i = 0;
+        while (i < 8 && key != string_keys[i]) {
+            ++i;
+        }
+        if (i < 8) {
+            std::string_view sv;
+            if (value.get_string().get(sv)) {
+                return false;
+            }
+            switch (i) {
+                case 0: dev.name.assign(sv); break;
+                case 1: dev.ssid.assign(sv); break;
+                case 2: dev.mac.assign(sv); break;
+                case 3: dev.type.assign(sv); break;
+                case 4: firmware_mark.assign(sv); break;
+                case 5: firmware_version.assign(sv); break;
+                case 6: dev.visit_pwd.assign(sv); break;
+                default: dev.work_status_bytes = base64_decode(sv.data(), sv.size()); break;
+            }
+            seen |= 1u << i;
+            continue;
+        }
+
+        size_t j = 0;
+        while (j < 4 && key != int_keys[j]) {
+            ++j;
+        }
+        if (j < 4) {
+            int v;
+            if (!number_to_int(value, v)) {
+                return false;
+            }
+            switch (j) {
+                case 0: dev.online = v == 1; break;
+                case 1: dev.line_no = v; break;
+                case 2: dev.line_type = v; break;
+                default: dev.did = v; break;
+            }
+            seen |= 1u << (8 + j);
+        }
+        // unused keys are skipped by the iterator
+    }
+    if (seen != (1u << 12) - 1) {
+        return false;
+    }
+    dev.firmware = firmware_mark + " " + firmware_version;
+    return true;
+}
+
+bool read_device_list(ondemand::document& doc, std::vector<Device>& devices, bool& found) {
+    ondemand::object root;
+    if (doc.get_object().get(root)) {
+        return false;
+    }
+    for (auto field_result : root) {
+        ondemand::field field;
+        std::string_view key;
+        if (std::move(field_result).get(field) || field.unescaped_key().get(key)) {
+            return false;
+        }
+        if (key != "DevList") {
+            continue;
+        }
+        found = true;
+        ondemand::array list;
+        if (field.value().get_array().get(list)) {
+            return false; // null and object lists are left to the nlohmann handler
+        }
+        for (auto element : list) {
+            ondemand::object obj;
+            if (element.get_object().get(obj)) {
+                return false;
+            }
+            Device dev{};
+            if (!read_device(obj, dev)) {
+                return false;
+            }
+            devices.push_back(std::move(dev));
+        }
+    }
+    return doc.at_end();
+}
+
+// --- OgeIRDeviceCode -------------------------------------------------------
+
+// Mirrors ir_device_code_from_json() in json_helpers.cpp. Every case where
+// nlohmann would throw (and so yield an empty result) returns false instead,
+// and the caller falls back to nlohmann to produce that exact result.
+
+// get_or_empty(): null -> "", string -> value, anything else throws
+bool string_or_empty(ondemand::value value, std::string& out) {
+    bool is_null = false;
+    if (value.is_null().get(is_null)) {
+        return false;
+    }
+    if (is_null) {
+        out.clear();
+        return true;
+    }
+    std::string_view sv;
+    if (value.get_string().get(sv)) {
+        return false;
+    }
+    out.assign(sv);
+    return true;
+}
+
+// json::value(key, int): numbers and booleans convert, anything else throws
+bool value_int(ondemand::value value, std::optional<int>& out) {
+    ondemand::json_type type;
+    if (value.type().get(type)) {
+        return false;
+    }
+    int v = 0;
+    if (type == ondemand::json_type::boolean) {
+        bool b;
+        if (value.get_bool().get(b)) return false;
+        v = b ? 1 : 0;
+    } else if (type != ondemand::json_type::number || !number_to_int(value, v)) {
+        return false;
+    }
+    out = v;
+    return true;
+}
+
+// parse_ir_key(): present keys must be strings
+bool read_ir_key(ondemand::value element, IRKey& key) {
+    ondemand::object obj;
+    if (element.get_object().get(obj)) {
+        ondemand::json_type type;
+        // non-objects yield an empty key in the nlohmann path
+        return !element.type().get(type) && type != ondemand::json_type::object;
+    }
+    for (auto field_result : obj) {
+        ondemand::field field;
+        std::string_view name;
+        if (std::move(field_result).get(field) || field.unescaped_key().get(name)) {
+            return false;
+        }
+        if (name != "Key" && name != "Para" && name != "HexCode") {
+            continue;
+        }
+        std::string_view sv;
+        if (field.value().get_string().get(sv)) {
+            return false;
+        }
+        if (name == "Key") key.key.assign(sv);
+        else if (name == "Para") key.para = std::string(sv);
+        else key.hex_code.assign(sv);
+    }
+    return true;
+}
+
+bool read_ir_device_code(ondemand::document& doc, OgeIRDeviceCode& d) {
+    ondemand::object root;
+    if (doc.get_object().get(root)) {
+        return false;
+    }
+
+    std::optional<int> fan_speed, fan_speed_alt, last_action, last_action_alt;
+    std::optional<int> mode, power, swing, switch_state, switch_state_alt, temperature;
+
+    for (auto field_result : root) {
+        ondemand::field field;
+        std::string_view key;
+        if (std::move(field_result).get(field) || field.unescaped_key().get(key)) {
+            return false;
+        }
+        ondemand::value value = field.value();
+        bool ok = true;
+
+        if (key == "BrandName") ok = string_or_empty(value, d.brand_name);
+        else if (key == "EditTime") ok = string_or_empty(value, d.edit_time);
+        else if (key == "FileType") ok = string_or_empty(value, d.file_type);
+        else if (key == "IRSetFeature") ok = string_or_empty(value, d.ir_set_feature);
+        else if (key == "IRSetID") ok = string_or_empty(value, d.ir_set_id);
+        else if (key == "IRSetStateMasks") ok = string_or_empty(value, d.ir_set_state_masks);
+        else if (key == "LocalAnalysePara") ok = string_or_empty(value, d.local_analyse_para);
+        else if (key == "Protocol") ok = string_or_empty(value, d.protocol);
+        else if (key == "ProtocolPara") ok = string_or_empty(value, d.protocol_para);
+        else if (key == "IRDeviceType" || key == "KeyCount" || key == "OnOffType" || key == "WindDirctionType") {
+            // get_or_int(): numbers convert, anything else gives the default
+            int v = 0;
+            ondemand::json_type type;
+            if (value.type().get(type)) return false;
+            if (type == ondemand::json_type::number && !number_to_int(value, v)) return false;
+            if (key == "IRDeviceType") d.ir_device_type = v;
+            else if (key == "KeyCount") d.key_count = v;
+            else if (key == "OnOffType") d.on_off_type = v;
+            else d.wind_dirction_type = v;
+        } else if (key == "IsReviewed") {
+            bool b = false;
+            ondemand::json_type type;
+            if (value.type().get(type)) return false;
+            if (type == ondemand::json_type::boolean && value.get_bool().get(b)) return false;
+            d.is_reviewed = b;
+        }
+        else if (key == "fanSpeed") ok = value_int(value, fan_speed);
+        else if (key == "fan_speed") ok = value_int(value, fan_speed_alt);
+        else if (key == "lastActionType") ok = value_int(value, last_action);
+        else if (key == "last_action_type") ok = value_int(value, last_action_alt);
+        else if (key == "mode") ok = value_int(value, mode);
+        else if (key == "power") ok = value_int(value, power);
+        else if (key == "swing") ok = value_int(value, swing);
+        else if (key == "switchState") ok = value_int(value, switch_state);
+        else if (key == "switch_state") ok = value_int(value, switch_state_alt);
+        else if (key == "temperature") ok = value_int(value, temperature);
+        else if (key == "IRKeyList") {
+            d.ir_key_list.clear();
+            ondemand::array list;
+            if (value.get_array().get(list)) {
+                continue; // not an array: no keys
+            }
+            for (auto element : list) {
+                ondemand::value v;
+                IRKey ir_key;
+                if (element.get(v) || !read_ir_key(v, ir_key)) {
+                    return false;
+                }
+                d.ir_key_list.push_back(std::move(ir_key));
+            }
+        }
+
+        if (!ok) {
+            return false;
+        }
+    }
+
+    d.fan_speed        = fan_speed.value_or(fan_speed_alt.value_or(0));
+    d.last_action_type = last_action.value_or(last_action_alt.value_or(0));
+    d.mode             = mode.value_or(0);
+    d.power            = power.value_or(0);
+    d.swing            = swing.value_or(0);
+    d.switch_state     = switch_state.value_or(switch_state_alt.value_or(0));
+    d.temperature      = temperature.value_or(0);
+    d.index.clear();
+    return doc.at_end();
+}
+
+} // namespace
+
+bool simdjson_enabled() {
+    return true;
+}
+
+std::optional<bool> extract_device_list_simdjson(ByteSpan json_bytes, std::vector<Device>& devices) {
+    ondemand::document doc;
+    std::vector<Device> out;
+    bool found = false;
+    if (!iterate(json_bytes, doc) || !read_device_list(doc, out, found)) {
+        return std::nullopt;
+    }
+    if (!found) {
+        devices.clear();
+        return false;
+    }
+    devices = std::move(out);
+    return true;
+}
+
+std::optional<OgeIRDeviceCode> parse_oge_ir_device_code_simdjson(ByteSpan json_bytes) {
+    ondemand::document doc;
+    OgeIRDeviceCode d;
+    if (!iterate(json_bytes, doc) || !read_ir_device_code(doc, d)) {
+        return std::nullopt;
+    }
+    return d;
+}
+
+} // namespace json_backends
+} // namespace e7_switcher
+
+#else // E7_USE_SIMDJSON
+
+namespace e7_switcher {
+namespace json_backends {
+
+bool simdjson_enabled() {
+    return false;
+}
+
+std::optional<bool> extract_device_list_simdjson(ByteSpan, std::vector<Device>&) {
+    return std::nullopt;
+}
+
+std::optional<OgeIRDeviceCode> parse_oge_ir_device_code_simdjson(ByteSpan) {
+    return std::nullopt;
+}
+
+} // namespace json_backends
+} // namespace e7_switcher
+
+#endif // E7_USE_SIMDJSON
+
+#endif // desktop
@@ -1,4 +1,5 @@
 #include "e7-switcher/logger.h"
+#include "e7-switcher/async_logger.h"
 #include <cstdarg>
 #include <cstdio>
 #include <memory>
@@ -14,6 +15,7 @@
 namespace e7_switcher {
 
 std::unique_ptr<Logger> Logger::instance_;
+std::atomic<LogLevel> Logger::level_{LogLevel::INFO};
 
 #ifdef E7_PLATFORM_ESP
 // ESP32 implementation using Serial
@@ -37,6 +39,7 @@ public:
     
     void set_log_level(LogLevel level) override {
         log_level_ = level;
+        publish_level(level);
     }
 
     void info(const std::string& message) override {
@@ -111,6 +114,7 @@ public:
     
     void set_log_level(LogLevel level) override {
         log_level_ = level;
+        publish_level(level);
     }
 
     void info(const std::string& message) override {
@@ -169,13 +173,31 @@ public:
 };
 #endif
 
-void Logger::initialize(LogLevel level) {
+namespace {
+
+std::unique_ptr<Logger> make_platform_logger() {
 #ifdef E7_PLATFORM_ESP
-    instance_ = std::make_unique<ESPLogger>();
+    return std::make_unique<ESPLogger>();
 #else
-    instance_ = std::make_unique<StdLogger>();
+    return std::make_unique<StdLogger>();
 #endif
-    instance_->set_log_level(level);
+}
+
+} // namespace
+
+void Logger::initialize(LogLevel level) {
+    instance_ = make_platform_logger();
+    set_level(level);
+}
+
+void Logger::initialize_async(LogLevel level, size_t capacity, AsyncLogPolicy policy) {
+    instance_.reset(); // an async logger being replaced drains first
+    instance_ = std::make_unique<AsyncLogger>(make_platform_logger(), capacity, policy);
+    set_level(level);
+}
+
+void Logger::set_level(LogLevel level) {
+    instance().set_log_level(level);
 }
 
 Logger& Logger::instance() {
@@ -1,7 +1,7 @@
 #include "e7-switcher/message_stream.h"
 #include "e7-switcher/constants.h"
 #include "e7-switcher/parser.h"
-#include "e7-switcher/socket_utils.h"
+#include "e7-switcher/tracing.h"
 #include <stdexcept>
 #include <iostream>
 #include <cstring>
@@ -12,72 +12,51 @@ namespace {
 inline uint16_t le16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
 }
 
-MessageStream::MessageStream() : host_(""), port_(0), timeout_(5), recv_timeout_seconds_(5), sock_(net::INVALID_SOCKET_HANDLE) {}
+MessageStream::MessageStream(std::unique_ptr<Transport> transport)
+    : transport_(transport ? std::move(transport) : std::make_unique<SocketTransport>()) {}
 
 MessageStream::~MessageStream() {
     close();
 }
 
 void MessageStream::connect_to_server(const std::string& host, int port, int timeout_seconds) {
-    host_ = host;
-    port_ = port;
-    timeout_ = timeout_seconds;
-    std::string err;
-    if (!net::startup(err)) {
-        throw std::runtime_error("Socket startup failed: " + err);
-    }
-    // Close existing if any and connect
-    if (sock_ != net::INVALID_SOCKET_HANDLE) {
-        net::close(sock_);
-    }
-    if (!net::connect(sock_, host_, port_, timeout_seconds * 1000, err)) {
-        throw std::runtime_error("Connection Failed: " + err);
+    E7_TRACE_SPAN("connect", "net");
+    transport_->connect(host, port, timeout_seconds);
+    if (has_connected_) {
+        metrics_.count_reconnect();
     }
-    // Set default recv timeout
-    if (!net::set_recv_timeout(sock_, timeout_seconds, err)) {
-        // Not fatal for connect, but keep state
-        // We still store it so future overrides know our intent
-    }
-    recv_timeout_seconds_ = timeout_seconds;
-    
+    has_connected_ = true;
+
     // Clear the input buffer
     inbuf_.clear();
 }
 
 void MessageStream::close() {
-    if (sock_ != net::INVALID_SOCKET_HANDLE) {
-        net::close(sock_);
+    if (transport_->is_open()) {
+        transport_->close();
         inbuf_.clear();
     }
 }
 
 bool MessageStream::is_connected() const {
-    return sock_ != net::INVALID_SOCKET_HANDLE;
+    return transport_->is_open();
 }
 
-void MessageStream::create_socket() {
-    // Close existing socket if any, then create a new one via utils
-    if (sock_ != net::INVALID_SOCKET_HANDLE) {
-        net::close(sock_);
-    }
-    std::string err;
-    if (!net::create_tcp_socket(sock_, err)) {
-        throw std::runtime_error("Failed to create socket: " + err);
-    }
+void MessageStream::start_capture(const std::string& path) {
+    capture_ = std::make_unique<CaptureWriter>(path);
 }
 
-void MessageStream::set_socket_timeout(int timeout_seconds) {
-    std::string err;
-    (void)net::set_recv_timeout(sock_, timeout_seconds, err);
-    recv_timeout_seconds_ = timeout_seconds;
+void MessageStream::stop_capture() {
+    capture_.reset();
 }
 
 
 void MessageStream::send_message(const std::vector<uint8_t>& data) {
-    if (sock_ == net::INVALID_SOCKET_HANDLE) throw std::runtime_error("Not connected");
-    std::string err;
-    if (!net::send_all(sock_, data, err)) {
-        throw std::runtime_error("Send failed: " + err);
+    E7_TRACE_SPAN("send", "net");
+    transport_->send(data.data(), data.size());
+    metrics_.count_sent(data.size());
+    if (capture_) {
+        capture_->write(CaptureDirection::SENT, data.data(), data.size());
     }
 }
 
@@ -99,48 +78,42 @@ void MessageStream::send_message(const ProtocolMessage& message) {
 }
 
 ProtocolMessage MessageStream::receive_message(int timeout_ms) {
-    if (sock_ == net::INVALID_SOCKET_HANDLE) throw std::runtime_error("Not connected");
-
-    // Temporarily override receive timeout using seconds resolution
-    int old_timeout = recv_timeout_seconds_;
-    int tmp_timeout_sec = (timeout_ms + 999) / 1000; // ceil to seconds
-    std::string err;
-    (void)net::set_recv_timeout(sock_, tmp_timeout_sec, err);
-    recv_timeout_seconds_ = tmp_timeout_sec;
+    return receive_view(timeout_ms).to_message();
+}
 
-    std::vector<uint8_t> out;
+ProtocolMessageView MessageStream::receive_view(int timeout_ms) {
+    E7_TRACE_SPAN("receive", "net");
+    if (!transport_->is_open()) throw std::runtime_error("Not connected");
 
     // Try extracting if already buffered
-    if (try_extract_one_packet(out)) {
-        // Restore old timeout and return
-        (void)net::set_recv_timeout(sock_, old_timeout, err);
-        recv_timeout_seconds_ = old_timeout;
-        return parse_protocol_packet(out);
+    if (try_extract_one_packet(rx_frame_)) {
+        return ProtocolMessageView(rx_frame_);
     }
 
-    // Keep reading until a full packet is available or timeout hits
+    // Keep reading until a full packet is available or timeout hits.
+    // Bytes are received straight into the tail of inbuf_.
     const size_t READ_CHUNK = 4096;
-    std::vector<uint8_t> tmp;
-    tmp.resize(READ_CHUNK);
+    std::string err;
 
     while (true) {
-        int n = net::recv_some(sock_, tmp.data(), READ_CHUNK, err);
+        size_t buffered = inbuf_.size();
+        inbuf_.resize(buffered + READ_CHUNK);
+        int n = transport_->receive(inbuf_.data() + buffered, READ_CHUNK, timeout_ms, err);
+        inbuf_.resize(buffered + (n > 0 ? n : 0));
         if (n < 0) {
             // -2 => timeout; -1 => error
-            (void)net::set_recv_timeout(sock_, old_timeout, err);
-            recv_timeout_seconds_ = old_timeout;
+            if (n == -2) {
+                metrics_.count_timeout();
+            }
             throw std::runtime_error("Receive timeout or error");
         } else if (n == 0) {
-            (void)net::set_recv_timeout(sock_, old_timeout, err);
-            recv_timeout_seconds_ = old_timeout;
             throw std::runtime_error("Peer closed connection");
         }
-        inbuf_.insert(inbuf_.end(), tmp.begin(), tmp.begin() + n);
 
-        if (try_extract_one_packet(out)) {
-            (void)net::set_recv_timeout(sock_, old_timeout, err);
-            recv_timeout_seconds_ = old_timeout;
-            return parse_protocol_packet(out);
+        metrics_.count_received(static_cast<size_t>(n));
+
+        if (try_extract_one_packet(rx_frame_)) {
+            return ProtocolMessageView(rx_frame_);
         }
         // otherwise, loop to read more bytes
     }
@@ -153,7 +126,10 @@ bool MessageStream::try_extract_one_packet(std::vector<uint8_t>& out) {
         // need at least header size to proceed
         if (inbuf_.size() - i < HEADER_SIZE) {
             // drop garbage before i (if any), but keep partial header in buffer
-            if (i > 0) inbuf_.erase(inbuf_.begin(), inbuf_.begin() + i);
+            if (i > 0) {
+                metrics_.count_resync(i);
+                inbuf_.erase(inbuf_.begin(), inbuf_.begin() + i);
+            }
             return false;
         }
 
@@ -176,12 +152,22 @@ bool MessageStream::try_extract_one_packet(std::vector<uint8_t>& out) {
                 // If the full packet isn't yet buffered, wait for more bytes
                 if (inbuf_.size() - i < total_len) {
                     // keep what's before i? it's not a valid header, but i points to a plausible header start
-                    if (i > 0) inbuf_.erase(inbuf_.begin(), inbuf_.begin() + i);
+                    if (i > 0) {
+                        metrics_.count_resync(i);
+                        inbuf_.erase(inbuf_.begin(), inbuf_.begin() + i);
+                    }
                     return false;
                 }
 
                 // Extract packet
+                if (i > 0) {
+                    metrics_.count_resync(i);
+                }
+                metrics_.count_frame_received();
                 out.assign(inbuf_.begin() + i, inbuf_.begin() + i + total_len);
+                if (capture_) {
+                    capture_->write(CaptureDirection::RECEIVED, out.data(), out.size());
+                }
                 // Erase consumed bytes (including any junk before header)
                 inbuf_.erase(inbuf_.begin(), inbuf_.begin() + i + total_len);
                 return true;
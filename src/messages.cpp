@@ -11,6 +11,7 @@
 #include "e7-switcher/crypto.h"
 #include "e7-switcher/time_utils.h"
 #include "e7-switcher/logger.h"
+#include "e7-switcher/message_schemas.h"
 #include <vector>
 #include <string>
 #include <cstring>
@@ -18,9 +19,10 @@
 
 namespace e7_switcher {
 
+// Little-endian writer over a fixed caller-owned buffer
 class Writer {
 public:
-    Writer(std::vector<uint8_t>& data);
+    Writer(MutableByteSpan data);
 
     void u8(uint8_t b);
     void u16(uint16_t s);
@@ -29,88 +31,32 @@ public:
     void put(const std::string& s);
     void put(const uint8_t* d, size_t n);
     void put_constant(uint8_t b, size_t n);
+    // Write s truncated / zero-padded to exactly n bytes
+    void put_fixed(const std::string& s, size_t n);
 
 private:
     void _need(size_t n);
 
-    std::vector<uint8_t>& data_;
+    MutableByteSpan data_;
     size_t p_;
 };
 
 namespace {
 
-std::vector<uint8_t> fixed_len_str(const std::string& s, size_t n) {
-    std::vector<uint8_t> b(n, 0);
-    std::memcpy(b.data(), s.c_str(), std::min(s.length(), n));
-    return b;
+constexpr size_t LOGIN_PLAINTEXT_SIZE = 160;
+
+// Device passwords are zero-padded to 32 bytes and encrypted; only the
+// first 32 bytes of the PKCS7 ciphertext go on the wire, and those are
+// exactly the raw ECB blocks of the padded password.
+void encrypt_device_pwd(const std::vector<uint8_t>& device_pwd, std::array<uint8_t, 32>& out) {
+    std::memset(out.data(), 0, out.size());
+    std::memcpy(out.data(), device_pwd.data(), std::min(device_pwd.size(), out.size()));
+    protocol_cipher(ProtocolKey::NATIVE).encrypt_blocks(out.data(), out.data(), out.size());
 }
 
 } // namespace
 
-ProtocolMessage build_protocol_message(
-    uint16_t cmd_code,
-    int32_t session,
-    uint16_t serial,
-    uint16_t control_attr,
-    uint8_t direction,
-    uint8_t errcode,
-    int32_t user_id,
-    const std::vector<uint8_t>& payload,
-    const std::vector<uint8_t>& communication_secret_key,
-    bool is_version_2
-) {
-    // Create a header
-    std::vector<uint8_t> header(HEADER_SIZE, 0);
-    Writer w(header);
-    uint16_t total_len = payload.size() + HEADER_SIZE + CRC_TAIL_SIZE;
-
-    w.u16(MAGIC1); // [0, 2]
-    w.u16(total_len); // [2, 4]
-    uint16_t version = is_version_2 ? PROTO_VER_2 : PROTO_VER_3;
-    w.u16(version); // [4, 6]
-    w.u16(cmd_code); // [6, 8]
-    w.u32(session); // [8, 12]
-    w.u16(serial); // [12, 14]
-    w.u8(direction); // [14, 15]
-    w.u8(errcode); // [15, 16]
-    w.u16(control_attr); // [16, 18]
-    w.u32(user_id); // [18, 22]
-    w.put_constant(0, 2); // [22, 24] user id is encoded with 6 bytes
-    uint32_t ts = now_unix();
-    w.u32(ts); // [24, 28]
-    w.put_constant(0, 10); // [28, 38] reserved
-    w.u16(MAGIC2); // [38, 40]
-
-    // Create the full packet for CRC calculation
-    std::vector<uint8_t> packet = header;
-    if (!payload.empty()) {
-        packet.insert(packet.end(), payload.begin(), payload.end());
-    }
-
-    // Calculate CRC
-    std::vector<uint8_t> crc = get_complete_legal_crc(packet, communication_secret_key);
-
-    // Create and populate the ProtocolMessage
-    ProtocolMessage message;
-    message.start_flag = MAGIC1;
-    message.length = total_len;
-    message.version = version;
-    message.cmd = cmd_code;
-    message.session = session;
-    message.serial = serial;
-    message.direction = direction;
-    message.err_code = errcode;
-    message.control_attr = control_attr;
-    message.user_id = user_id;
-    message.timestamp = ts;
-    message.raw_header = header;
-    message.payload = payload;
-    message.crc = crc;
-
-    return message;
-}
-
-Writer::Writer(std::vector<uint8_t>& data) : data_(data), p_(0) {}
+Writer::Writer(MutableByteSpan data) : data_(data), p_(0) {}
 
 void Writer::u8(uint8_t b) {
     _need(1);
@@ -153,13 +99,183 @@ void Writer::put_constant(uint8_t b, size_t n) {
     p_ += n;
 }
 
+void Writer::put_fixed(const std::string& s, size_t n) {
+    _need(n);
+    size_t len = std::min(s.size(), n);
+    std::memcpy(data_.data() + p_, s.data(), len);
+    std::memset(data_.data() + p_ + len, 0, n - len);
+    p_ += n;
+}
+
 void Writer::_need(size_t n) {
     if (p_ + n > data_.size()) {
         throw std::out_of_range("Not enough room in buffer");
     }
 }
 
-ProtocolMessage build_login_message(
+FrameBuilder::FrameBuilder(std::vector<uint8_t>& frame)
+    : frame_(frame), p_(0), crc_p_(0), crc_(CRC_SEED), timestamp_(0) {}
+
+void FrameBuilder::begin(
+    uint16_t cmd_code,
+    int32_t session,
+    uint16_t serial,
+    uint16_t control_attr,
+    uint8_t direction,
+    uint8_t errcode,
+    int32_t user_id,
+    size_t payload_len,
+    bool is_version_2
+) {
+    size_t total_len = payload_len + HEADER_SIZE + CRC_TAIL_SIZE;
+    if (total_len > 0xFFFF) {
+        throw std::length_error("Frame too large");
+    }
+    frame_.resize(total_len);
+    p_ = 0;
+    crc_p_ = 0;
+    crc_ = CRC_SEED;
+
+    u16(MAGIC1); // [0, 2]
+    u16(total_len); // [2, 4]
+    u16(is_version_2 ? PROTO_VER_2 : PROTO_VER_3); // [4, 6]
+    u16(cmd_code); // [6, 8]
+    u32(session); // [8, 12]
+    u16(serial); // [12, 14]
+    u8(direction); // [14, 15]
+    u8(errcode); // [15, 16]
+    u16(control_attr); // [16, 18]
+    u32(user_id); // [18, 22]
+    put_constant(0, 2); // [22, 24] user id is encoded with 6 bytes
+    timestamp_ = now_unix();
+    u32(timestamp_); // [24, 28]
+    put_constant(0, 10); // [28, 38] reserved
+    u16(MAGIC2); // [38, 40]
+}
+
+void FrameBuilder::u8(uint8_t b) {
+    _need(1);
+    frame_[p_++] = (b & 0xFF);
+    _fold_crc();
+}
+
+void FrameBuilder::u16(uint16_t s) {
+    _need(2);
+    frame_[p_++] = s & 0xFF;
+    frame_[p_++] = (s >> 8) & 0xFF;
+    _fold_crc();
+}
+
+void FrameBuilder::u32(uint32_t i) {
+    _need(4);
+    frame_[p_++] = i & 0xFF;
+    frame_[p_++] = (i >> 8) & 0xFF;
+    frame_[p_++] = (i >> 16) & 0xFF;
+    frame_[p_++] = (i >> 24) & 0xFF;
+    _fold_crc();
+}
+
+void FrameBuilder::put(const std::vector<uint8_t>& d) {
+    put(d.data(), d.size());
+}
+
+void FrameBuilder::put(const std::string& s) {
+    put(reinterpret_cast<const uint8_t*>(s.data()), s.size());
+}
+
+void FrameBuilder::put(const uint8_t* d, size_t n) {
+    _need(n);
+    if (n > 0) {
+        std::memcpy(frame_.data() + p_, d, n);
+    }
+    p_ += n;
+    _fold_crc();
+}
+
+void FrameBuilder::put_constant(uint8_t b, size_t n) {
+    _need(n);
+    std::memset(frame_.data() + p_, b, n);
+    p_ += n;
+    _fold_crc();
+}
+
+void FrameBuilder::put_fixed(const std::string& s, size_t n) {
+    _need(n);
+    size_t len = std::min(s.size(), n);
+    std::memcpy(frame_.data() + p_, s.data(), len);
+    std::memset(frame_.data() + p_ + len, 0, n - len);
+    p_ += n;
+    _fold_crc();
+}
+
+uint8_t* FrameBuilder::reserve(size_t n) {
+    _fold_crc();
+    _need(n);
+    uint8_t* out = frame_.data() + p_;
+    p_ += n;
+    return out;
+}
+
+void FrameBuilder::finish(const SessionCrc& session_crc) {
+    if (p_ + CRC_TAIL_SIZE != frame_.size()) {
+        throw std::logic_error("Frame payload does not match its declared length");
+    }
+    _fold_crc();
+    session_crc.write_tail(crc_, frame_.data() + p_);
+    p_ += CRC_TAIL_SIZE;
+}
+
+void FrameBuilder::_need(size_t n) {
+    if (p_ + n + CRC_TAIL_SIZE > frame_.size()) {
+        throw std::out_of_range("Not enough room in buffer");
+    }
+}
+
+void FrameBuilder::_fold_crc() {
+    crc_ = crc_hqx(frame_.data() + crc_p_, p_ - crc_p_, crc_);
+    crc_p_ = p_;
+}
+
+void build_protocol_frame(
+    std::vector<uint8_t>& frame,
+    uint16_t cmd_code,
+    int32_t session,
+    uint16_t serial,
+    uint16_t control_attr,
+    uint8_t direction,
+    uint8_t errcode,
+    int32_t user_id,
+    const uint8_t* payload,
+    size_t payload_len,
+    const SessionCrc& session_crc,
+    bool is_version_2
+) {
+    FrameBuilder fb(frame);
+    fb.begin(cmd_code, session, serial, control_attr, direction, errcode, user_id, payload_len, is_version_2);
+    fb.put(payload, payload_len);
+    fb.finish(session_crc);
+}
+
+ProtocolMessage build_protocol_message(
+    uint16_t cmd_code,
+    int32_t session,
+    uint16_t serial,
+    uint16_t control_attr,
+    uint8_t direction,
+    uint8_t errcode,
+    int32_t user_id,
+    const std::vector<uint8_t>& payload,
+    const SessionCrc& session_crc,
+    bool is_version_2
+) {
+    std::vector<uint8_t> frame;
+    build_protocol_frame(frame, cmd_code, session, serial, control_attr, direction, errcode,
+                         user_id, payload.data(), payload.size(), session_crc, is_version_2);
+    return parse_protocol_packet(frame);
+}
+
+void build_login_frame(
+    std::vector<uint8_t>& frame,
     const std::string& account,
     const std::string& password
 ) {
@@ -168,8 +284,25 @@ ProtocolMessage build_login_message(
     uint8_t errcode = 0;
     uint16_t control_attr = 0x0100;
 
-    std::vector<uint8_t> buf(160, 0);
-    Writer w(buf);
+    AesEcbCipher& cipher = protocol_cipher(ProtocolKey::V2_50);
+    size_t encrypted_len = AesEcbCipher::padded_size(LOGIN_PLAINTEXT_SIZE);
+
+    FrameBuilder fb(frame);
+    fb.begin(
+        CMD_LOGIN,     // cmd_code
+        0,             // session
+        serial,        // serial
+        control_attr,  // control_attr
+        direction,     // direction
+        errcode,       // errcode
+        0,             // user_id
+        encrypted_len, // payload length
+        true           // is_version_2
+    );
+
+    // The plaintext is written straight into the frame and encrypted in place
+    MutableByteSpan buf(fb.reserve(encrypted_len), encrypted_len);
+    Writer w(buf.subspan(0, LOGIN_PLAINTEXT_SIZE));
 
     w.u8(1);
     w.put(DEFAULT_BUILD_VERSION, 16);
@@ -184,11 +317,8 @@ ProtocolMessage build_login_message(
     // IP address is not used in the python code, so we can leave it as 0
     w.u32(0);
     w.u8(3);
-    std::vector<uint8_t> acc_b = fixed_len_str(account, 32);
-    w.put(acc_b);
-    
-    std::vector<uint8_t> pwd_b = fixed_len_str(password, 32);
-    w.put(pwd_b);
+    w.put_fixed(account, 32);
+    w.put_fixed(password, 32);
     
     w.u32(0); // user id
     int32_t ts = java_bug_seconds_from_now();
@@ -196,29 +326,18 @@ ProtocolMessage build_login_message(
     w.put_constant(0, 32);
     w.put_constant(0x0A, 10);
 
-    std::vector<uint8_t> encrypted = encrypt_to_hex_ecb_pkcs7(buf, AES_KEY_2_50);
-
-    // Use the new build_protocol_message function
-    return build_protocol_message(
-        CMD_LOGIN,      // cmd_code
-        0,              // session
-        serial,         // serial
-        control_attr,   // control_attr
-        direction,      // direction
-        errcode,        // errcode
-        0,              // user_id
-        encrypted,      // payload
-        {},             // communication_secret_key
-        true            // is_version_2
-    );
+    cipher.encrypt_in_place(buf, LOGIN_PLAINTEXT_SIZE);
+    fb.finish(SessionCrc()); // no key before login
 }
 
-ProtocolMessage build_device_list_message(
+void build_device_list_frame(
+    std::vector<uint8_t>& frame,
     int32_t session_id,
     int32_t user_id,
-    const std::vector<uint8_t>& communication_secret_key
+    const SessionCrc& session_crc
 ) {
-    return build_protocol_message(
+    FrameBuilder fb(frame);
+    fb.begin(
         CMD_DEVICE_LIST,  // cmd_code
         session_id,       // session
         1102,             // serial
@@ -226,71 +345,56 @@ ProtocolMessage build_device_list_message(
         1,                // direction
         0,                // errcode
         user_id,          // user_id
-        {},               // payload (empty)
-        communication_secret_key, // communication_secret_key
-        false             // is_version_2
+        0                 // payload (empty)
     );
+    fb.finish(session_crc);
 }
 
-ProtocolMessage build_switch_control_message(
+void build_switch_control_frame(
+    std::vector<uint8_t>& frame,
     int32_t session_id,
     int32_t user_id,
-    const std::vector<uint8_t>& communication_secret_key,
+    const SessionCrc& session_crc,
     int32_t device_id,
     const std::vector<uint8_t>& device_pwd,
     int on_or_off,
     int operation_time
 ) {
-    auto& logger = e7_switcher::Logger::instance();
-    logger.debugf("Building device control packet for device %d", device_id);
-    std::vector<uint8_t> buf(49, 0);
-    Writer w(buf);
-
-    w.u32(device_id);
-    w.u32(user_id);
-    
-    std::vector<uint8_t> padded_pwd = device_pwd;
-    padded_pwd.resize(32, 0);
-    std::vector<uint8_t> encrypted_pwd = encrypt_to_hex_ecb_pkcs7(padded_pwd, AES_KEY_NATIVE);
-    encrypted_pwd.resize(32);
-    w.put(encrypted_pwd);
-
-    w.u8(0x0A);
-    w.u8(0x06);
-    w.u8(0x00);
-    w.u8(0x01); // line_type
-    w.u8(on_or_off);
-    w.u32(operation_time); // closing time in minutes
-    
-    auto message = build_protocol_message(
-        CMD_DEVICE_CONTROL, // cmd_code
-        session_id,         // session
-        1104,               // serial
-        0,                  // control_attr
-        1,                  // direction
-        0,                  // errcode
-        user_id,            // user_id
-        buf,                // payload
-        communication_secret_key, // communication_secret_key
-        false               // is_version_2
+    E7_LOG_DEBUG("Building device control packet for device %d", device_id);
+
+    SwitchControlPayload payload;
+    payload.device_id = device_id;
+    payload.user_id = user_id;
+    encrypt_device_pwd(device_pwd, payload.encrypted_pwd);
+    payload.on_or_off = on_or_off;
+    payload.operation_time = operation_time;
+
+    FrameBuilder fb(frame);
+    fb.begin(
+        CMD_DEVICE_CONTROL,          // cmd_code
+        session_id,                  // session
+        1104,                        // serial
+        0,                           // control_attr
+        1,                           // direction
+        0,                           // errcode
+        user_id,                     // user_id
+        schema::SwitchControl::size  // payload length
     );
-    
-    logger.debugf("Built device control packet for device %d", device_id);
-    return message;
+    schema::SwitchControl::encode(payload, fb.reserve(schema::SwitchControl::size));
+    fb.finish(session_crc);
+
+    E7_LOG_DEBUG("Built device control packet for device %d", device_id);
 }
 
-ProtocolMessage build_device_query_message(
+void build_device_query_frame(
+    std::vector<uint8_t>& frame,
     int32_t session_id,
     int32_t user_id,
-    const std::vector<uint8_t>& communication_secret_key,
+    const SessionCrc& session_crc,
     int32_t device_id
 ) {
-    std::vector<uint8_t> buf(4, 0);
-    Writer w(buf);
-
-    w.u32(device_id);
-    
-    return build_protocol_message(
+    FrameBuilder fb(frame);
+    fb.begin(
         CMD_DEVICE_QUERY,  // cmd_code
         session_id,        // session
         1104,              // serial
@@ -298,27 +402,24 @@ ProtocolMessage build_device_query_message(
         1,                 // direction
         0,                 // errcode
         user_id,           // user_id
-        buf,               // payload
-        communication_secret_key, // communication_secret_key
-        false              // is_version_2
+        schema::DeviceQuery::size // payload length
     );
+    DeviceQueryRequest request;
+    request.device_id = device_id;
+    schema::DeviceQuery::encode(request, fb.reserve(schema::DeviceQuery::size));
+    fb.finish(session_crc);
 }
 
-ProtocolMessage build_ac_ir_config_query_message(int32_t session_id, int32_t user_id, const std::vector<uint8_t> &communication_secret_key, int32_t device_id, std::string ac_code_id)
-{
-    std::vector<uint8_t> buf(16, 0);
-    Writer w(buf);
-
-    w.u32(user_id);
-    w.u32(device_id);
-
-    // convert ac_code_id to unit8_t vector
-    std::vector<uint8_t> ac_code_id_bytes(ac_code_id.begin(), ac_code_id.end());
-    ac_code_id_bytes.resize(8, 0);
-    
-    w.put(ac_code_id_bytes);
-    
-    return build_protocol_message(
+void build_ac_ir_config_query_frame(
+    std::vector<uint8_t>& frame,
+    int32_t session_id,
+    int32_t user_id,
+    const SessionCrc& session_crc,
+    int32_t device_id,
+    const std::string& ac_code_id
+) {
+    FrameBuilder fb(frame);
+    fb.begin(
         CMD_AC_IR_CONFIG_QUERY, // cmd_code
         session_id,             // session
         1110,                   // serial
@@ -326,48 +427,108 @@ ProtocolMessage build_ac_ir_config_query_message(int32_t session_id, int32_t use
         1,                      // direction
         0,                      // errcode
         user_id,                // user_id
-        buf,                    // payload
-        communication_secret_key, // communication_secret_key
-        false                   // is_version_2
+        schema::IRConfigQuery::size // payload length
+    );
+    IRConfigQueryRequest request;
+    request.user_id = user_id;
+    request.device_id = device_id;
+    request.ac_code_id = ac_code_id;
+    schema::IRConfigQuery::encode(request, fb.reserve(schema::IRConfigQuery::size));
+    fb.finish(session_crc);
+}
+
+void build_ac_control_frame(
+    std::vector<uint8_t>& frame,
+    int32_t session_id,
+    int32_t user_id,
+    const SessionCrc& session_crc,
+    int32_t device_id,
+    const std::vector<uint8_t>& device_pwd,
+    const std::string& control_str,
+    int operation_time
+) {
+    ACControlHeader header;
+    header.device_id = device_id;
+    header.user_id = user_id;
+    encrypt_device_pwd(device_pwd, header.encrypted_pwd);
+    header.control_len = control_str.length() + 4;
+    header.operation_time = operation_time;
+
+    FrameBuilder fb(frame);
+    fb.begin(
+        CMD_DEVICE_CONTROL,                           // cmd_code
+        session_id,                                   // session
+        1111,                                         // serial
+        0,                                            // control_attr
+        1,                                            // direction
+        0,                                            // errcode
+        user_id,                                      // user_id
+        schema::ACControl::size + control_str.length() // payload length
     );
+    schema::ACControl::encode(header, fb.reserve(schema::ACControl::size));
+    fb.put(control_str);
+    fb.finish(session_crc);
+}
+
+ProtocolMessage build_login_message(
+    const std::string& account,
+    const std::string& password
+) {
+    std::vector<uint8_t> frame;
+    build_login_frame(frame, account, password);
+    return parse_protocol_packet(frame);
+}
+
+ProtocolMessage build_device_list_message(
+    int32_t session_id,
+    int32_t user_id,
+    const SessionCrc& session_crc
+) {
+    std::vector<uint8_t> frame;
+    build_device_list_frame(frame, session_id, user_id, session_crc);
+    return parse_protocol_packet(frame);
+}
+
+ProtocolMessage build_switch_control_message(
+    int32_t session_id,
+    int32_t user_id,
+    const SessionCrc& session_crc,
+    int32_t device_id,
+    const std::vector<uint8_t>& device_pwd,
+    int on_or_off,
+    int operation_time
+) {
+    std::vector<uint8_t> frame;
+    build_switch_control_frame(frame, session_id, user_id, session_crc, device_id, device_pwd, on_or_off, operation_time);
+    return parse_protocol_packet(frame);
+}
+
+ProtocolMessage build_device_query_message(
+    int32_t session_id,
+    int32_t user_id,
+    const SessionCrc& session_crc,
+    int32_t device_id
+) {
+    std::vector<uint8_t> frame;
+    build_device_query_frame(frame, session_id, user_id, session_crc, device_id);
+    return parse_protocol_packet(frame);
+}
+
+ProtocolMessage build_ac_ir_config_query_message(int32_t session_id, int32_t user_id, const SessionCrc &session_crc, int32_t device_id, std::string ac_code_id)
+{
+    std::vector<uint8_t> frame;
+    build_ac_ir_config_query_frame(frame, session_id, user_id, session_crc, device_id, ac_code_id);
+    return parse_protocol_packet(frame);
 }
 
 ProtocolMessage build_ac_control_message(int32_t session_id, int32_t user_id,
-                                              const std::vector<uint8_t> &communication_secret_key, int32_t device_id, 
+                                              const SessionCrc &session_crc, int32_t device_id,
                                               const std::vector<uint8_t> &device_pwd, const std::string &control_str,
                                               int operation_time)
 {
-    size_t buffer_length = control_str.length() + 47;
-    std::vector<uint8_t> buf(buffer_length, 0);
-    Writer w(buf);
-
-    w.u32(device_id);
-    w.u32(user_id);
-
-    std::vector<uint8_t> padded_pwd = device_pwd;
-    padded_pwd.resize(32, 0);
-    auto& logger = e7_switcher::Logger::instance();
-    
-    std::vector<uint8_t> encrypted_pwd = encrypt_to_hex_ecb_pkcs7(padded_pwd, AES_KEY_NATIVE);
-    encrypted_pwd.resize(32);
-    w.put(encrypted_pwd);
-    w.u8(1);
-    w.u16(control_str.length() + 4);
-    w.u32(operation_time);
-    w.put(control_str);
-
-    return build_protocol_message(
-        CMD_DEVICE_CONTROL,  // cmd_code
-        session_id,          // session
-        1111,                // serial
-        0,                   // control_attr
-        1,                   // direction
-        0,                   // errcode
-        user_id,             // user_id
-        buf,                 // payload
-        communication_secret_key, // communication_secret_key
-        false                // is_version_2
-    );
+    std::vector<uint8_t> frame;
+    build_ac_control_frame(frame, session_id, user_id, session_crc, device_id, device_pwd, control_str, operation_time);
+    return parse_protocol_packet(frame);
 }
 
 } // namespace e7_switcher
@@ -0,0 +1,180 @@
+#include "e7-switcher/metrics.h"
+#include "e7-switcher/constants.h"
+#include <exception>
+
+namespace e7_switcher {
+
+namespace {
+
+// Linear sub-buckets per power of two (above the first 32 exact values)
+constexpr size_t SUB_BUCKETS = 16;
+
+struct CommandInfo {
+    uint16_t code;
+    const char* name;
+};
+
+constexpr CommandInfo COMMANDS[Metrics::COMMAND_COUNT] = {
+    {CMD_LOGIN, "login"},
+    {CMD_DEVICE_LIST, "device_list"},
+    {CMD_DEVICE_CONTROL, "device_control"},
+    {CMD_DEVICE_QUERY, "device_query"},
+    {CMD_AC_IR_CONFIG_QUERY, "ac_ir_config_query"},
+};
+
+int command_index(uint16_t command) {
+    for (size_t i = 0; i < Metrics::COMMAND_COUNT; ++i) {
+        if (COMMANDS[i].code == command) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+int floor_log2(uint32_t v) {
+    int r = 0;
+    while (v >>= 1) ++r;
+    return r;
+}
+
+} // namespace
+
+// --- LatencyHistogram -----------------------------------------------------------
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+size_t LatencyHistogram::bucket_of(uint32_t micros) {
+    if (micros < 2 * SUB_BUCKETS) {
+        return micros;
+    }
+    // keep the top 5 bits: 1xxxx, i.e. 16..31 after the shift
+    int shift = floor_log2(micros) - 4;
+    return static_cast<size_t>(shift) * SUB_BUCKETS + (micros >> shift);
+}
+
+uint32_t LatencyHistogram::bucket_upper(size_t bucket) {
+    if (bucket < 2 * SUB_BUCKETS) {
+        return static_cast<uint32_t>(bucket);
+    }
+    size_t shift = bucket / SUB_BUCKETS - 1;
+    uint64_t top = bucket % SUB_BUCKETS + SUB_BUCKETS;
+    return static_cast<uint32_t>(((top + 1) << shift) - 1);
+}
+
+void LatencyHistogram::record(uint32_t micros) {
+    counts_[bucket_of(micros)].fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(micros, std::memory_order_relaxed);
+    if (micros < min_.load(std::memory_order_relaxed)) min_.store(micros, std::memory_order_relaxed);
+    if (micros > max_.load(std::memory_order_relaxed)) max_.store(micros, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        counts_[i].fetch_add(other.counts_[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    sum_.fetch_add(other.sum_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    uint32_t other_min = other.min_.load(std::memory_order_relaxed);
+    uint32_t other_max = other.max_.load(std::memory_order_relaxed);
+    if (other_min < min_.load(std::memory_order_relaxed)) min_.store(other_min, std::memory_order_relaxed);
+    if (other_max > max_.load(std::memory_order_relaxed)) max_.store(other_max, std::memory_order_relaxed);
+}
+
+HistogramSnapshot LatencyHistogram::snapshot() const {
+    uint32_t counts[BUCKET_COUNT];
+    HistogramSnapshot s;
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        counts[i] = counts_[i].load(std::memory_order_relaxed);
+        s.count += counts[i];
+    }
+    if (s.count == 0) {
+        return s;
+    }
+    s.min_us = min_.load(std::memory_order_relaxed);
+    s.max_us = max_.load(std::memory_order_relaxed);
+    s.mean_us = static_cast<double>(sum_.load(std::memory_order_relaxed)) / s.count;
+
+    // Nearest-rank percentiles, reported as the bucket's upper bound (capped by max)
+    const double ranks[] = {0.50, 0.90, 0.99, 0.999};
+    uint32_t* out[] = {&s.p50_us, &s.p90_us, &s.p99_us, &s.p999_us};
+    uint64_t seen = 0;
+    size_t bucket = 0;
+    for (size_t r = 0; r < 4; ++r) {
+        uint64_t rank = static_cast<uint64_t>(ranks[r] * s.count + 0.999999);
+        if (rank == 0) rank = 1;
+        while (seen + counts[bucket] < rank) {
+            seen += counts[bucket++];
+        }
+        uint32_t upper = bucket_upper(bucket);
+        *out[r] = upper < s.max_us ? upper : s.max_us;
+    }
+    return s;
+}
+
+void LatencyHistogram::reset() {
+    for (auto& c : counts_) c.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    min_.store(UINT32_MAX, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+// --- Metrics --------------------------------------------------------------------
+
+void Metrics::record_operation(uint16_t command, uint32_t micros, bool ok) {
+    int i = command_index(command);
+    if (i < 0) {
+        return;
+    }
+    if (ok) {
+        latency_[i].record(micros);
+    } else {
+        add(failures_[i], 1);
+    }
+}
+
+MetricsSnapshot Metrics::snapshot() const {
+    MetricsSnapshot s;
+    s.commands.reserve(COMMAND_COUNT);
+    for (size_t i = 0; i < COMMAND_COUNT; ++i) {
+        CommandMetrics c;
+        c.command = COMMANDS[i].code;
+        c.name = COMMANDS[i].name;
+        c.latency = latency_[i].snapshot();
+        c.failures = failures_[i].load(std::memory_order_relaxed);
+        s.commands.push_back(std::move(c));
+    }
+    s.bytes_sent = bytes_sent_.load(std::memory_order_relaxed);
+    s.bytes_received = bytes_received_.load(std::memory_order_relaxed);
+    s.frames_sent = frames_sent_.load(std::memory_order_relaxed);
+    s.frames_received = frames_received_.load(std::memory_order_relaxed);
+    s.resyncs = resyncs_.load(std::memory_order_relaxed);
+    s.bytes_skipped = bytes_skipped_.load(std::memory_order_relaxed);
+    s.timeouts = timeouts_.load(std::memory_order_relaxed);
+    s.reconnects = reconnects_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void Metrics::reset() {
+    for (auto& h : latency_) h.reset();
+    for (auto& f : failures_) f.store(0, std::memory_order_relaxed);
+    for (auto* c : {&bytes_sent_, &bytes_received_, &frames_sent_, &frames_received_, &resyncs_,
+                    &bytes_skipped_, &timeouts_, &reconnects_}) {
+        c->store(0, std::memory_order_relaxed);
+    }
+}
+
+// --- ScopedOperation ------------------------------------------------------------
+
+ScopedOperation::ScopedOperation(Metrics& metrics, uint16_t command)
+    : metrics_(metrics),
+      command_(command),
+      exceptions_(std::uncaught_exceptions()),
+      start_(std::chrono::steady_clock::now()) {}
+
+ScopedOperation::~ScopedOperation() {
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_);
+    uint64_t us = static_cast<uint64_t>(elapsed.count());
+    metrics_.record_operation(command_, us > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(us),
+                              std::uncaught_exceptions() == exceptions_);
+}
+
+} // namespace e7_switcher
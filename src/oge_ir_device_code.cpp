@@ -26,6 +26,26 @@ std::optional<std::string> OgeIRDeviceCode::swing_token_for(int swing) {
     return std::nullopt;
 }
 
+// --- Lazy key source -------------------------------------------------------
+const IRKey* IRKeySource::at(size_t i) {
+    Entry& e = entries[i];
+    if (!e.decoded) {
+        e.decoded.reset(new IRKey());
+        parse_ir_key_json(ByteSpan(json.data() + e.offset, e.length), *e.decoded);
+    }
+    return e.decoded.get();
+}
+const IRKey* IRKeySource::find(const std::string& key) {
+    auto it = by_key.find(key);
+    return it == by_key.end() ? nullptr : at(it->second);
+}
+const IRKey* IRKeySource::first_containing(const std::string& token) {
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].key.find(token) != std::string::npos) return at(i);
+    }
+    return nullptr;
+}
+
 // --- Index helpers ---------------------------------------------------------
 void OgeIRDeviceCode::ensure_index() const {
     if (!index.empty()) return;
@@ -34,7 +54,20 @@ void OgeIRDeviceCode::ensure_index() const {
 const IRKey* OgeIRDeviceCode::code_by_key(const std::string& key) const {
     ensure_index();
     auto it = index.find(key);
-    return it == index.end() ? nullptr : it->second;
+    if (it != index.end()) return it->second;
+    if (lazy_keys) {
+        // remember decoded keys (and misses are cheap: one hash lookup)
+        if (const IRKey* k = lazy_keys->find(key)) return index.emplace(key, k).first->second;
+    }
+    return nullptr;
+}
+void OgeIRDeviceCode::materialize_keys() {
+    if (!lazy_keys) return;
+    ir_key_list.clear();
+    ir_key_list.reserve(lazy_keys->entries.size());
+    for (size_t i = 0; i < lazy_keys->entries.size(); ++i) ir_key_list.push_back(*lazy_keys->at(i));
+    lazy_keys.reset();
+    index.clear();
 }
 
 // --- Logic -----------------------------------------------------------------
@@ -50,6 +83,7 @@ const IRKey* OgeIRDeviceCode::ir_code() const {
         if (auto* b = code_by_key(*m)) return b;
 
         for (const auto& k : ir_key_list) if (k.key.find(*m) != std::string::npos) return &k;
+        if (lazy_keys) return lazy_keys->first_containing(*m);
         return nullptr;
     } catch (...) { return nullptr; }
 }
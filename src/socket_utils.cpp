@@ -13,6 +13,7 @@
   #include <sys/types.h>
   #include <sys/socket.h>
   #include <netinet/in.h>
+  #include <netinet/tcp.h>
   #include <arpa/inet.h>
   #include <unistd.h>
   #include <fcntl.h>
@@ -217,6 +218,58 @@ bool connect(SocketHandle& out, const std::string& host, int port, int timeout_m
     return false;
 }
 
+bool listen_tcp(SocketHandle& out, const std::string& host, int port, int backlog, std::string& err) {
+    out = INVALID_SOCKET_HANDLE;
+    struct sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)port);
+    if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) { err = "invalid IPv4 address: " + host; return false; }
+
+    SocketHandle h;
+    if (!create_tcp_socket(h, err)) return false;
+    SysSocket s = to_sys(h);
+    int yes = 1;
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (const char*)&yes, sizeof(yes));
+    if (::bind(s, (struct sockaddr*)&addr, sizeof(addr)) != 0 || ::listen(s, backlog) != 0) {
+        err = last_error_string();
+        close(h);
+        return false;
+    }
+    out = h;
+    return true;
+}
+
+int local_port(SocketHandle h) {
+    struct sockaddr_in addr{};
+#ifdef _WIN32
+    int len = (int)sizeof(addr);
+#else
+    socklen_t len = sizeof(addr);
+#endif
+    if (getsockname(to_sys(h), (struct sockaddr*)&addr, &len) != 0) return -1;
+    return ntohs(addr.sin_port);
+}
+
+int accept(SocketHandle listener, SocketHandle& out, int timeout_ms, std::string& err) {
+    out = INVALID_SOCKET_HANDLE;
+    SysSocket ls = to_sys(listener);
+    fd_set rfds; FD_ZERO(&rfds); FD_SET(ls, &rfds);
+    struct timeval tv; tv.tv_sec = timeout_ms / 1000; tv.tv_usec = (timeout_ms % 1000) * 1000;
+    int sel = select((int)(ls + 1), &rfds, nullptr, nullptr, &tv);
+    if (sel == 0) return -2;
+    if (sel < 0) {
+#ifndef _WIN32
+        if (errno == EINTR) return -2;
+#endif
+        err = last_error_string();
+        return -1;
+    }
+    SysSocket s = ::accept(ls, nullptr, nullptr);
+    if (is_invalid_sys(s)) { err = last_error_string(); return -1; }
+    out = from_sys(s);
+    return 1;
+}
+
 void close(SocketHandle& s) {
 #ifdef _WIN32
     SysSocket ss = to_sys(s);
@@ -242,6 +295,12 @@ bool set_recv_timeout(SocketHandle h, int timeout_seconds, std::string& err) {
 #endif
 }
 
+bool set_nodelay(SocketHandle h, bool on, std::string& err) {
+    int flag = on ? 1 : 0;
+    if (setsockopt(to_sys(h), IPPROTO_TCP, TCP_NODELAY, (const char*)&flag, sizeof(flag)) != 0) { err = last_error_string(); return false; }
+    return true;
+}
+
 bool send_all(SocketHandle h, const uint8_t* data, size_t len, std::string& err) {
     size_t sent = 0;
     SysSocket s = to_sys(h);
@@ -1,17 +1,32 @@
 #include "e7-switcher/time_utils.h"
+#include <atomic>
 #include <chrono>
 
 namespace e7_switcher {
 
+namespace {
+std::atomic<uint32_t> fixed_time{0};
+}
+
 int32_t java_bug_seconds_from_now() {
+    if (uint32_t t = fixed_time.load(std::memory_order_relaxed)) {
+        return static_cast<int32_t>(t);
+    }
     auto now = std::chrono::system_clock::now();
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
     return static_cast<int32_t>(ms / 1000);
 }
 
 uint32_t now_unix() {
+    if (uint32_t t = fixed_time.load(std::memory_order_relaxed)) {
+        return t;
+    }
     auto now = std::chrono::system_clock::now();
     return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count());
 }
 
+void set_fixed_time(uint32_t unix_seconds) {
+    fixed_time.store(unix_seconds, std::memory_order_relaxed);
+}
+
 } // namespace e7_switcher
@@ -0,0 +1,113 @@
+#include "e7-switcher/tracing.h"
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+
+namespace e7_switcher {
+
+std::atomic<TraceSink*> Tracer::sink_{nullptr};
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+Clock::time_point trace_epoch() {
+    static const Clock::time_point epoch = Clock::now();
+    return epoch;
+}
+
+std::atomic<uint32_t> next_thread_id{1};
+
+// Span names are literals from this library, but keep the output valid JSON
+// whatever a custom instrumentation point passes in
+void append_json_string(std::string& out, const char* s) {
+    out += '"';
+    for (; s && *s; ++s) {
+        char c = *s;
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+            out += buf;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+} // namespace
+
+void Tracer::set_sink(TraceSink* sink) {
+    // Pin the epoch before the first span so every timestamp is non-negative
+    trace_epoch();
+    sink_.store(sink, std::memory_order_release);
+}
+
+uint64_t Tracer::now_us() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - trace_epoch()).count());
+}
+
+uint32_t Tracer::thread_id() {
+    thread_local const uint32_t id = next_thread_id.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+// --- ChromeTraceExporter ----------------------------------------------------------
+
+void ChromeTraceExporter::record(const TraceEvent& event) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.push_back(event);
+}
+
+std::string ChromeTraceExporter::to_json() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string out;
+    out.reserve(64 + events_.size() * 96);
+    out += "{\"traceEvents\":[";
+    char buf[96];
+    for (size_t i = 0; i < events_.size(); ++i) {
+        const TraceEvent& e = events_[i];
+        if (i) out += ',';
+        out += "\n{\"name\":";
+        append_json_string(out, e.name);
+        out += ",\"cat\":";
+        append_json_string(out, e.category);
+        std::snprintf(buf, sizeof(buf), ",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":1,\"tid\":%u}",
+                      static_cast<unsigned long long>(e.start_us),
+                      static_cast<unsigned long long>(e.duration_us),
+                      static_cast<unsigned>(e.thread_id));
+        out += buf;
+    }
+    out += "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return out;
+}
+
+void ChromeTraceExporter::save(const std::string& path) const {
+    std::string json = to_json();
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        throw std::runtime_error("Cannot open trace file: " + path);
+    }
+    size_t written = std::fwrite(json.data(), 1, json.size(), f);
+    bool ok = written == json.size();
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok) {
+        throw std::runtime_error("Failed to write trace file: " + path);
+    }
+}
+
+size_t ChromeTraceExporter::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return events_.size();
+}
+
+void ChromeTraceExporter::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.clear();
+}
+
+} // namespace e7_switcher
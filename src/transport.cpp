@@ -0,0 +1,52 @@
+#include "e7-switcher/transport.h"
+#include <stdexcept>
+
+namespace e7_switcher {
+
+SocketTransport::~SocketTransport() {
+    close();
+}
+
+void SocketTransport::connect(const std::string& host, int port, int timeout_seconds) {
+    std::string err;
+    if (!net::startup(err)) {
+        throw std::runtime_error("Socket startup failed: " + err);
+    }
+    // Close existing if any and connect
+    close();
+    if (!net::connect(sock_, host, port, timeout_seconds * 1000, err)) {
+        throw std::runtime_error("Connection Failed: " + err);
+    }
+    // Not fatal if this fails; receive() sets it again on the next change
+    (void)net::set_recv_timeout(sock_, timeout_seconds, err);
+    recv_timeout_seconds_ = timeout_seconds;
+}
+
+void SocketTransport::close() {
+    if (sock_ != net::INVALID_SOCKET_HANDLE) {
+        net::close(sock_);
+    }
+}
+
+bool SocketTransport::is_open() const {
+    return sock_ != net::INVALID_SOCKET_HANDLE;
+}
+
+void SocketTransport::send(const uint8_t* data, size_t len) {
+    if (sock_ == net::INVALID_SOCKET_HANDLE) throw std::runtime_error("Not connected");
+    std::string err;
+    if (!net::send_all(sock_, data, len, err)) {
+        throw std::runtime_error("Send failed: " + err);
+    }
+}
+
+int SocketTransport::receive(uint8_t* buf, size_t max_len, int timeout_ms, std::string& err) {
+    // SO_RCVTIMEO has seconds resolution here; only touch it when it changes
+    int timeout_seconds = (timeout_ms + 999) / 1000; // ceil to seconds
+    if (timeout_seconds != recv_timeout_seconds_ && net::set_recv_timeout(sock_, timeout_seconds, err)) {
+        recv_timeout_seconds_ = timeout_seconds;
+    }
+    return net::recv_some(sock_, buf, max_len, err);
+}
+
+} // namespace e7_switcher
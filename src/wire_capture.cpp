@@ -0,0 +1,179 @@
+#include "e7-switcher/wire_capture.h"
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+namespace e7_switcher {
+
+namespace {
+
+const char MAGIC[4] = {'E', '7', 'W', 'C'};
+constexpr uint16_t VERSION = 1;
+
+void put_varint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+bool get_varint(const std::vector<uint8_t>& in, size_t& pos, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+        uint8_t b = in[pos++];
+        v |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+// --- CaptureWriter ------------------------------------------------------------
+
+CaptureWriter::CaptureWriter(const std::string& path)
+    : file_(std::fopen(path.c_str(), "wb")), last_(std::chrono::steady_clock::now()) {
+    if (!file_) {
+        throw std::runtime_error("Cannot create capture file: " + path);
+    }
+    const uint8_t header[8] = {
+        static_cast<uint8_t>(MAGIC[0]), static_cast<uint8_t>(MAGIC[1]),
+        static_cast<uint8_t>(MAGIC[2]), static_cast<uint8_t>(MAGIC[3]),
+        static_cast<uint8_t>(VERSION & 0xFF), static_cast<uint8_t>(VERSION >> 8), 0, 0};
+    std::fwrite(header, 1, sizeof(header), file_);
+    std::fflush(file_);
+}
+
+CaptureWriter::~CaptureWriter() {
+    std::fclose(file_);
+}
+
+void CaptureWriter::write(CaptureDirection direction, const uint8_t* frame, size_t len) {
+    auto now = std::chrono::steady_clock::now();
+    auto delta = std::chrono::duration_cast<std::chrono::microseconds>(now - last_).count();
+    last_ = now;
+
+    std::vector<uint8_t> head;
+    head.push_back(static_cast<uint8_t>(direction));
+    put_varint(head, static_cast<uint64_t>(delta));
+    put_varint(head, len);
+    std::fwrite(head.data(), 1, head.size(), file_);
+    std::fwrite(frame, 1, len, file_);
+    std::fflush(file_);
+}
+
+std::vector<CaptureRecord> read_capture(const std::string& path) {
+    std::unique_ptr<std::FILE, int (*)(std::FILE*)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+    if (!file) {
+        throw std::runtime_error("Cannot open capture file: " + path);
+    }
+    std::vector<uint8_t> data;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), file.get())) > 0) {
+        data.insert(data.end(), chunk, chunk + n);
+    }
+
+    if (data.size() < 8 || std::memcmp(data.data(), MAGIC, 4) != 0) {
+        throw std::runtime_error("Not a capture file: " + path);
+    }
+    uint16_t version = static_cast<uint16_t>(data[4] | (data[5] << 8));
+    if (version != VERSION) {
+        throw std::runtime_error("Unsupported capture version " + std::to_string(version));
+    }
+
+    std::vector<CaptureRecord> records;
+    uint64_t time_us = 0;
+    size_t pos = 8;
+    while (pos < data.size()) {
+        uint8_t direction = data[pos++];
+        uint64_t delta, len;
+        if (direction > 1 || !get_varint(data, pos, delta) || !get_varint(data, pos, len) ||
+            len > data.size() - pos) {
+            throw std::runtime_error("Truncated or corrupt capture record at offset " + std::to_string(pos));
+        }
+        time_us += delta;
+        records.push_back(CaptureRecord{static_cast<CaptureDirection>(direction), time_us,
+                                        std::vector<uint8_t>(data.begin() + pos, data.begin() + pos + len)});
+        pos += len;
+    }
+    return records;
+}
+
+// --- ReplayTransport ----------------------------------------------------------
+
+ReplayTransport::ReplayTransport(std::vector<CaptureRecord> records, double speed)
+    : records_(std::move(records)), speed_(speed) {}
+
+ReplayTransport::ReplayTransport(const std::string& path, double speed)
+    : ReplayTransport(read_capture(path), speed) {}
+
+void ReplayTransport::connect(const std::string&, int, int) {
+    open_ = true;
+    next_ = 0;
+    offset_ = 0;
+    anchor(Clock::now(), 0);
+}
+
+void ReplayTransport::close() {
+    open_ = false;
+}
+
+bool ReplayTransport::is_open() const {
+    return open_;
+}
+
+void ReplayTransport::anchor(Clock::time_point now, uint64_t capture_time_us) {
+    anchor_time_ = now;
+    anchor_capture_us_ = capture_time_us;
+}
+
+void ReplayTransport::send(const uint8_t*, size_t) {
+    if (!open_) throw std::runtime_error("Not connected");
+    if (!finished() && records_[next_].direction == CaptureDirection::SENT) {
+        anchor(Clock::now(), records_[next_].time_us);
+        ++next_;
+    } else {
+        ++unexpected_sends_;
+    }
+}
+
+int ReplayTransport::receive(uint8_t* buf, size_t max_len, int timeout_ms, std::string& err) {
+    if (!open_) {
+        err = "not connected";
+        return -1;
+    }
+    if (finished()) {
+        return 0;
+    }
+    const CaptureRecord& record = records_[next_];
+    if (record.direction != CaptureDirection::RECEIVED) {
+        return -2;
+    }
+
+    if (offset_ == 0 && speed_ > 0) {
+        auto delay = std::chrono::duration<double, std::micro>((record.time_us - anchor_capture_us_) / speed_);
+        auto due = anchor_time_ + std::chrono::duration_cast<Clock::duration>(delay);
+        auto now = Clock::now();
+        if (due - now > std::chrono::milliseconds(timeout_ms)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+            return -2;
+        }
+        std::this_thread::sleep_until(due);
+    }
+
+    size_t n = record.frame.size() - offset_;
+    if (n > max_len) n = max_len;
+    std::memcpy(buf, record.frame.data() + offset_, n);
+    offset_ += n;
+    if (offset_ == record.frame.size()) {
+        anchor(Clock::now(), record.time_us);
+        offset_ = 0;
+        ++next_;
+    }
+    return static_cast<int>(n);
+}
+
+} // namespace e7_switcher
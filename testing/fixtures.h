@@ -0,0 +1,240 @@
+#pragma once
+
+// Payloads shaped like real hub traffic, shared by the benchmark suite, the
+// tests and the mock hub: device lists, IR code sets, gzip members and the
+// frames around a device query.
+
+#include "e7-switcher/constants.h"
+#include "e7-switcher/crc.h"
+#include "e7-switcher/message_schemas.h"
+#include "e7-switcher/messages.h"
+
+#include <zlib.h>
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace e7_switcher {
+namespace fixtures {
+
+// --- Bytes ---------------------------------------------------------------------
+
+// n bytes of a fixed, non-repeating pattern
+inline std::vector<uint8_t> bytes(size_t n) {
+    std::vector<uint8_t> v(n);
+    for (size_t i = 0; i < n; ++i) v[i] = static_cast<uint8_t>(i * 131 + 7);
+    return v;
+}
+
+inline const std::string& base64_alphabet() {
+    static const std::string chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    return chars;
+}
+
+// Valid base64 text of the given length (no padding)
+inline std::string base64_of_size(size_t encoded_len) {
+    std::string s(encoded_len, 'A');
+    for (size_t i = 0; i < encoded_len; ++i) s[i] = base64_alphabet()[(i * 29 + 3) % 64];
+    return s;
+}
+
+inline std::string base64_encode(const uint8_t* data, size_t len) {
+    const std::string& table = base64_alphabet();
+    std::string out;
+    out.reserve((len + 2) / 3 * 4);
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t v = static_cast<uint32_t>(data[i]) << 16;
+        if (i + 1 < len) v |= static_cast<uint32_t>(data[i + 1]) << 8;
+        if (i + 2 < len) v |= data[i + 2];
+        out += table[(v >> 18) & 0x3F];
+        out += table[(v >> 12) & 0x3F];
+        out += i + 1 < len ? table[(v >> 6) & 0x3F] : '=';
+        out += i + 2 < len ? table[v & 0x3F] : '=';
+    }
+    return out;
+}
+
+inline std::string hex_of(const std::string& s) {
+    static const char digits[] = "0123456789ABCDEF";
+    std::string out;
+    for (unsigned char c : s) {
+        out += digits[c >> 4];
+        out += digits[c & 0x0F];
+    }
+    return out;
+}
+
+// gzip member (the hub's IR config format) after `prefix` zero bytes
+inline std::vector<uint8_t> gzip(const std::string& text, size_t prefix = 0) {
+    z_stream strm{};
+    if (deflateInit2(&strm, 6, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error("deflateInit2 failed");
+    }
+    std::vector<uint8_t> out(prefix + deflateBound(&strm, text.size()) + 32);
+    strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(text.data()));
+    strm.avail_in = static_cast<uInt>(text.size());
+    strm.next_out = out.data() + prefix;
+    strm.avail_out = static_cast<uInt>(out.size() - prefix);
+    deflate(&strm, Z_FINISH);
+    out.resize(prefix + strm.total_out);
+    deflateEnd(&strm);
+    return out;
+}
+
+// --- Device list ---------------------------------------------------------------
+
+// DevList in the hub's shape, every fourth device an AC, including fields
+// the client ignores
+inline std::string device_list_json(int count) {
+    std::string s = "{\"Result\":0,\"Message\":\"ok\",\"DevList\":[";
+    for (int i = 0; i < count; ++i) {
+        if (i > 0) s += ',';
+        std::string n = std::to_string(i);
+        bool ac = i % 4 == 3;
+        s += "{\"DeviceName\":\"Device " + n + "\",\"APSSID\":\"home-net\",\"DMAC\":\"E7:00:00:00:00:" + n +
+             "\",\"DeviceType\":\"" + (ac ? "0E01" : "0F04") +
+             "\",\"FirmwareMark\":\"E7\",\"FirmwareVersion\":\"1.2." + n +
+             "\",\"OnlineStatus\":1,\"LineNo\":" + std::to_string(i % 4) +
+             ",\"LineType\":1,\"DID\":" + std::to_string(100001 + i) +
+             ",\"VisitPwd\":\"q83vEjRWeJq83vEjRWeJqw==\""
+             ",\"WorkStatus\":\"" + (ac ? "RAEBBBgSAAFNT0NLMDAwMQAAAAAAAAAAAAAAAAA=" : "SAEAAAAAAAAAAAAAAAAA") +
+             "\",\"RoomName\":\"Living room\",\"BindTime\":\"2023-01-01 00:00:00\""
+             ",\"ShareList\":[{\"UserID\":1,\"Nick\":\"a\"},{\"UserID\":2,\"Nick\":\"b\"}]"
+             ",\"Extra\":{\"Icon\":\"default\",\"Order\":" + n + "}}";
+    }
+    return s + "]}";
+}
+
+// --- IR code sets --------------------------------------------------------------
+
+// Key name tokens, in the order of ACMode 1..5, ACFanSpeed 1..4, ACSwing 0..3
+inline const std::vector<std::string>& ac_mode_tokens() {
+    static const std::vector<std::string> t = {"aa", "ad", "aw", "ar", "ah"};
+    return t;
+}
+inline const std::vector<std::string>& ac_fan_tokens() {
+    static const std::vector<std::string> t = {"f1", "f2", "f3", "f0"};
+    return t;
+}
+inline const std::vector<std::string>& ac_swing_tokens() {
+    static const std::vector<std::string> t = {"d0", "d1", "d2", "d3"};
+    return t;
+}
+
+struct IRSet {
+    // Temperatures 16 .. 16 + temperatures - 1 for every mode and fan speed
+    int temperatures = 15;
+    // Number of swing tokens per key; 0 leaves the swing part out
+    int swings = 2;
+    // Give every fifth key a Para
+    bool para = false;
+    // HexCode for a key name; a 384-digit fixed code when empty
+    std::function<std::string(const std::string&)> hex_code;
+    std::string set_id = "ELEC7022";
+    std::string protocol_para = "p";
+};
+
+// Key names as the hub lists them: "off", then <mode><temp>_<fan>[_<swing>]
+inline std::vector<std::string> ac_key_names(const IRSet& set) {
+    std::vector<std::string> names = {"off"};
+    for (const std::string& m : ac_mode_tokens()) {
+        for (int t = 16; t < 16 + set.temperatures; ++t) {
+            for (const std::string& f : ac_fan_tokens()) {
+                std::string base = m + std::to_string(t) + "_" + f;
+                if (set.swings == 0) {
+                    names.push_back(base);
+                }
+                for (int s = 0; s < set.swings; ++s) {
+                    names.push_back(base + "_" + ac_swing_tokens()[s]);
+                }
+            }
+        }
+    }
+    return names;
+}
+
+// IR config JSON in the hub's shape: metadata plus one entry per key
+inline std::string ir_set_json(const IRSet& set = IRSet()) {
+    std::string fixed_hex;
+    for (int j = 0; j < 24; ++j) fixed_hex += "0011AABBCCDDEEFF";
+
+    std::vector<std::string> names = ac_key_names(set);
+    std::string keys;
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (i > 0) keys += ',';
+        keys += "{\"Key\":\"" + names[i] + "\"";
+        if (set.para && i % 5 == 4) keys += ",\"Para\":\"38000\"";
+        keys += ",\"HexCode\":\"" + (set.hex_code ? set.hex_code(names[i]) : fixed_hex) + "\"}";
+    }
+    return "{\"BrandName\":\"Tadiran\",\"EditTime\":\"2021-05-04 10:00:00\",\"FileType\":\"IR\","
+           "\"IRDeviceType\":5,\"IRSetFeature\":\"f\",\"IRSetID\":\"" + set.set_id +
+           "\",\"IRSetStateMasks\":\"m\",\"IsReviewed\":true,\"KeyCount\":" + std::to_string(names.size()) +
+           ",\"LocalAnalysePara\":null,\"OnOffType\":0,\"Protocol\":\"NEC\",\"ProtocolPara\":\"" +
+           set.protocol_para + "\",\"IRKeyList\":[" + keys +
+           "],\"WindDirctionType\":2,\"fanSpeed\":1,\"mode\":2,\"power\":1,\"swing\":0,\"temperature\":24,"
+           "\"switchState\":0}";
+}
+
+// HexCode that compresses like a real pulse train: timing pairs repeat
+// heavily, with some pseudo-random digits in between
+inline std::string pulse_train_hex(const std::string& key) {
+    uint32_t state = 2166136261u;
+    for (unsigned char c : key) state = (state ^ c) * 16777619u;
+    std::string hex;
+    for (int c = 0; c < 280; ++c) {
+        state = state * 1103515245u + 12345u;
+        hex += "0123456789ABCDEF"[(c % 8 < 6) ? (c % 4) : ((state >> 16) & 0xF)];
+    }
+    return hex;
+}
+
+// --- Frames --------------------------------------------------------------------
+
+inline const std::vector<uint8_t>& session_key() {
+    static const std::vector<uint8_t> key = [] {
+        std::vector<uint8_t> k(32);
+        for (size_t i = 0; i < k.size(); ++i) k[i] = static_cast<uint8_t>(i * 37 + 11);
+        return k;
+    }();
+    return key;
+}
+
+// Device query response payload: prefix plus a switch that is on with a timer
+inline std::vector<uint8_t> switch_status_payload() {
+    SwitchStatus s{};
+    s.wifi_power = 72;
+    s.switch_state = true;
+    s.remaining_time = 1740;
+    s.open_time = 60;
+    s.auto_closing_time = 1800;
+    s.is_delay = true;
+
+    DeviceQueryPrefix prefix;
+    prefix.original_cmd = CMD_DEVICE_QUERY;
+    prefix.original_serial = 1234;
+    prefix.original_timestamp = 1700000000;
+    prefix.rest_len = 32 + 1 + 2 + schema::SwitchWorkStatus::size;
+    std::memcpy(prefix.device_name.data(), "Boiler", 6);
+    prefix.online_state = 1;
+    prefix.status_len = schema::SwitchWorkStatus::size;
+
+    std::vector<uint8_t> out(schema::QueryPrefix::size + schema::SwitchWorkStatus::size);
+    schema::QueryPrefix::encode(prefix, out.data());
+    schema::SwitchWorkStatus::encode(s, out.data() + schema::QueryPrefix::size);
+    return out;
+}
+
+inline std::vector<uint8_t> switch_status_frame() {
+    std::vector<uint8_t> payload = switch_status_payload();
+    std::vector<uint8_t> frame;
+    build_protocol_frame(frame, CMD_DEVICE_QUERY, 0x1234, 1234, 0, 0, 0, 0x20001, payload.data(), payload.size(),
+                         SessionCrc(session_key()));
+    return frame;
+}
+
+} // namespace fixtures
+} // namespace e7_switcher
@@ -0,0 +1,91 @@
+#pragma once
+
+// Implementations the library has since replaced, kept as the baseline the
+// benchmarks compare against and the tests check the replacements with.
+
+#include "e7-switcher/base64_decode.h"
+#include "e7-switcher/data_structures.h"
+
+#include <nlohmann/json.hpp>
+
+#include <cctype>
+#include <string>
+#include <vector>
+
+namespace e7_switcher {
+namespace reference {
+
+// The find()-based base64 decoder
+inline std::vector<unsigned char> base64_decode(std::string const& encoded_string) {
+    static const std::string base64_chars =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+        "abcdefghijklmnopqrstuvwxyz"
+        "0123456789+/";
+    auto is_base64 = [](unsigned char c) { return isalnum(c) || c == '+' || c == '/'; };
+    int in_len = encoded_string.size();
+    int i = 0;
+    int in_ = 0;
+    unsigned char char_array_4[4], char_array_3[3];
+    std::vector<unsigned char> ret;
+
+    while (in_len-- && (encoded_string[in_] != '=') && is_base64(encoded_string[in_])) {
+        char_array_4[i++] = encoded_string[in_];
+        in_++;
+        if (i == 4) {
+            for (i = 0; i < 4; i++)
+                char_array_4[i] = base64_chars.find(char_array_4[i]);
+            char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
+            char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
+            char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+            for (i = 0; i < 3; i++)
+                ret.push_back(char_array_3[i]);
+            i = 0;
+        }
+    }
+
+    if (i) {
+        for (int j = i; j < 4; j++)
+            char_array_4[j] = 0;
+        for (int j = 0; j < 4; j++)
+            char_array_4[j] = base64_chars.find(char_array_4[j]);
+        char_array_3[0] = (char_array_4[0] << 2) + ((char_array_4[1] & 0x30) >> 4);
+        char_array_3[1] = ((char_array_4[1] & 0xf) << 4) + ((char_array_4[2] & 0x3c) >> 2);
+        char_array_3[2] = ((char_array_4[2] & 0x3) << 6) + char_array_4[3];
+        for (int j = 0; j < i - 1; j++)
+            ret.push_back(char_array_3[j]);
+    }
+    return ret;
+}
+
+// Device list through a full DOM, copying each field out
+inline bool extract_device_list_dom(const std::string& json_str, std::vector<Device>& devices) {
+    using json = nlohmann::json;
+    try {
+        json j = json::parse(json_str);
+        if (!j.contains("DevList")) {
+            return false;
+        }
+        devices.clear();
+        for (const auto& item : j["DevList"]) {
+            Device dev;
+            dev.name     = item["DeviceName"].get<std::string>();
+            dev.ssid     = item["APSSID"].get<std::string>();
+            dev.mac      = item["DMAC"].get<std::string>();
+            dev.type     = item["DeviceType"].get<std::string>();
+            dev.firmware = item["FirmwareMark"].get<std::string>() + " " + item["FirmwareVersion"].get<std::string>();
+            dev.online   = item["OnlineStatus"].get<int>() == 1;
+            dev.line_no  = item["LineNo"].get<int>();
+            dev.line_type= item["LineType"].get<int>();
+            dev.did      = item["DID"].get<int>();
+            dev.visit_pwd= item["VisitPwd"].get<std::string>();
+            dev.work_status_bytes = ::base64_decode(item["WorkStatus"].get<std::string>());
+            devices.push_back(dev);
+        }
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+} // namespace reference
+} // namespace e7_switcher
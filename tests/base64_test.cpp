@@ -0,0 +1,73 @@
+// base64_decode against the find()-based decoder it replaced: random valid
+// input of every length, input cut short by padding or any other terminator,
+// and an invalid character inside a long run.
+
+#include "fixtures.h"
+#include "reference.h"
+
+#include "e7-switcher/base64_decode.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace e7_switcher;
+
+namespace {
+
+std::string random_base64(std::mt19937& rng, size_t len) {
+    std::string s(len, 'A');
+    for (char& c : s) c = fixtures::base64_alphabet()[rng() % 64];
+    return s;
+}
+
+// All three entry points agree with the reference
+void expect_matches_reference(const std::string& s) {
+    std::vector<unsigned char> expected = reference::base64_decode(s);
+
+    EXPECT_EQ(base64_decode(s), expected) << s;
+    EXPECT_EQ(base64_decoded_size(s.data(), s.size()), expected.size()) << s;
+
+    std::vector<unsigned char> buf(s.size() / 4 * 3 + 2, 0xEE);
+    buf.resize(base64_decode(s.data(), s.size(), buf.data()));
+    EXPECT_EQ(buf, expected) << s;
+}
+
+} // namespace
+
+TEST(Base64Decode, MatchesReferenceOnValidInput) {
+    std::mt19937 rng(7);
+    for (size_t len = 0; len <= 300; ++len) {
+        expect_matches_reference(random_base64(rng, len));
+    }
+}
+
+TEST(Base64Decode, StopsAtTerminatorLikeReference) {
+    std::mt19937 rng(8);
+    const char* terminators[] = {"=", "==", "!", " ", "\n", "-", "\x80", "\xff"};
+    for (size_t len = 0; len <= 300; ++len) {
+        std::string s = random_base64(rng, len);
+        for (const char* t : terminators) {
+            expect_matches_reference(s + t + random_base64(rng, 40));
+        }
+    }
+}
+
+TEST(Base64Decode, StopsAtInvalidCharacterLikeReference) {
+    std::mt19937 rng(9);
+    for (size_t len = 1; len <= 300; ++len) {
+        std::string s = random_base64(rng, len + 100);
+        s[rng() % s.size()] = '*';
+        expect_matches_reference(s);
+    }
+}
+
+TEST(Base64Decode, RoundTripsEncodedBytes) {
+    for (size_t n : {0, 1, 2, 3, 16, 31, 32, 33, 1000}) {
+        std::vector<uint8_t> data = fixtures::bytes(n);
+        std::vector<unsigned char> decoded = base64_decode(fixtures::base64_encode(data.data(), data.size()));
+        EXPECT_EQ(std::vector<uint8_t>(decoded.begin(), decoded.end()), data) << n << " bytes";
+    }
+}
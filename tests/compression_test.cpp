@@ -0,0 +1,98 @@
+// gzip decoding: decompress_data (with either E7_INFLATE_BACKEND) and
+// InflateStream return the original text, whatever the offset of the member
+// and the size of the reads, and both backends reject the same damage.
+
+#include "fixtures.h"
+
+#include "e7-switcher/compression.h"
+#include "e7-switcher/json_helpers.h"
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace e7_switcher;
+
+namespace {
+
+std::string text_of(const std::vector<uint8_t>& v) {
+    return std::string(v.begin(), v.end());
+}
+
+} // namespace
+
+TEST(DecompressData, RoundTripsIRSet) {
+    std::string json = fixtures::ir_set_json();
+    EXPECT_EQ(text_of(decompress_data(ByteSpan(fixtures::gzip(json)))), json);
+}
+
+TEST(DecompressData, HonoursOffset) {
+    std::string json = fixtures::ir_set_json();
+    std::vector<uint8_t> gz = fixtures::gzip(json, 3);
+    EXPECT_EQ(text_of(decompress_data(ByteSpan(gz), 3)), json);
+}
+
+TEST(DecompressData, RoundTripsEmptyText) {
+    EXPECT_TRUE(decompress_data(ByteSpan(fixtures::gzip(""))).empty());
+}
+
+TEST(DecompressData, IgnoresBytesAfterMember) {
+    std::string json = fixtures::ir_set_json();
+    std::vector<uint8_t> gz = fixtures::gzip(json);
+    gz.insert(gz.end(), {0, 0, 0, 0});
+    EXPECT_EQ(text_of(decompress_data(ByteSpan(gz))), json);
+}
+
+TEST(DecompressData, RejectsDamagedMember) {
+    std::vector<uint8_t> gz = fixtures::gzip(fixtures::ir_set_json());
+
+    std::vector<uint8_t> bad_crc = gz;
+    bad_crc[bad_crc.size() - 8] ^= 0xFF;
+    EXPECT_THROW(decompress_data(ByteSpan(bad_crc)), std::runtime_error);
+
+    std::vector<uint8_t> truncated(gz.begin(), gz.end() - gz.size() / 2);
+    EXPECT_THROW(decompress_data(ByteSpan(truncated)), std::runtime_error);
+
+    std::vector<uint8_t> not_gzip = gz;
+    not_gzip[0] = 0;
+    EXPECT_THROW(decompress_data(ByteSpan(not_gzip)), std::runtime_error);
+}
+
+TEST(InflateStream, MatchesDecompressDataForAnyReadSize) {
+    std::string json = fixtures::ir_set_json();
+    std::vector<uint8_t> gz = fixtures::gzip(json, 3);
+    for (size_t chunk : {1, 7, 256, 65536}) {
+        InflateStream stream(ByteSpan(gz), 3);
+        EXPECT_EQ(stream.size_hint(), json.size());
+
+        std::string out;
+        std::vector<uint8_t> buf(chunk);
+        while (size_t n = stream.read(buf.data(), buf.size())) {
+            out.append(buf.begin(), buf.begin() + n);
+        }
+        EXPECT_TRUE(stream.done());
+        EXPECT_EQ(out, json) << "reads of " << chunk;
+    }
+}
+
+TEST(InflateStream, ParsesLikeDecompressedText) {
+    fixtures::IRSet set;
+    set.para = true;
+    std::string json = fixtures::ir_set_json(set);
+    std::vector<uint8_t> gz = fixtures::gzip(json);
+
+    InflateStream stream{ByteSpan(gz)};
+    OgeIRDeviceCode streamed = parse_oge_ir_device_code(stream);
+    OgeIRDeviceCode eager = parse_oge_ir_device_code(json);
+
+    EXPECT_EQ(streamed.ir_set_id, eager.ir_set_id);
+    EXPECT_EQ(streamed.protocol_para, eager.protocol_para);
+    ASSERT_EQ(streamed.ir_key_list.size(), eager.ir_key_list.size());
+    for (size_t i = 0; i < eager.ir_key_list.size(); ++i) {
+        EXPECT_EQ(streamed.ir_key_list[i].key, eager.ir_key_list[i].key);
+        EXPECT_EQ(streamed.ir_key_list[i].para, eager.ir_key_list[i].para);
+        EXPECT_EQ(streamed.ir_key_list[i].hex_code, eager.ir_key_list[i].hex_code);
+    }
+}
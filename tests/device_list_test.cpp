@@ -0,0 +1,147 @@
+// extract_device_list against the DOM extraction it replaced: the same
+// result for hub-shaped lists, for every shape of DevList, for values get<>()
+// converted and for values it threw on. Entries lacking a field are checked
+// against false alone: the DOM version looked them up through an unchecked
+// operator[].
+
+#include "fixtures.h"
+#include "reference.h"
+
+#include "e7-switcher/json_helpers.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace e7_switcher;
+
+namespace {
+
+void expect_same_devices(const std::vector<Device>& a, const std::vector<Device>& b) {
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        const Device& x = a[i];
+        const Device& y = b[i];
+        EXPECT_EQ(x.name, y.name);
+        EXPECT_EQ(x.ssid, y.ssid);
+        EXPECT_EQ(x.mac, y.mac);
+        EXPECT_EQ(x.type, y.type);
+        EXPECT_EQ(x.firmware, y.firmware);
+        EXPECT_EQ(x.online, y.online);
+        EXPECT_EQ(x.line_no, y.line_no);
+        EXPECT_EQ(x.line_type, y.line_type);
+        EXPECT_EQ(x.did, y.did);
+        EXPECT_EQ(x.visit_pwd, y.visit_pwd);
+        EXPECT_EQ(x.work_status_bytes, y.work_status_bytes);
+    }
+}
+
+// A one-device list with `from` replaced by `to`
+std::string one_device_with(const std::string& from, const std::string& to) {
+    std::string json = fixtures::device_list_json(1);
+    size_t at = json.find(from);
+    EXPECT_NE(at, std::string::npos) << from;
+    return at == std::string::npos ? json : json.replace(at, from.size(), to);
+}
+
+bool extract(const std::string& json) {
+    std::vector<Device> devices;
+    return extract_device_list(json, devices);
+}
+
+} // namespace
+
+TEST(DeviceList, MatchesDomExtraction) {
+    for (int count : {0, 1, 4, 100, 2000}) {
+        std::string json = fixtures::device_list_json(count);
+        std::vector<Device> dom, streamed;
+        ASSERT_TRUE(reference::extract_device_list_dom(json, dom));
+        ASSERT_TRUE(extract_device_list(json, streamed));
+        expect_same_devices(streamed, dom);
+    }
+}
+
+TEST(DeviceList, ByteSpanMatchesString) {
+    std::string json = fixtures::device_list_json(8);
+    std::vector<Device> a, b;
+    ASSERT_TRUE(extract_device_list(json, a));
+    ASSERT_TRUE(extract_device_list(ByteSpan(reinterpret_cast<const uint8_t*>(json.data()), json.size()), b));
+    expect_same_devices(a, b);
+}
+
+TEST(DeviceList, ConvertsIntegersLikeDom) {
+    const char* const cases[][2] = {
+        {"\"LineNo\":0", "\"LineNo\":2.7"},
+        {"\"DID\":100001", "\"DID\":-3"},
+        {"\"OnlineStatus\":1", "\"OnlineStatus\":false"},
+        {"\"LineType\":1", "\"LineType\":true"},
+    };
+    for (const auto& c : cases) {
+        SCOPED_TRACE(c[1]);
+        std::string json = one_device_with(c[0], c[1]);
+        std::vector<Device> dom, streamed;
+        ASSERT_TRUE(reference::extract_device_list_dom(json, dom));
+        ASSERT_TRUE(extract_device_list(json, streamed));
+        expect_same_devices(streamed, dom);
+    }
+}
+
+TEST(DeviceList, RejectsMissingField) {
+    for (const char* field : {"\"DeviceName\":\"Device 0\",", ",\"DID\":100001", ",\"LineNo\":0",
+                              ",\"WorkStatus\":\"SAEAAAAAAAAAAAAAAAAA\""}) {
+        EXPECT_FALSE(extract(one_device_with(field, ""))) << field;
+    }
+    EXPECT_FALSE(extract("{\"DevList\":[{}]}"));
+}
+
+TEST(DeviceList, RejectsMistypedField) {
+    const char* const cases[][2] = {
+        {"\"DID\":100001", "\"DID\":\"100001\""},
+        {"\"DeviceName\":\"Device 0\"", "\"DeviceName\":7"},
+        {"\"DeviceName\":\"Device 0\"", "\"DeviceName\":null"},
+        {"\"DeviceName\":\"Device 0\"", "\"DeviceName\":{}"},
+        {"\"OnlineStatus\":1", "\"OnlineStatus\":null"},
+        {"\"LineType\":1", "\"LineType\":[1]"},
+    };
+    for (const auto& c : cases) {
+        std::string json = one_device_with(c[0], c[1]);
+        std::vector<Device> dom;
+        EXPECT_FALSE(reference::extract_device_list_dom(json, dom)) << c[1];
+        EXPECT_FALSE(extract(json)) << c[1];
+    }
+}
+
+// DevList as the DOM's range-for saw it: elements of an array, member
+// values of an object, nothing for null; operator[] threw on anything else
+TEST(DeviceList, MatchesDomOnListShapes) {
+    std::string list = fixtures::device_list_json(2);
+    std::string entries = list.substr(list.find('[') + 1, list.rfind(']') - list.find('[') - 1);
+    size_t second = entries.find(",{\"DeviceName\"");
+    std::string object_list = "{\"DevList\":{\"a\":" + entries.substr(0, second) + ",\"b\":" +
+                              entries.substr(second + 1) + "}}";
+
+    const std::string shapes[] = {
+        "{}", "[]", "not json", "{\"X\":[]}", "{\"DevList\":[]",
+        "{\"DevList\":[]}", "{\"DevList\":{}}", "{\"DevList\":null}",
+        "{\"DevList\":5}", "{\"DevList\":\"x\"}", "{\"DevList\":true}",
+        "{\"DevList\":[1]}", "{\"DevList\":[[]]}", "{\"DevList\":{\"a\":1}}",
+        object_list,
+    };
+    for (const std::string& json : shapes) {
+        SCOPED_TRACE(json.substr(0, 60));
+        std::vector<Device> dom, streamed = {Device()};
+        EXPECT_EQ(extract_device_list(json, streamed), reference::extract_device_list_dom(json, dom));
+        expect_same_devices(streamed, dom);
+    }
+
+    std::vector<Device> devices;
+    ASSERT_TRUE(extract_device_list(object_list, devices));
+    EXPECT_EQ(devices.size(), 2u);
+}
+
+TEST(DeviceList, AcceptsEmptyList) {
+    std::vector<Device> devices = {Device()};
+    EXPECT_TRUE(extract_device_list("{\"DevList\":[]}", devices));
+    EXPECT_TRUE(devices.empty());
+}
@@ -0,0 +1,141 @@
+// Lazy IR code sets (parse_oge_ir_device_code_lazy) against the eager
+// parser: metadata, key lookups, AC control codes over the whole command
+// grid, and materialize_keys().
+
+#include "fixtures.h"
+
+#include "e7-switcher/json_helpers.h"
+#include "e7-switcher/oge_ir_device_code.h"
+
+#include <gtest/gtest.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+using namespace e7_switcher;
+
+namespace e7_switcher {
+namespace fixtures {
+
+// For the parameter in failure messages
+void PrintTo(const IRSet& set, std::ostream* os) {
+    *os << ac_key_names(set).size() << " keys (" << set.temperatures << " temperatures, " << set.swings
+        << " swings" << (set.para ? ", Para" : "") << ")";
+}
+
+} // namespace fixtures
+} // namespace e7_switcher
+
+namespace {
+
+std::vector<uint8_t> bytes_of(const std::string& s) {
+    return std::vector<uint8_t>(s.begin(), s.end());
+}
+
+void expect_same_key(const IRKey* a, const IRKey* b) {
+    ASSERT_EQ(a == nullptr, b == nullptr);
+    if (!a) return;
+    EXPECT_EQ(a->key, b->key);
+    EXPECT_EQ(a->para, b->para);
+    EXPECT_EQ(a->hex_code, b->hex_code);
+}
+
+std::string control_code(int mode, int fan, int swing, int temp, int power, const OgeIRDeviceCode& d) {
+    try {
+        return get_ac_control_code(mode, fan, swing, temp, power, d);
+    } catch (const std::exception&) {
+        return "!";
+    }
+}
+
+class LazyIRCode : public ::testing::TestWithParam<fixtures::IRSet> {
+protected:
+    void SetUp() override {
+        json_ = fixtures::ir_set_json(GetParam());
+        eager_ = parse_oge_ir_device_code(json_);
+        lazy_ = parse_oge_ir_device_code_lazy(bytes_of(json_));
+    }
+
+    std::string json_;
+    OgeIRDeviceCode eager_;
+    OgeIRDeviceCode lazy_;
+};
+
+fixtures::IRSet ir_set(int temperatures, int swings, bool para) {
+    fixtures::IRSet set;
+    set.temperatures = temperatures;
+    set.swings = swings;
+    set.para = para;
+    return set;
+}
+
+// Test name suffix, e.g. "Keys301_Para"
+std::string ir_set_name(const ::testing::TestParamInfo<fixtures::IRSet>& info) {
+    return "Keys" + std::to_string(fixtures::ac_key_names(info.param).size()) + (info.param.para ? "_Para" : "");
+}
+
+} // namespace
+
+TEST_P(LazyIRCode, MatchesEagerMetadata) {
+    EXPECT_TRUE(lazy_.is_lazy());
+    EXPECT_TRUE(lazy_.ir_key_list.empty());
+    EXPECT_EQ(lazy_.brand_name, eager_.brand_name);
+    EXPECT_EQ(lazy_.ir_set_id, eager_.ir_set_id);
+    EXPECT_EQ(lazy_.key_count, eager_.key_count);
+    EXPECT_EQ(lazy_.protocol_para, eager_.protocol_para);
+    EXPECT_EQ(lazy_.wind_dirction_type, eager_.wind_dirction_type);
+    EXPECT_EQ(lazy_.is_reviewed, eager_.is_reviewed);
+    EXPECT_EQ(lazy_.switch_state, eager_.switch_state);
+}
+
+TEST_P(LazyIRCode, LooksUpKeysLikeEager) {
+    for (const IRKey& k : eager_.ir_key_list) {
+        SCOPED_TRACE(k.key);
+        expect_same_key(lazy_.code_by_key(k.key), eager_.code_by_key(k.key));
+    }
+    EXPECT_EQ(lazy_.code_by_key("no-such-key"), nullptr);
+}
+
+// Including commands that only resolve through the substring fallback, and
+// ones that do not resolve at all
+TEST_P(LazyIRCode, ResolvesControlCodesLikeEager) {
+    for (int mode = 0; mode <= 5; ++mode) {
+        for (int temp : {16, 24, 40}) {
+            for (int fan = 0; fan <= 4; ++fan) {
+                for (int swing = 0; swing <= 3; ++swing) {
+                    for (int power = 0; power <= 1; ++power) {
+                        EXPECT_EQ(control_code(mode, fan, swing, temp, power, lazy_),
+                                  control_code(mode, fan, swing, temp, power, eager_))
+                            << "mode " << mode << " temp " << temp << " fan " << fan << " swing " << swing
+                            << " power " << power;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_P(LazyIRCode, MaterializesEveryKey) {
+    // Decode a few first, so materialize_keys() mixes cached and fresh entries
+    lazy_.code_by_key("off");
+    lazy_.materialize_keys();
+    EXPECT_FALSE(lazy_.is_lazy());
+    ASSERT_EQ(lazy_.ir_key_list.size(), eager_.ir_key_list.size());
+    for (size_t i = 0; i < eager_.ir_key_list.size(); ++i) {
+        expect_same_key(&lazy_.ir_key_list[i], &eager_.ir_key_list[i]);
+    }
+}
+
+TEST_P(LazyIRCode, CopiesShareDecodedKeys) {
+    OgeIRDeviceCode copy = lazy_;
+    const IRKey* a = lazy_.code_by_key("off");
+    const IRKey* b = copy.code_by_key("off");
+    ASSERT_NE(a, nullptr);
+    EXPECT_EQ(a, b);
+}
+
+INSTANTIATE_TEST_SUITE_P(IRSets, LazyIRCode,
+                         ::testing::Values(ir_set(3, 0, false), ir_set(15, 0, true), ir_set(15, 2, false),
+                                           ir_set(15, 4, true)),
+                         ir_set_name);
@@ -0,0 +1,178 @@
+// The public JSON entry points (simdjson when built with E7_USE_SIMDJSON,
+// else nlohmann) give the nlohmann backend's result for hub-shaped payloads
+// and for inputs whose handling differs between parsers unless the fast path
+// is careful.
+
+#include "fixtures.h"
+
+#include "e7-switcher/json_backends.h"
+#include "e7-switcher/json_helpers.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+using namespace e7_switcher;
+using namespace e7_switcher::json_backends;
+
+namespace {
+
+ByteSpan bytes_of(const std::string& s) {
+    return ByteSpan(reinterpret_cast<const uint8_t*>(s.data()), s.size());
+}
+
+const char* const device_edge_cases[] = {
+    "{}",
+    "[]",
+    "not json",
+    "{\"DevList\":null}",
+    "{\"DevList\":[]}",
+    "{\"DevList\":[{}]}",
+    "{\"DevList\":[1,2]}",
+    "{\"DevList\":[{\"DeviceName\":null,\"LineNo\":1.5,\"DID\":\"7\",\"OnlineStatus\":true}]}",
+    "{\"DevList\":[{\"DeviceName\":\"a\",\"DeviceName\":\"b\",\"Nested\":{\"DeviceName\":\"c\"}}]}",
+    "{\"DevList\":[{\"DID\":-3,\"LineNo\":4294967295,\"DeviceName\":\"esc\\\"aped\\u00e9\"}]}",
+    "{\"DevList\":[{\"DeviceName\":\"a\"}],\"DevList\":[{\"DeviceName\":\"b\"}]}",
+    "{\"DevList\":[{\"DeviceName\":\"a\"}]} trailing",
+    "{\"DevList\":[{\"DeviceName\":\"a\"}]",
+};
+
+const char* const ir_edge_cases[] = {
+    "{}",
+    "[]",
+    "not json",
+    "{\"BrandName\":null,\"IRSetID\":\"x\"}",
+    "{\"BrandName\":5}",
+    "{\"IRDeviceType\":\"5\",\"KeyCount\":2.9,\"IsReviewed\":1}",
+    "{\"IsReviewed\":false,\"OnOffType\":null}",
+    "{\"mode\":true,\"power\":false,\"temperature\":23.7}",
+    "{\"mode\":\"2\"}",
+    "{\"fan_speed\":3,\"last_action_type\":1,\"switch_state\":1}",
+    "{\"fanSpeed\":2,\"fan_speed\":3,\"switchState\":0,\"switch_state\":1}",
+    "{\"fan_speed\":\"x\",\"fanSpeed\":2}",
+    "{\"mode\":1,\"mode\":3}",
+    "{\"IRKeyList\":null}",
+    "{\"IRKeyList\":[1,\"a\",null]}",
+    "{\"IRKeyList\":[{\"Key\":\"on\"},{\"Key\":\"off\",\"Para\":\"p\",\"HexCode\":\"00\"}]}",
+    "{\"IRKeyList\":[{\"Key\":null}]}",
+    "{\"IRKeyList\":[{\"Key\":\"a\",\"Para\":7}]}",
+    "{\"IRKeyList\":[{\"Key\":\"a\"}],\"IRKeyList\":[{\"Key\":\"b\"}]}",
+    "{\"temperature\":99999999999999999999}",
+    "{\"BrandName\":\"x\"} trailing",
+};
+
+void expect_same_devices(const std::vector<Device>& a, const std::vector<Device>& b) {
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t i = 0; i < a.size(); ++i) {
+        EXPECT_EQ(a[i].name, b[i].name);
+        EXPECT_EQ(a[i].ssid, b[i].ssid);
+        EXPECT_EQ(a[i].mac, b[i].mac);
+        EXPECT_EQ(a[i].type, b[i].type);
+        EXPECT_EQ(a[i].firmware, b[i].firmware);
+        EXPECT_EQ(a[i].online, b[i].online);
+        EXPECT_EQ(a[i].line_no, b[i].line_no);
+        EXPECT_EQ(a[i].line_type, b[i].line_type);
+        EXPECT_EQ(a[i].did, b[i].did);
+        EXPECT_EQ(a[i].visit_pwd, b[i].visit_pwd);
+        EXPECT_EQ(a[i].work_status_bytes, b[i].work_status_bytes);
+    }
+}
+
+void expect_same_ir_code(const OgeIRDeviceCode& a, const OgeIRDeviceCode& b) {
+    EXPECT_EQ(a.brand_name, b.brand_name);
+    EXPECT_EQ(a.edit_time, b.edit_time);
+    EXPECT_EQ(a.file_type, b.file_type);
+    EXPECT_EQ(a.ir_device_type, b.ir_device_type);
+    EXPECT_EQ(a.ir_set_feature, b.ir_set_feature);
+    EXPECT_EQ(a.ir_set_id, b.ir_set_id);
+    EXPECT_EQ(a.ir_set_state_masks, b.ir_set_state_masks);
+    EXPECT_EQ(a.is_reviewed, b.is_reviewed);
+    EXPECT_EQ(a.key_count, b.key_count);
+    EXPECT_EQ(a.local_analyse_para, b.local_analyse_para);
+    EXPECT_EQ(a.on_off_type, b.on_off_type);
+    EXPECT_EQ(a.protocol, b.protocol);
+    EXPECT_EQ(a.protocol_para, b.protocol_para);
+    EXPECT_EQ(a.wind_dirction_type, b.wind_dirction_type);
+    EXPECT_EQ(a.fan_speed, b.fan_speed);
+    EXPECT_EQ(a.last_action_type, b.last_action_type);
+    EXPECT_EQ(a.mode, b.mode);
+    EXPECT_EQ(a.power, b.power);
+    EXPECT_EQ(a.swing, b.swing);
+    EXPECT_EQ(a.switch_state, b.switch_state);
+    EXPECT_EQ(a.temperature, b.temperature);
+    ASSERT_EQ(a.ir_key_list.size(), b.ir_key_list.size());
+    for (size_t i = 0; i < a.ir_key_list.size(); ++i) {
+        EXPECT_EQ(a.ir_key_list[i].key, b.ir_key_list[i].key);
+        EXPECT_EQ(a.ir_key_list[i].para, b.ir_key_list[i].para);
+        EXPECT_EQ(a.ir_key_list[i].hex_code, b.ir_key_list[i].hex_code);
+    }
+}
+
+void expect_device_list_matches_nlohmann(const std::string& json) {
+    SCOPED_TRACE(json.substr(0, 80));
+    std::vector<Device> want, got;
+    bool found = extract_device_list_nlohmann(bytes_of(json), want);
+    EXPECT_EQ(extract_device_list(bytes_of(json), got), found);
+    expect_same_devices(got, want);
+}
+
+// parse_oge_ir_device_code(ByteSpan) throws where the nlohmann backend does
+void expect_ir_code_matches_nlohmann(const std::string& json) {
+    SCOPED_TRACE(json.substr(0, 80));
+    OgeIRDeviceCode want;
+    try {
+        want = parse_oge_ir_device_code_nlohmann(bytes_of(json));
+    } catch (const std::exception&) {
+        EXPECT_ANY_THROW(parse_oge_ir_device_code(bytes_of(json)));
+        return;
+    }
+    expect_same_ir_code(parse_oge_ir_device_code(bytes_of(json)), want);
+}
+
+} // namespace
+
+TEST(JsonBackends, DeviceListEdgeCases) {
+    for (const char* json : device_edge_cases) expect_device_list_matches_nlohmann(json);
+}
+
+TEST(JsonBackends, DeviceListFixtures) {
+    for (int count : {0, 10, 100, 2000}) expect_device_list_matches_nlohmann(fixtures::device_list_json(count));
+}
+
+TEST(JsonBackends, IRCodeEdgeCases) {
+    for (const char* json : ir_edge_cases) expect_ir_code_matches_nlohmann(json);
+}
+
+TEST(JsonBackends, IRCodeFixtures) {
+    fixtures::IRSet with_para;
+    with_para.para = true;
+    fixtures::IRSet no_swing;
+    no_swing.swings = 0;
+    no_swing.temperatures = 3;
+    for (const fixtures::IRSet& set : {fixtures::IRSet(), with_para, no_swing}) {
+        expect_ir_code_matches_nlohmann(fixtures::ir_set_json(set));
+    }
+}
+
+// When the fast path answers itself rather than deferring, the answer is
+// the nlohmann one
+TEST(JsonBackends, SimdjsonAgreesWhenItAnswers) {
+    if (!simdjson_enabled()) {
+        GTEST_SKIP() << "built without E7_USE_SIMDJSON";
+    }
+    for (const char* json : device_edge_cases) {
+        std::vector<Device> want, got;
+        bool found = extract_device_list_nlohmann(bytes_of(json), want);
+        if (auto answer = extract_device_list_simdjson(bytes_of(json), got)) {
+            EXPECT_EQ(*answer, found) << json;
+            expect_same_devices(got, want);
+        }
+    }
+    for (const char* json : ir_edge_cases) {
+        if (auto got = parse_oge_ir_device_code_simdjson(bytes_of(json))) {
+            SCOPED_TRACE(json);
+            expect_same_ir_code(*got, parse_oge_ir_device_code_nlohmann(bytes_of(json)));
+        }
+    }
+}
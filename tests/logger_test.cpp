@@ -0,0 +1,161 @@
+// Logging: AsyncLogger messages formatted on the writer thread read the same
+// as snprintf on the calling thread, delivery accounts for every call (BLOCK
+// loses nothing; under DROP, written + dropped adds up), and every level
+// setter keeps Logger::enabled() in step.
+
+#include "e7-switcher/async_logger.h"
+#include "e7-switcher/logger.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace e7_switcher;
+
+namespace {
+
+// Sink that only counts what reaches it
+class CountingLogger : public Logger {
+public:
+    explicit CountingLogger(std::atomic<size_t>& count) : count_(count) {}
+
+    void debug(const std::string&) override { ++count_; }
+    void info(const std::string&) override { ++count_; }
+    void warning(const std::string&) override {}
+    void error(const std::string&) override { ++count_; }
+    void set_log_level(LogLevel) override {}
+    void debugf(const char*, ...) override { ++count_; }
+    void infof(const char*, ...) override { ++count_; }
+    void warningf(const char*, ...) override {} // drop reports
+    void errorf(const char*, ...) override { ++count_; }
+
+private:
+    std::atomic<size_t>& count_;
+};
+
+// Sink that keeps the last message (the async logger always passes "%s", text)
+class RecordingLogger : public Logger {
+public:
+    explicit RecordingLogger(std::string& last) : last_(last) {}
+
+    void debug(const std::string& m) override { last_ = m; }
+    void info(const std::string& m) override { last_ = m; }
+    void warning(const std::string& m) override { last_ = m; }
+    void error(const std::string& m) override { last_ = m; }
+    void set_log_level(LogLevel) override {}
+    void debugf(const char*, ...) override {}
+    void infof(const char* format, ...) override {
+        va_list args;
+        va_start(args, format);
+        last_ = va_arg(args, const char*);
+        va_end(args);
+    }
+    void warningf(const char*, ...) override {}
+    void errorf(const char*, ...) override {}
+
+private:
+    std::string& last_;
+};
+
+template <typename... Args>
+void expect_formats_like_snprintf(const char* format, Args... args) {
+    std::string got;
+    {
+        AsyncLogger logger(std::make_unique<RecordingLogger>(got), 4);
+        logger.infof(format, args...);
+    }
+    char want[AsyncLogger::MESSAGE_SIZE];
+    std::snprintf(want, sizeof(want), format, args...);
+    EXPECT_EQ(got, want) << format;
+}
+
+void log_from_threads(Logger& logger, int threads, int per_thread) {
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&logger, per_thread] {
+            for (int i = 0; i < per_thread; ++i) {
+                logger.infof("Sending control command to device %s (did %d, seq %d)", "Living Room AC", 100042, i);
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+}
+
+} // namespace
+
+TEST(AsyncLogger, FormatsLikeSnprintf) {
+    std::string long_arg(300, 'x');
+    short s = -1234;
+    const char* none = nullptr;
+    expect_formats_like_snprintf("plain text, 100%% literal");
+    expect_formats_like_snprintf("%s %d %u %x %X %o %c", "dev", -42, 7u, 255u, 0xABCu, 8u, 'q');
+    expect_formats_like_snprintf("%hhd %hhu %hd %hu", 300, 300, 70000, 70000);
+    expect_formats_like_snprintf("%ld %lu %lld %llu", -5L, 5UL, -9000000000LL, 18000000000ULL);
+    expect_formats_like_snprintf("%zu %zd %td %jd %ju", size_t{42}, static_cast<ptrdiff_t>(-3), ptrdiff_t{-7},
+                                 intmax_t{-1}, uintmax_t{1});
+    expect_formats_like_snprintf("%5.2f|%-8.3e|%g|%+d|% d|%#x|%08.3f", 3.14159, 12345.678, 0.0001, 5, 5, 255u, -2.5);
+    expect_formats_like_snprintf("%*d|%-*d|%.*f|%*.*s|%.*s", 6, 42, 6, 42, 2, 1.23456, 8, 3, "abcdef", -1, "neg");
+    expect_formats_like_snprintf("%p %s", static_cast<void*>(&s), none);
+    expect_formats_like_snprintf("%hd %.3s %-10s|", s, "truncate", "pad");
+    expect_formats_like_snprintf("%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d", 1, 2, 3, 4, 5, 6, 7, 8, 9,
+                                 10, 11, 12, 13, 14, 15, 16, 17);
+    expect_formats_like_snprintf("%s|%s", long_arg.c_str(), "tail");
+    expect_formats_like_snprintf("%Lf|%d", 1.5L, 3); // formatted on the calling thread
+}
+
+TEST(AsyncLogger, BlockDeliversEverything) {
+    std::atomic<size_t> written{0};
+    size_t dropped;
+    {
+        AsyncLogger logger(std::make_unique<CountingLogger>(written), 256, AsyncLogPolicy::BLOCK);
+        log_from_threads(logger, 4, 50000);
+        logger.flush();
+        dropped = logger.dropped();
+    }
+    EXPECT_EQ(written.load(), 4u * 50000);
+    EXPECT_EQ(dropped, 0u);
+}
+
+TEST(AsyncLogger, DropCountsWhatItDiscards) {
+    std::atomic<size_t> written{0};
+    size_t dropped;
+    {
+        AsyncLogger logger(std::make_unique<CountingLogger>(written), 256, AsyncLogPolicy::DROP);
+        log_from_threads(logger, 4, 50000);
+        logger.flush();
+        dropped = logger.dropped();
+    } // the destructor drains whatever is left
+    EXPECT_EQ(written.load() + dropped, 4u * 50000);
+}
+
+TEST(AsyncLogger, FlushWritesEarlierMessages) {
+    std::atomic<size_t> written{0};
+    AsyncLogger logger(std::make_unique<CountingLogger>(written), 64, AsyncLogPolicy::BLOCK);
+    log_from_threads(logger, 1, 1000);
+    logger.flush();
+    EXPECT_EQ(written.load(), 1000u);
+}
+
+TEST(Logger, EveryLevelSetterUpdatesEnabled) {
+    Logger::initialize(LogLevel::INFO);
+    EXPECT_FALSE(Logger::enabled(LogLevel::DEBUG));
+    Logger::instance().set_log_level(LogLevel::DEBUG);
+    EXPECT_TRUE(Logger::enabled(LogLevel::DEBUG));
+    Logger::set_level(LogLevel::ERROR);
+    EXPECT_FALSE(Logger::enabled(LogLevel::WARNING));
+
+    Logger::initialize_async(LogLevel::INFO);
+    Logger::instance().set_log_level(LogLevel::DEBUG);
+    EXPECT_TRUE(Logger::enabled(LogLevel::DEBUG));
+
+    Logger::initialize();
+    EXPECT_FALSE(Logger::enabled(LogLevel::DEBUG));
+}
@@ -0,0 +1,92 @@
+// LatencyHistogram: every value maps to a bucket that contains it, and the
+// reported percentiles are no lower than the exact nearest-rank values and at
+// most 1/16 above them.
+
+#include "e7-switcher/metrics.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace e7_switcher;
+
+namespace {
+
+uint32_t exact_percentile(const std::vector<uint32_t>& sorted, double p) {
+    size_t rank = static_cast<size_t>(p * sorted.size() + 0.999999);
+    if (rank == 0) rank = 1;
+    return sorted[rank - 1];
+}
+
+void expect_percentiles_within_bucket(std::vector<uint32_t> values) {
+    LatencyHistogram h;
+    for (uint32_t v : values) h.record(v);
+    HistogramSnapshot s = h.snapshot();
+    std::sort(values.begin(), values.end());
+
+    EXPECT_EQ(s.count, values.size());
+    EXPECT_EQ(s.min_us, values.front());
+    EXPECT_EQ(s.max_us, values.back());
+
+    const double ps[] = {0.50, 0.90, 0.99, 0.999};
+    const uint32_t got[] = {s.p50_us, s.p90_us, s.p99_us, s.p999_us};
+    for (int i = 0; i < 4; ++i) {
+        uint32_t want = exact_percentile(values, ps[i]);
+        EXPECT_GE(got[i], want) << "p" << ps[i] * 100;
+        EXPECT_LE(got[i] - want, want / 16) << "p" << ps[i] * 100;
+    }
+}
+
+template <typename Dist>
+std::vector<uint32_t> sample(Dist dist, size_t n, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint32_t> v(n);
+    for (auto& x : v) {
+        double d = dist(rng);
+        x = d < 0 ? 0 : d > 4e9 ? 4000000000u : static_cast<uint32_t>(d);
+    }
+    return v;
+}
+
+} // namespace
+
+TEST(LatencyHistogram, BucketsTileTheRange) {
+    uint32_t previous_upper = 0;
+    for (size_t b = 0; b < LatencyHistogram::BUCKET_COUNT; ++b) {
+        uint32_t upper = LatencyHistogram::bucket_upper(b);
+        uint32_t lower = b == 0 ? 0 : previous_upper + 1;
+        ASSERT_GE(upper, lower) << "bucket " << b;
+        EXPECT_EQ(LatencyHistogram::bucket_of(lower), b);
+        EXPECT_EQ(LatencyHistogram::bucket_of(upper), b);
+        previous_upper = upper;
+    }
+    EXPECT_EQ(previous_upper, UINT32_MAX);
+}
+
+TEST(LatencyHistogram, PercentilesUniform) {
+    expect_percentiles_within_bucket(sample(std::uniform_real_distribution<double>(0, 100000), 200000, 1));
+}
+
+TEST(LatencyHistogram, PercentilesLognormal) {
+    expect_percentiles_within_bucket(sample(std::lognormal_distribution<double>(10.6, 0.6), 200000, 2));
+}
+
+TEST(LatencyHistogram, PercentilesExponential) {
+    expect_percentiles_within_bucket(sample(std::exponential_distribution<double>(1.0 / 2000), 200000, 3));
+}
+
+TEST(LatencyHistogram, PercentilesBelow32us) {
+    expect_percentiles_within_bucket(sample(std::uniform_int_distribution<uint32_t>(0, 40), 10000, 4));
+}
+
+TEST(LatencyHistogram, PercentilesSingleValue) {
+    expect_percentiles_within_bucket(std::vector<uint32_t>(100, 123457));
+}
+
+TEST(LatencyHistogram, EmptySnapshot) {
+    LatencyHistogram h;
+    EXPECT_EQ(h.snapshot().count, 0u);
+}
@@ -0,0 +1,402 @@
+// Wire format: every frame builder, the keyed CRC tail, the schema encoders,
+// in-place AES and the status/login decoders against golden bytes. The bytes
+// were produced by the baseline implementation from the same inputs: a fixed
+// session key, session, user, DID, device password and clock.
+
+#include "e7-switcher/constants.h"
+#include "e7-switcher/crc.h"
+#include "e7-switcher/crypto.h"
+#include "e7-switcher/message_schemas.h"
+#include "e7-switcher/messages.h"
+#include "e7-switcher/parser.h"
+#include "e7-switcher/time_utils.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace e7_switcher;
+
+namespace {
+
+constexpr uint32_t TIME = 1700000123; // 7bf15365 in the header
+constexpr int32_t SESSION = 0x12345678;
+constexpr int32_t USER = 4242;        // 92100000
+constexpr int32_t DID = 100042;       // ca860100
+
+// Device password "1234", zero-padded and encrypted with AES_KEY_NATIVE
+const char* const ENCRYPTED_PWD = "9ff6e1a4e4f580c95445cb878a0eb9faa436cff65fd6a8c9082a6c1049201a37";
+
+std::vector<uint8_t> pattern(size_t n, uint8_t mul, uint8_t add) {
+    std::vector<uint8_t> v(n);
+    for (size_t i = 0; i < n; ++i) v[i] = static_cast<uint8_t>(i * mul + add);
+    return v;
+}
+
+const std::vector<uint8_t>& session_key() {
+    static const std::vector<uint8_t> key = pattern(32, 7, 3);
+    return key;
+}
+
+const std::vector<uint8_t>& device_pwd() {
+    static const std::vector<uint8_t> pwd = {'1', '2', '3', '4'};
+    return pwd;
+}
+
+std::string hex(const uint8_t* p, size_t n) {
+    std::string out;
+    char buf[3];
+    for (size_t i = 0; i < n; ++i) {
+        std::snprintf(buf, sizeof(buf), "%02x", p[i]);
+        out += buf;
+    }
+    return out;
+}
+
+std::string hex(const std::vector<uint8_t>& v) {
+    return hex(v.data(), v.size());
+}
+
+std::string hex(const ProtocolMessage& m) {
+    return hex(m.raw_header) + hex(m.payload) + hex(m.crc);
+}
+
+std::vector<uint8_t> unhex(const std::string& h) {
+    std::vector<uint8_t> v;
+    for (size_t i = 0; i + 1 < h.size(); i += 2) {
+        v.push_back(static_cast<uint8_t>(std::stoi(h.substr(i, 2), nullptr, 16)));
+    }
+    return v;
+}
+
+// Device query response up to the status bytes: answering cmd 0x0301,
+// serial 1092 at TIME, device "Boiler", online
+std::vector<uint8_t> query_prefix(uint16_t status_len) {
+    std::vector<uint8_t> p = unhex("0103" "4404" "7b5e5665" "00" "3d00");
+    std::string name = "Boiler";
+    name.resize(32, '\0');
+    p.insert(p.end(), name.begin(), name.end());
+    p.push_back(1);
+    p.push_back(status_len & 0xFF);
+    p.push_back(status_len >> 8);
+    return p;
+}
+
+// AC work status: wifi 78, 23.5 degrees, on/cool/24/medium fan/swing,
+// Celsius, type 2, code ELEC7022, last 300, open 600, auto close 3600
+const char* const AC_WORK_STATUS =
+    "4e" "eb00" "01041821" "01" "02" "454c454337303232" "2c010000" "58020000" "100e0000" "00";
+
+void expect_ac_status(const ACStatus& s) {
+    EXPECT_EQ(s.wifi_power, 78);
+    EXPECT_FLOAT_EQ(s.temperature, 23.5f);
+    EXPECT_EQ(s.ac_data, unhex("01041821"));
+    EXPECT_EQ(s.power_status, ACPower::POWER_ON);
+    EXPECT_EQ(s.mode, ACMode::COOL);
+    EXPECT_EQ(s.ac_temperature, 24);
+    EXPECT_EQ(s.fan_speed, ACFanSpeed::FAN_MEDIUM);
+    EXPECT_EQ(s.swing, ACSwing::SWING_ON);
+    EXPECT_EQ(s.temperature_unit, 1);
+    EXPECT_EQ(s.device_type, 2);
+    EXPECT_EQ(s.code_id, "ELEC7022");
+    EXPECT_EQ(s.last_time, 300);
+    EXPECT_EQ(s.open_time, 600);
+    EXPECT_EQ(s.auto_closing_time, 3600);
+    EXPECT_EQ(s.is_delay, 0);
+}
+
+class WireFrames : public ::testing::Test {
+protected:
+    void SetUp() override { set_fixed_time(TIME); }
+    void TearDown() override { set_fixed_time(0); }
+};
+
+} // namespace
+
+// --- Frame builders ----------------------------------------------------------
+
+TEST_F(WireFrames, Login) {
+    EXPECT_EQ(hex(build_login_message("user@example.com", "secret")),
+        "fef0dc0002320211000000004204010000010000000000007bf1536500000000000000000000f0fe"
+        "626e81ad75043989268b61f1b596f3dde9c09ed20e5b9d98d7f3297371090e0eb154a5fd445bca4bf8d2459ceac0b97a"
+        "a7360e422d1f1e099384db8dbfe36eafb210192dfb15e3fd34e2ae7c63f2cf7a3db0d621f5ab89968e5e723441a7f9e0"
+        "287e6a68dfcb32a1785a8171f1c79df64385b55e11cb8ad60eb343e2da8b2e15287e6a68dfcb32a1785a8171f1c79df6"
+        "8e8de3db978f7097f2aa252ee53134915f1a0bd5a1e3e3b9632e1a839c4a3546"
+        "b7ec69e8");
+}
+
+TEST_F(WireFrames, DeviceList) {
+    EXPECT_EQ(hex(build_device_list_message(SESSION, USER, session_key())),
+        "fef02c0003054313785634124e04010000009210000000007bf1536500000000000000000000f0fe"
+        "d74e3f13");
+}
+
+TEST_F(WireFrames, SwitchControl) {
+    EXPECT_EQ(hex(build_switch_control_message(SESSION, USER, session_key(), DID, device_pwd(), 1, 90)),
+        "fef05d0003050102785634125004010000009210000000007bf1536500000000000000000000f0fe"
+        "ca860100" "92100000" + std::string(ENCRYPTED_PWD) + "0a060001" "01" "5a000000"
+        "e7555d12");
+    EXPECT_EQ(hex(build_switch_control_message(SESSION, USER, session_key(), DID, device_pwd(), 0)),
+        "fef05d0003050102785634125004010000009210000000007bf1536500000000000000000000f0fe"
+        "ca860100" "92100000" + std::string(ENCRYPTED_PWD) + "0a060001" "00" "00000000"
+        "26e21ada");
+}
+
+TEST_F(WireFrames, DeviceQuery) {
+    EXPECT_EQ(hex(build_device_query_message(SESSION, USER, session_key(), DID)),
+        "fef0300003050103785634125004010000009210000000007bf1536500000000000000000000f0fe"
+        "ca860100"
+        "3b989847");
+}
+
+TEST_F(WireFrames, IRConfigQuery) {
+    EXPECT_EQ(hex(build_ac_ir_config_query_message(SESSION, USER, session_key(), DID, "ELEC7022")),
+        "fef03c000305041a785634125604010000009210000000007bf1536500000000000000000000f0fe"
+        "92100000" "ca860100" "454c454337303232"
+        "6db5833c");
+}
+
+TEST_F(WireFrames, ACControl) {
+    EXPECT_EQ(hex(build_ac_control_message(SESSION, USER, session_key(), DID, device_pwd(), "01|04|24|1|0")),
+        "fef0670003050102785634125704010000009210000000007bf1536500000000000000000000f0fe"
+        "ca860100" "92100000" + std::string(ENCRYPTED_PWD) + "01" "1000" "00000000" "30317c30347c32347c317c30"
+        "15101dd0");
+}
+
+TEST_F(WireFrames, ProtocolMessage) {
+    std::vector<uint8_t> payload = pattern(21, 5, 1);
+    EXPECT_EQ(hex(build_protocol_message(0x0301, 7, 9, 0x0200, 1, 0, USER, payload, session_key())),
+        "fef0410003050103070000000900010000029210000000007bf1536500000000000000000000f0fe"
+        "01060b10151a1f24292e33383d42474c51565b6065"
+        "fe61c78e");
+    EXPECT_EQ(hex(build_protocol_message(0x0301, 7, 9, 0x0200, 1, 0, USER, payload, session_key(), true)),
+        "fef0410002320103070000000900010000029210000000007bf1536500000000000000000000f0fe"
+        "01060b10151a1f24292e33383d42474c51565b6065"
+        "73ce9398");
+}
+
+TEST_F(WireFrames, FrameBuilderWritersMatchOneShotFrame) {
+    std::vector<uint8_t> payload = pattern(21, 5, 1);
+    std::vector<uint8_t> expected;
+    build_protocol_frame(expected, 0x0301, 7, 9, 0x0200, 1, 0, USER, payload.data(), payload.size(),
+                         session_key());
+
+    std::vector<uint8_t> frame(3, 0xEE); // stale contents are overwritten
+    FrameBuilder fb(frame);
+    fb.begin(0x0301, 7, 9, 0x0200, 1, 0, USER, payload.size());
+    fb.u8(payload[0]);
+    fb.u16(static_cast<uint16_t>(payload[1] | payload[2] << 8));
+    fb.u32(static_cast<uint32_t>(payload[3] | payload[4] << 8 | payload[5] << 16 | payload[6] << 24));
+    std::memcpy(fb.reserve(4), &payload[7], 4);
+    fb.put(&payload[11], 10);
+    fb.finish(session_key());
+
+    EXPECT_EQ(hex(frame), hex(expected));
+    EXPECT_EQ(fb.timestamp(), TIME);
+}
+
+TEST_F(WireFrames, FrameBuilderRejectsWrongPayloadLength) {
+    std::vector<uint8_t> frame;
+    FrameBuilder short_fb(frame);
+    short_fb.begin(0x0301, 7, 9, 0, 1, 0, USER, 4);
+    short_fb.u16(1);
+    EXPECT_THROW(short_fb.finish(session_key()), std::logic_error);
+
+    FrameBuilder long_fb(frame);
+    long_fb.begin(0x0301, 7, 9, 0, 1, 0, USER, 4);
+    long_fb.u16(1);
+    EXPECT_THROW(long_fb.u32(2), std::out_of_range);
+}
+
+// --- CRC ----------------------------------------------------------------------
+
+TEST(SessionCrc, MatchesLegalCrc) {
+    std::vector<uint8_t> packet = pattern(61, 11, 2);
+    EXPECT_EQ(hex(get_complete_legal_crc(packet, session_key())), "84077469");
+
+    SessionCrc crc(session_key());
+    uint8_t tail[4];
+    crc.write_tail(packet.data(), packet.size(), tail);
+    EXPECT_EQ(hex(tail, 4), "84077469");
+    crc.write_tail(crc_hqx(packet.data(), packet.size(), CRC_SEED), tail);
+    EXPECT_EQ(hex(tail, 4), "84077469");
+}
+
+// --- Schema encoders -----------------------------------------------------------
+
+TEST(WireSchema, SwitchControl) {
+    SwitchControlPayload p;
+    p.device_id = DID;
+    p.user_id = USER;
+    std::vector<uint8_t> pwd = unhex(ENCRYPTED_PWD);
+    std::memcpy(p.encrypted_pwd.data(), pwd.data(), pwd.size());
+    p.on_or_off = 1;
+    p.operation_time = 90;
+
+    std::vector<uint8_t> out(schema::SwitchControl::size);
+    schema::SwitchControl::encode(p, MutableByteSpan(out.data(), out.size()));
+    EXPECT_EQ(hex(out), "ca860100" "92100000" + std::string(ENCRYPTED_PWD) + "0a060001" "01" "5a000000");
+
+    SwitchControlPayload back = schema::SwitchControl::decode<SwitchControlPayload>(out);
+    EXPECT_EQ(back.device_id, DID);
+    EXPECT_EQ(back.user_id, USER);
+    EXPECT_EQ(back.encrypted_pwd, p.encrypted_pwd);
+    EXPECT_EQ(back.on_or_off, 1);
+    EXPECT_EQ(back.operation_time, 90u);
+}
+
+TEST(WireSchema, ACControlHeader) {
+    ACControlHeader h;
+    h.device_id = DID;
+    h.user_id = USER;
+    std::vector<uint8_t> pwd = unhex(ENCRYPTED_PWD);
+    std::memcpy(h.encrypted_pwd.data(), pwd.data(), pwd.size());
+    h.control_len = 16;
+    h.operation_time = 0;
+
+    std::vector<uint8_t> out(schema::ACControl::size);
+    schema::ACControl::encode(h, out.data());
+    EXPECT_EQ(hex(out), "ca860100" "92100000" + std::string(ENCRYPTED_PWD) + "01" "1000" "00000000");
+}
+
+TEST(WireSchema, Queries) {
+    DeviceQueryRequest q;
+    q.device_id = DID;
+    std::vector<uint8_t> out(schema::DeviceQuery::size);
+    schema::DeviceQuery::encode(q, out.data());
+    EXPECT_EQ(hex(out), "ca860100");
+
+    IRConfigQueryRequest ir;
+    ir.user_id = USER;
+    ir.device_id = DID;
+    ir.ac_code_id = "ELEC7022-too-long";
+    out.assign(schema::IRConfigQuery::size, 0xEE);
+    schema::IRConfigQuery::encode(ir, out.data());
+    EXPECT_EQ(hex(out), "92100000" "ca860100" "454c454337303232");
+
+    ir.ac_code_id = "AB";
+    schema::IRConfigQuery::encode(ir, out.data());
+    EXPECT_EQ(hex(out), "92100000" "ca860100" "4142000000000000");
+    EXPECT_EQ(schema::IRConfigQuery::decode<IRConfigQueryRequest>(out).ac_code_id, "AB");
+}
+
+TEST(WireSchema, EncodeChecksRoom) {
+    DeviceQueryRequest q;
+    uint8_t out[3];
+    EXPECT_THROW(schema::DeviceQuery::encode(q, MutableByteSpan(out, sizeof(out))), std::out_of_range);
+}
+
+// --- AES ------------------------------------------------------------------------
+
+TEST(AesInPlace, MatchesGoldenCiphertext) {
+    const struct {
+        size_t len;
+        const char* ciphertext;
+    } cases[] = {
+        {0, "91a0ba09719053b2fca0aa44e2e53298"},
+        {5, "4a200fddb597732fb48931ee05d1f7d8"},
+        {16, "ad22aefac6f43431bf97ad69994f7acb" "91a0ba09719053b2fca0aa44e2e53298"},
+        {33, "ad22aefac6f43431bf97ad69994f7acb" "fdfc24bdc30a3ae760a9b7cb960d4f3e"
+             "822c321cc19be356bc5ec14a11dceea9"},
+    };
+    AesEcbCipher cipher(AES_KEY_NATIVE);
+    for (const auto& c : cases) {
+        SCOPED_TRACE(c.len);
+        std::vector<uint8_t> plaintext = pattern(c.len, 3, 9);
+        std::vector<uint8_t> buf = plaintext;
+        buf.resize(AesEcbCipher::padded_size(c.len));
+
+        size_t n = cipher.encrypt_in_place(MutableByteSpan(buf.data(), buf.size()), c.len);
+        ASSERT_EQ(n, buf.size());
+        EXPECT_EQ(hex(buf), c.ciphertext);
+        EXPECT_EQ(hex(encrypt_to_hex_ecb_pkcs7(plaintext, AES_KEY_NATIVE)), c.ciphertext);
+
+        // On desktop the padding stays in place, as it did with the baseline
+        std::vector<uint8_t> padded = plaintext;
+        padded.resize(buf.size(), static_cast<uint8_t>(buf.size() - c.len));
+        n = cipher.decrypt_in_place(MutableByteSpan(buf.data(), buf.size()));
+        ASSERT_EQ(n, buf.size());
+        EXPECT_EQ(buf, padded);
+    }
+}
+
+// --- Decoders -------------------------------------------------------------------
+
+TEST(WireDecode, SwitchStatus) {
+    std::vector<uint8_t> payload = query_prefix(15);
+    std::vector<uint8_t> status = unhex("48" "01" "10270000" "3c000000" "100e0000" "01");
+    payload.insert(payload.end(), status.begin(), status.end());
+
+    SwitchStatus s = parse_switch_status(payload);
+    EXPECT_EQ(s.wifi_power, 72);
+    EXPECT_TRUE(s.switch_state);
+    EXPECT_EQ(s.remaining_time, 10000);
+    EXPECT_EQ(s.open_time, 60);
+    EXPECT_EQ(s.auto_closing_time, 3600);
+    EXPECT_TRUE(s.is_delay);
+    EXPECT_EQ(s.online_state, 1);
+
+    payload.pop_back();
+    EXPECT_THROW(parse_switch_status(payload), std::out_of_range);
+}
+
+TEST(WireDecode, ACWorkStatus) {
+    std::vector<uint8_t> status = unhex(AC_WORK_STATUS);
+    expect_ac_status(parse_ac_status_from_work_status_bytes(status));
+
+    status.push_back(0xAA); // some firmwares send 32 bytes
+    status.push_back(0x55);
+    expect_ac_status(parse_ac_status_from_work_status_bytes(status));
+}
+
+TEST(WireDecode, ACQueryPayload) {
+    std::vector<uint8_t> payload = query_prefix(30);
+    std::vector<uint8_t> status = unhex(AC_WORK_STATUS);
+    payload.insert(payload.end(), status.begin(), status.end());
+
+    ACStatus s = parse_ac_status_from_query_payload(payload);
+    expect_ac_status(s);
+    EXPECT_EQ(s.online_state, 1);
+}
+
+TEST(WireDecode, PhoneLogin) {
+    // Head, a block length of 2 (4 bytes per block), then both blocks and the tail
+    std::vector<uint8_t> payload = pattern(78, 13, 1);
+    payload.push_back(2);
+    payload.push_back(0);
+    std::vector<uint8_t> rest = pattern(8 + 145, 29, 7);
+    payload.insert(payload.end(), rest.begin(), rest.end());
+
+    PhoneLoginRecord r = parse_phone_login(payload);
+    EXPECT_EQ(r.session_id, 672861697);
+    EXPECT_EQ(r.user_id, 1548698165);
+    EXPECT_EQ(hex(r.communication_secret_key), "697683909daab7c4d1deebf805121f2c394653606d7a8794a1aebbc8d5e2effc");
+    EXPECT_EQ(hex(r.app_secret_key), "091623303d4a5764717e8b98a5b2bfccd9e6f3000d1a2734414e5b6875828f9c");
+    EXPECT_EQ(r.comm_enc_mode, 169);
+    EXPECT_EQ(r.app_enc_mode, 182);
+    EXPECT_EQ(hex(r.server_time), "c3d0ddea");
+    EXPECT_EQ(r.block_len_bytes, 4);
+    EXPECT_EQ(hex(r.block_a), "0724415e");
+    EXPECT_EQ(hex(r.block_b), "7b98b5d2");
+    EXPECT_EQ(hex(r.gateway_domain), "ef0c294663809dbad7f4112e4b6885a2bfdcf91633506d8aa7c4e1fe1b385572");
+    EXPECT_EQ(r.gateway_port, 44175);
+    EXPECT_EQ(r.gateway_proto, 201);
+    EXPECT_EQ(hex(r.standby_gateway_domain), "e603203d5a7794b1ceeb0825425f7c99b6d3f00d2a4764819ebbd8f5122f4c69");
+    EXPECT_EQ(r.standby_gateway_port, 41862);
+    EXPECT_EQ(r.standby_gateway_proto, 192);
+    EXPECT_EQ(hex(r.tcp_server_ip), "ddfa1734");
+    EXPECT_EQ(r.tcp_server_port, 28241);
+    EXPECT_EQ(r.tcp_server_proto, 139);
+    EXPECT_EQ(r.heartbeat_secs, 50600);
+    EXPECT_EQ(r.reply_timeout_secs, 65506);
+    EXPECT_EQ(hex(r.token), "1c39567390adcae704213e5b7895b2cfec092643607d9ab7d4f10e2b4865829f");
+    EXPECT_EQ(hex(r.nickname), "bcd9f613304d6a87a4c1defb1835526f8ca9c6e3001d3a577491aecbe805223f");
+
+    payload.pop_back();
+    EXPECT_THROW(parse_phone_login(payload), std::out_of_range);
+}
@@ -0,0 +1,292 @@
+// Load generator: N client sessions driven by M threads against a hub,
+// by default an in-process e7-mock-hub. Each thread runs its sessions in a
+// closed loop, issuing a weighted mix of control_switch, get_switch_status
+// and control_ac calls, and the run ends with throughput and latency
+// percentiles per operation.
+//
+// Usage: e7-loadgen [--sessions 8] [--threads 4] [--duration-s 10] [--warmup-s 1]
+//                   [--mix control_switch=40,get_switch_status=50,control_ac=10]
+//                   [--host H --port P]  (external hub; otherwise embedded:)
+//                   [--switches 4] [--acs 2] [--latency-ms 0] [--jitter-ms 0]
+//                   [--min-ops-per-sec X] [--max-p99-ms Y] [--seed 1]
+//
+// With --min-ops-per-sec / --max-p99-ms the exit code is 1 when the run falls
+// short, so it can gate regressions.
+
+#include "mock_hub.h"
+#include "e7-switcher/e7_switcher_client.h"
+#include "e7-switcher/logger.h"
+#include "e7-switcher/metrics.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace e7_switcher;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum Op { CONTROL_SWITCH, GET_SWITCH_STATUS, CONTROL_AC, LOGIN, OP_COUNT };
+const char* const OP_NAMES[OP_COUNT] = {"control_switch", "get_switch_status", "control_ac", "login"};
+constexpr int MIXED_OPS = 3; // login is only timed, never drawn
+
+struct Config {
+    int sessions = 8;
+    int threads = 4;
+    double duration_s = 10;
+    double warmup_s = 1;
+    int weights[MIXED_OPS] = {40, 50, 10};
+    std::string host; // empty: embedded mock hub
+    int port = PORT_HUB;
+    MockHubOptions hub;
+    double min_ops_per_sec = 0;
+    double max_p99_ms = 0;
+    uint32_t seed = 1;
+};
+
+// Per-thread results; LatencyHistogram::record() is single-writer
+struct ThreadStats {
+    LatencyHistogram latency[OP_COUNT];
+    uint64_t errors[OP_COUNT] = {};
+    uint64_t replaced_sessions = 0;
+};
+
+struct Session {
+    std::unique_ptr<E7SwitcherClient> client;
+    std::vector<std::string> switches;
+    std::vector<std::string> acs;
+};
+
+[[noreturn]] void usage_error(const std::string& message) {
+    std::fprintf(stderr, "e7-loadgen: %s\n", message.c_str());
+    std::exit(2);
+}
+
+void parse_mix(const std::string& spec, int (&weights)[MIXED_OPS]) {
+    for (int& w : weights) w = 0;
+    size_t pos = 0;
+    while (pos < spec.size()) {
+        size_t comma = spec.find(',', pos);
+        std::string item = spec.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+        size_t eq = item.find('=');
+        int op = -1;
+        for (int i = 0; i < MIXED_OPS; ++i) {
+            if (eq != std::string::npos && item.substr(0, eq) == OP_NAMES[i]) op = i;
+        }
+        if (op < 0) usage_error("bad --mix entry '" + item + "'");
+        weights[op] = std::stoi(item.substr(eq + 1));
+        if (comma == std::string::npos) break;
+        pos = comma + 1;
+    }
+    if (weights[0] + weights[1] + weights[2] <= 0) usage_error("--mix has no positive weight");
+}
+
+Config parse_args(int argc, char* argv[]) {
+    Config c;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.substr(0, 2) != "--" || i + 1 >= argc) usage_error("unexpected argument " + arg);
+        std::string key = arg.substr(2);
+        std::string v = argv[++i];
+        if (key == "sessions") c.sessions = std::stoi(v);
+        else if (key == "threads") c.threads = std::stoi(v);
+        else if (key == "duration-s") c.duration_s = std::stod(v);
+        else if (key == "warmup-s") c.warmup_s = std::stod(v);
+        else if (key == "mix") parse_mix(v, c.weights);
+        else if (key == "host") c.host = v;
+        else if (key == "port") c.port = std::stoi(v);
+        else if (key == "switches") c.hub.switches = std::stoi(v);
+        else if (key == "acs") c.hub.acs = std::stoi(v);
+        else if (key == "latency-ms") c.hub.latency_ms = std::stoi(v);
+        else if (key == "jitter-ms") c.hub.jitter_ms = std::stoi(v);
+        else if (key == "min-ops-per-sec") c.min_ops_per_sec = std::stod(v);
+        else if (key == "max-p99-ms") c.max_p99_ms = std::stod(v);
+        else if (key == "seed") c.seed = static_cast<uint32_t>(std::stoul(v));
+        else usage_error("unknown option --" + key);
+    }
+    if (c.sessions < 1 || c.threads < 1) usage_error("--sessions and --threads must be positive");
+    if (c.threads > c.sessions) c.threads = c.sessions;
+    if (c.host.empty()) {
+        c.hub.port = 0;
+        c.hub.seed = c.seed;
+        if (c.hub.switches < 1 && (c.weights[CONTROL_SWITCH] || c.weights[GET_SWITCH_STATUS])) usage_error("mix needs --switches > 0");
+        if (c.hub.acs < 1 && c.weights[CONTROL_AC]) usage_error("mix needs --acs > 0");
+    }
+    return c;
+}
+
+uint32_t micros_since(Clock::time_point start) {
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+    return us > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(us);
+}
+
+void open_session(Session& s, const std::string& host, int port, ThreadStats& stats, bool record) {
+    ConnectionOptions options;
+    options.host = host;
+    options.port = port;
+    auto start = Clock::now();
+    s.client = std::make_unique<E7SwitcherClient>("loadgen", "loadgen", std::move(options));
+    s.switches.clear();
+    s.acs.clear();
+    for (const Device& d : s.client->list_devices()) {
+        if (d.type == E7SwitcherClient::DEVICE_TYPE_SWITCH) s.switches.push_back(d.name);
+        if (d.type == E7SwitcherClient::DEVICE_TYPE_AC) s.acs.push_back(d.name);
+    }
+    if (record) stats.latency[LOGIN].record(micros_since(start));
+}
+
+void run_operation(Session& s, Op op, std::mt19937& rng) {
+    auto pick = [&](const std::vector<std::string>& names) -> const std::string& {
+        if (names.empty()) throw std::runtime_error("no device of the needed type");
+        return names[rng() % names.size()];
+    };
+    switch (op) {
+    case CONTROL_SWITCH:
+        s.client->control_switch(pick(s.switches), rng() % 2 ? "on" : "off");
+        break;
+    case GET_SWITCH_STATUS:
+        (void)s.client->get_switch_status(pick(s.switches));
+        break;
+    case CONTROL_AC:
+        s.client->control_ac(pick(s.acs), rng() % 4 ? "on" : "off",
+                             static_cast<ACMode>(1 + rng() % 5), 16 + static_cast<int>(rng() % 15),
+                             static_cast<ACFanSpeed>(1 + rng() % 4), static_cast<ACSwing>(rng() % 2));
+        break;
+    default:
+        break;
+    }
+}
+
+// One thread: opens its share of the sessions, then cycles through them
+void worker(const Config& c, const std::string& host, int port, int index, Clock::time_point measure_from,
+            Clock::time_point end, ThreadStats& stats) {
+    std::mt19937 rng(c.seed * 7919u + static_cast<uint32_t>(index));
+    std::discrete_distribution<int> mix(std::begin(c.weights), std::end(c.weights));
+
+    std::vector<Session> sessions;
+    for (int i = index; i < c.sessions; i += c.threads) {
+        sessions.emplace_back();
+        try {
+            open_session(sessions.back(), host, port, stats, true);
+        } catch (const std::exception& e) {
+            ++stats.errors[LOGIN];
+            E7_LOG_ERROR("Session %d failed to log in: %s", i, e.what());
+            sessions.pop_back();
+        }
+    }
+
+    size_t next = 0;
+    while (!sessions.empty() && Clock::now() < end) {
+        Session& s = sessions[next++ % sessions.size()];
+        Op op = static_cast<Op>(mix(rng));
+        auto start = Clock::now();
+        bool measured = start >= measure_from;
+        try {
+            run_operation(s, op, rng);
+            if (measured) stats.latency[op].record(micros_since(start));
+        } catch (const std::exception& e) {
+            if (measured) ++stats.errors[op];
+            // A failed call can leave replies in flight; start the session over
+            ++stats.replaced_sessions;
+            try {
+                open_session(s, host, port, stats, measured);
+            } catch (const std::exception&) {
+                if (measured) ++stats.errors[LOGIN];
+            }
+        }
+    }
+}
+
+double ms(uint32_t us) {
+    return us / 1000.0;
+}
+
+void print_row(const char* name, const HistogramSnapshot& h, uint64_t errors, double seconds) {
+    std::printf("%-18s %9llu %7llu %10.1f %9.2f %9.2f %9.2f %9.2f %9.2f\n", name,
+                static_cast<unsigned long long>(h.count), static_cast<unsigned long long>(errors),
+                h.count / seconds, ms(h.p50_us), ms(h.p90_us), ms(h.p99_us), ms(h.p999_us), ms(h.max_us));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Config c = parse_args(argc, argv);
+    // The client logs every control at INFO
+    Logger::initialize(LogLevel::WARNING);
+
+    std::unique_ptr<MockHub> hub;
+    std::string host = c.host;
+    int port = c.port;
+    if (host.empty()) {
+        hub = std::make_unique<MockHub>(c.hub);
+        hub->start();
+        host = c.hub.host;
+        port = hub->port();
+    }
+
+    std::vector<std::unique_ptr<ThreadStats>> stats;
+    std::vector<std::thread> threads;
+    auto begin = Clock::now();
+    auto measure_from = begin + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(c.warmup_s));
+    auto end = measure_from + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(c.duration_s));
+    for (int t = 0; t < c.threads; ++t) {
+        stats.push_back(std::make_unique<ThreadStats>());
+        threads.emplace_back(worker, std::cref(c), std::cref(host), port, t, measure_from, end, std::ref(*stats.back()));
+    }
+    for (std::thread& t : threads) t.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - measure_from).count();
+    if (hub) hub->stop();
+
+    LatencyHistogram per_op[OP_COUNT];
+    LatencyHistogram total;
+    uint64_t errors[OP_COUNT] = {};
+    uint64_t total_errors = 0, replaced = 0;
+    for (const auto& s : stats) {
+        for (int op = 0; op < OP_COUNT; ++op) {
+            per_op[op].merge(s->latency[op]);
+            if (op != LOGIN) total.merge(s->latency[op]);
+            errors[op] += s->errors[op];
+            if (op != LOGIN) total_errors += s->errors[op];
+        }
+        replaced += s->replaced_sessions;
+    }
+
+    std::printf("e7-loadgen: %d sessions on %d threads against %s:%d%s, %.1f s measured after %.1f s warm-up\n",
+                c.sessions, c.threads, host.c_str(), port, hub ? " (embedded mock hub)" : "", seconds, c.warmup_s);
+    if (hub) {
+        std::printf("mock hub: %d switches, %d ACs, latency %d+%d ms\n", c.hub.switches, c.hub.acs,
+                    c.hub.latency_ms, c.hub.jitter_ms);
+    }
+    std::printf("\n%-18s %9s %7s %10s %9s %9s %9s %9s %9s\n", "operation", "count", "errors", "ops/s",
+                "p50 ms", "p90 ms", "p99 ms", "p99.9 ms", "max ms");
+    for (int op = 0; op < OP_COUNT; ++op) {
+        HistogramSnapshot h = per_op[op].snapshot();
+        if (h.count > 0 || errors[op] > 0) print_row(OP_NAMES[op], h, errors[op], seconds);
+    }
+    HistogramSnapshot all = total.snapshot();
+    print_row("total", all, total_errors, seconds);
+    if (replaced > 0) {
+        std::printf("\n%llu sessions replaced after a failed call\n", static_cast<unsigned long long>(replaced));
+    }
+
+    int status = 0;
+    double ops_per_sec = all.count / seconds;
+    if (c.min_ops_per_sec > 0 && ops_per_sec < c.min_ops_per_sec) {
+        std::printf("FAIL: %.1f ops/s is below --min-ops-per-sec %.1f\n", ops_per_sec, c.min_ops_per_sec);
+        status = 1;
+    }
+    if (c.max_p99_ms > 0 && ms(all.p99_us) > c.max_p99_ms) {
+        std::printf("FAIL: p99 %.2f ms is above --max-p99-ms %.2f\n", ms(all.p99_us), c.max_p99_ms);
+        status = 1;
+    }
+    return status;
+}
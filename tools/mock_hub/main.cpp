@@ -0,0 +1,88 @@
+// Local mock of the Switcher hub for offline runs and load tests.
+//
+// Usage: e7-mock-hub [--host 127.0.0.1] [--port 9091] [--switches 4] [--acs 2]
+//                    [--latency-ms 0] [--jitter-ms 0] [--push-interval-ms 0] [--seed 1]
+//
+// Point the client at it with ConnectionOptions::host/port (or --host/--port
+// in the desktop example); any account and password log in.
+
+#include "mock_hub.h"
+#include "e7-switcher/logger.h"
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <thread>
+
+using namespace e7_switcher;
+
+namespace {
+
+std::atomic<bool> g_stop{false};
+
+void on_signal(int) {
+    g_stop = true;
+}
+
+std::map<std::string, std::string> parse_args(int argc, char* argv[]) {
+    std::map<std::string, std::string> args;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.substr(0, 2) == "--" && i + 1 < argc) {
+            args[arg.substr(2)] = argv[++i];
+        } else {
+            std::fprintf(stderr, "Unexpected argument: %s\n", argv[i]);
+            std::exit(2);
+        }
+    }
+    return args;
+}
+
+int int_arg(const std::map<std::string, std::string>& args, const char* name, int fallback) {
+    auto it = args.find(name);
+    return it == args.end() ? fallback : std::stoi(it->second);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Logger::initialize();
+    auto args = parse_args(argc, argv);
+
+    MockHubOptions options;
+    if (args.count("host")) options.host = args["host"];
+    options.port = int_arg(args, "port", options.port);
+    options.switches = int_arg(args, "switches", options.switches);
+    options.acs = int_arg(args, "acs", options.acs);
+    options.latency_ms = int_arg(args, "latency-ms", options.latency_ms);
+    options.jitter_ms = int_arg(args, "jitter-ms", options.jitter_ms);
+    options.push_interval_ms = int_arg(args, "push-interval-ms", options.push_interval_ms);
+    options.seed = static_cast<uint32_t>(int_arg(args, "seed", static_cast<int>(options.seed)));
+
+    MockHub hub(options);
+    try {
+        hub.start();
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    std::signal(SIGINT, on_signal);
+    std::signal(SIGTERM, on_signal);
+
+    E7_LOG_INFO("Mock hub on %s:%d: %d switches, %d ACs, latency %d+%d ms, pushes every %d ms",
+                options.host.c_str(), hub.port(), options.switches, options.acs,
+                options.latency_ms, options.jitter_ms, options.push_interval_ms);
+    while (!g_stop) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    hub.stop();
+    E7_LOG_INFO("Served %llu requests over %llu connections",
+                static_cast<unsigned long long>(hub.requests()),
+                static_cast<unsigned long long>(hub.connections()));
+    return 0;
+}
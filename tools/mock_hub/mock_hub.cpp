@@ -0,0 +1,551 @@
+#include "mock_hub.h"
+#include "fixtures.h"
+#include "e7-switcher/constants.h"
+#include "e7-switcher/crc.h"
+#include "e7-switcher/crypto.h"
+#include "e7-switcher/logger.h"
+#include "e7-switcher/message_schemas.h"
+#include "e7-switcher/message_stream.h"
+#include "e7-switcher/messages.h"
+#include "e7-switcher/transport.h"
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace e7_switcher {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Served as every AC's code id and IR set
+const char* const AC_CODE_ID = "MOCK0001";
+const char* const IR_PROTOCOL_PARA = "mock";
+
+int64_t now_seconds() {
+    return std::chrono::duration_cast<std::chrono::seconds>(Clock::now().time_since_epoch()).count();
+}
+
+std::string unhex(const std::string& hex) {
+    std::string out;
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+        out += static_cast<char>(std::stoi(hex.substr(i, 2), nullptr, 16));
+    }
+    return out;
+}
+
+int token_index(const std::vector<std::string>& tokens, const std::string& token) {
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        if (token == tokens[i]) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+// Key for every mode / temperature / fan / swing, plus "off"; each HexCode is
+// the key name in hex so a control string can be mapped back to a state
+std::string ir_set_json() {
+    fixtures::IRSet set;
+    set.hex_code = fixtures::hex_of;
+    set.set_id = AC_CODE_ID;
+    set.protocol_para = IR_PROTOCOL_PARA;
+    return fixtures::ir_set_json(set);
+}
+
+// Transport over a connection accepted by the hub. Receives poll once a
+// second so the serving thread notices stop(); timed_out() tells such a
+// poll apart from a failure after MessageStream has thrown.
+class AcceptedTransport : public Transport {
+public:
+    explicit AcceptedTransport(net::SocketHandle sock) : sock_(sock) {
+        std::string err;
+        (void)net::set_recv_timeout(sock_, 1, err);
+        // Acks and responses are separate small writes; without this the
+        // second waits on the client's delayed ACK
+        (void)net::set_nodelay(sock_, true, err);
+    }
+    ~AcceptedTransport() override { close(); }
+
+    void connect(const std::string&, int, int) override {
+        if (!is_open()) throw std::runtime_error("Connection already closed");
+    }
+    void close() override {
+        if (sock_ != net::INVALID_SOCKET_HANDLE) net::close(sock_);
+    }
+    bool is_open() const override { return sock_ != net::INVALID_SOCKET_HANDLE; }
+    void send(const uint8_t* data, size_t len) override {
+        std::string err;
+        if (!is_open()) throw std::runtime_error("Not connected");
+        if (!net::send_all(sock_, data, len, err)) throw std::runtime_error("Send failed: " + err);
+    }
+    int receive(uint8_t* buf, size_t max_len, int, std::string& err) override {
+        int n = net::recv_some(sock_, buf, max_len, err);
+        timed_out_ = n == -2;
+        return n;
+    }
+
+    bool timed_out() const { return timed_out_; }
+
+private:
+    net::SocketHandle sock_;
+    bool timed_out_ = false;
+};
+
+} // namespace
+
+struct MockHub::Device {
+    int32_t did = 0;
+    std::string name;
+    bool is_ac = false;
+    std::string password; // plaintext; clients get it encrypted with their session key
+    std::string mac;
+
+    // Power and auto-off deadline (0 when none)
+    bool on = false;
+    int64_t on_since = 0;
+    int64_t off_at = 0;
+    int auto_closing_secs = 0;
+
+    // AC
+    int mode = static_cast<int>(ACMode::COOL);
+    int temperature = 24;
+    int fan = static_cast<int>(ACFanSpeed::FAN_AUTO);
+    int swing = static_cast<int>(ACSwing::SWING_OFF);
+    float room_temperature = 26.5f;
+
+    void set_on(bool value, int operation_minutes) {
+        int64_t now = now_seconds();
+        if (value && !on) on_since = now;
+        on = value;
+        auto_closing_secs = value ? operation_minutes * 60 : 0;
+        off_at = auto_closing_secs > 0 ? now + auto_closing_secs : 0;
+    }
+
+    // Apply an expired auto-off timer
+    void refresh() {
+        if (on && off_at > 0 && now_seconds() >= off_at) set_on(false, 0);
+    }
+
+    std::vector<uint8_t> work_status() const {
+        int64_t now = now_seconds();
+        int open_time = on ? static_cast<int>(now - on_since) : 0;
+        int remaining = on && off_at > 0 ? static_cast<int>(off_at - now) : 0;
+        if (!is_ac) {
+            SwitchStatus s{};
+            s.wifi_power = 72;
+            s.switch_state = on;
+            s.remaining_time = remaining;
+            s.open_time = open_time;
+            s.auto_closing_time = auto_closing_secs;
+            s.is_delay = off_at > 0;
+            std::vector<uint8_t> out(schema::SwitchWorkStatus::size);
+            schema::SwitchWorkStatus::encode(s, out.data());
+            return out;
+        }
+        ACStatus s{};
+        s.wifi_power = 68;
+        s.temperature = room_temperature;
+        s.ac_data = {static_cast<uint8_t>(on), static_cast<uint8_t>(mode), static_cast<uint8_t>(temperature),
+                     static_cast<uint8_t>(fan * 16 + swing)};
+        s.temperature_unit = 0;
+        s.device_type = 1;
+        s.code_id = AC_CODE_ID;
+        s.open_time = open_time;
+        s.auto_closing_time = auto_closing_secs;
+        s.is_delay = off_at > 0;
+        std::vector<uint8_t> out(schema::ACWorkStatus::size);
+        schema::ACWorkStatus::encode(s, out.data());
+        return out;
+    }
+};
+
+struct MockHub::Connection {
+    explicit Connection(net::SocketHandle sock) {
+        auto transport = std::make_unique<AcceptedTransport>(sock);
+        accepted = transport.get();
+        stream = std::make_unique<MessageStream>(std::move(transport));
+    }
+
+    AcceptedTransport* accepted; // owned by stream
+    std::unique_ptr<MessageStream> stream;
+    std::atomic<bool> done{false};
+
+    // Sends come from the serving thread and the push thread
+    std::mutex send_mutex;
+    std::vector<uint8_t> tx;
+
+    // Session, set at login (under send_mutex, before logged_in)
+    std::atomic<bool> logged_in{false};
+    int32_t session_id = 0;
+    int32_t user_id = 0;
+    SessionCrc crc;
+    std::unique_ptr<AesEcbCipher> cipher;
+};
+
+MockHub::MockHub(MockHubOptions options) : options_(std::move(options)), rng_(options_.seed) {
+    int32_t did = 100001;
+    for (int i = 0; i < options_.switches + options_.acs; ++i) {
+        Device d;
+        d.is_ac = i >= options_.switches;
+        d.name = d.is_ac ? "AC " + std::to_string(i - options_.switches + 1) : "Switch " + std::to_string(i + 1);
+        d.did = did++;
+        d.password = "pwd" + std::to_string(d.did);
+        char mac[18];
+        std::snprintf(mac, sizeof(mac), "E7:00:00:%02X:%02X:%02X", (i >> 16) & 0xFF, (i >> 8) & 0xFF, i & 0xFF);
+        d.mac = mac;
+        fleet_.push_back(std::move(d));
+    }
+
+    std::vector<uint8_t> gz = fixtures::gzip(ir_set_json());
+    ir_config_payload_.assign(3, 0);
+    ir_config_payload_.insert(ir_config_payload_.end(), gz.begin(), gz.end());
+}
+
+MockHub::~MockHub() {
+    stop();
+}
+
+void MockHub::start() {
+    std::string err;
+    if (!net::startup(err)) {
+        throw std::runtime_error("Socket startup failed: " + err);
+    }
+    if (!net::listen_tcp(listener_, options_.host, options_.port, 64, err)) {
+        throw std::runtime_error("Cannot listen on " + options_.host + ":" + std::to_string(options_.port) + ": " + err);
+    }
+    port_ = net::local_port(listener_);
+    running_ = true;
+    accept_thread_ = std::thread(&MockHub::accept_loop, this);
+    if (options_.push_interval_ms > 0) {
+        push_thread_ = std::thread(&MockHub::push_loop, this);
+    }
+}
+
+void MockHub::stop() {
+    if (!running_.exchange(false)) return;
+    if (accept_thread_.joinable()) accept_thread_.join();
+    if (push_thread_.joinable()) push_thread_.join();
+    net::close(listener_);
+
+    std::lock_guard<std::mutex> lock(workers_mutex_);
+    for (Worker& w : workers_) {
+        if (w.thread.joinable()) w.thread.join();
+    }
+    workers_.clear();
+}
+
+void MockHub::accept_loop() {
+    while (running_) {
+        net::SocketHandle sock;
+        std::string err;
+        int r = net::accept(listener_, sock, 200, err);
+        if (r == -2) continue;
+        if (r < 0) {
+            E7_LOG_WARNING("Accept failed: %s", err.c_str());
+            continue;
+        }
+        connections_.fetch_add(1, std::memory_order_relaxed);
+
+        std::lock_guard<std::mutex> lock(workers_mutex_);
+        for (auto it = workers_.begin(); it != workers_.end();) {
+            if (it->conn->done) {
+                it->thread.join();
+                it = workers_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        auto conn = std::make_shared<Connection>(sock);
+        workers_.push_back(Worker{conn, std::thread([this, conn] { serve(*conn); })});
+    }
+}
+
+void MockHub::serve(Connection& conn) {
+    while (running_) {
+        ProtocolMessageView request;
+        try {
+            request = conn.stream->receive_view();
+        } catch (const std::exception&) {
+            if (conn.accepted->timed_out()) continue;
+            break; // closed or failed
+        }
+        requests_.fetch_add(1, std::memory_order_relaxed);
+
+        try {
+            if (request.cmd() == CMD_LOGIN) {
+                on_login(conn, request);
+                continue;
+            }
+            if (!conn.logged_in || static_cast<int32_t>(request.session()) != conn.session_id) {
+                reply(conn, request, 1, {});
+                continue;
+            }
+            switch (request.cmd()) {
+            case CMD_DEVICE_LIST: on_device_list(conn, request); break;
+            case CMD_DEVICE_QUERY: on_query(conn, request); break;
+            case CMD_DEVICE_CONTROL: on_control(conn, request); break;
+            case CMD_AC_IR_CONFIG_QUERY: on_ir_config(conn, request); break;
+            case CMD_HEARTBEAT: reply(conn, request, 0, {}); break;
+            default:
+                E7_LOG_WARNING("Ignoring unknown command 0x%04X", request.cmd());
+                break;
+            }
+        } catch (const std::exception& e) {
+            // malformed payload; the connection stays usable
+            E7_LOG_WARNING("Bad 0x%04X request: %s", request.cmd(), e.what());
+            reply(conn, request, 1, {});
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(conn.send_mutex);
+    conn.logged_in = false;
+    conn.stream->close();
+    conn.done = true;
+}
+
+void MockHub::on_login(Connection& conn, const ProtocolMessageView& request) {
+    // Only checks that the request decrypts; any account is accepted
+    std::vector<uint8_t> plain(request.payload().begin(), request.payload().end());
+    protocol_cipher(ProtocolKey::V2_50).decrypt_in_place(plain);
+
+    PhoneLoginRecord rec{};
+    rec.session_id = static_cast<int32_t>(next_session_.fetch_add(1));
+    rec.user_id = 0x20000 + rec.session_id;
+    rec.communication_secret_key.resize(32);
+    {
+        std::lock_guard<std::mutex> lock(rng_mutex_);
+        for (uint8_t& b : rec.communication_secret_key) b = static_cast<uint8_t>(rng_());
+    }
+    rec.heartbeat_secs = 60;
+    rec.reply_timeout_secs = 10;
+
+    const size_t plain_len = schema::PhoneLoginHead::size + 2 + schema::PhoneLoginTail::size;
+    std::vector<uint8_t> payload(AesEcbCipher::padded_size(plain_len));
+    schema::PhoneLoginHead::encode(rec, payload.data());
+    // block_a and block_b are empty (u16 length 0)
+    schema::PhoneLoginTail::encode(rec, payload.data() + schema::PhoneLoginHead::size + 2);
+    protocol_cipher(ProtocolKey::V2_50).encrypt_in_place(payload, plain_len);
+
+    delay();
+    std::lock_guard<std::mutex> lock(conn.send_mutex);
+    // The login reply itself carries no session key in its CRC
+    FrameBuilder fb(conn.tx);
+    fb.begin(CMD_LOGIN, 0, request.serial(), request.control_attr(), 0, 0, 0, payload.size(), true);
+    fb.put(payload);
+    fb.finish(SessionCrc());
+    conn.stream->send_message(conn.tx);
+
+    conn.session_id = rec.session_id;
+    conn.user_id = rec.user_id;
+    conn.crc = SessionCrc(rec.communication_secret_key);
+    conn.cipher = std::make_unique<AesEcbCipher>(rec.communication_secret_key.data(), 32);
+    conn.logged_in = true;
+}
+
+void MockHub::on_device_list(Connection& conn, const ProtocolMessageView& request) {
+    std::string json = "{\"Result\":0,\"DevList\":[";
+    {
+        std::lock_guard<std::mutex> lock(fleet_mutex_);
+        for (size_t i = 0; i < fleet_.size(); ++i) {
+            Device& d = fleet_[i];
+            d.refresh();
+            // Zero-padded rather than PKCS7: the client keeps whatever padding
+            // it decrypts and sends the password on zero-padded to 32 bytes
+            std::vector<uint8_t> pwd(d.password.begin(), d.password.end());
+            pwd.resize((pwd.size() + AesEcbCipher::BLOCK_SIZE - 1) / AesEcbCipher::BLOCK_SIZE * AesEcbCipher::BLOCK_SIZE);
+            conn.cipher->encrypt_blocks(pwd.data(), pwd.data(), pwd.size());
+            std::vector<uint8_t> status = d.work_status();
+
+            if (i > 0) json += ',';
+            json += "{\"DeviceName\":\"" + d.name + "\",\"APSSID\":\"mock-net\",\"DMAC\":\"" + d.mac +
+                    "\",\"DeviceType\":\"" + (d.is_ac ? "0E01" : "0F04") +
+                    "\",\"FirmwareMark\":\"E7\",\"FirmwareVersion\":\"1.0.0\",\"OnlineStatus\":1"
+                    ",\"LineNo\":1,\"LineType\":1,\"DID\":" + std::to_string(d.did) +
+                    ",\"VisitPwd\":\"" + fixtures::base64_encode(pwd.data(), pwd.size()) +
+                    "\",\"WorkStatus\":\"" + fixtures::base64_encode(status.data(), status.size()) + "\"}";
+        }
+    }
+    json += "]}";
+
+    delay();
+    reply(conn, request, 0, std::vector<uint8_t>(json.begin(), json.end()));
+}
+
+void MockHub::on_query(Connection& conn, const ProtocolMessageView& request) {
+    DeviceQueryRequest query = schema::DeviceQuery::decode<DeviceQueryRequest>(request.payload());
+    std::vector<uint8_t> status;
+    {
+        std::lock_guard<std::mutex> lock(fleet_mutex_);
+        if (Device* d = find_device(query.device_id)) {
+            status = status_payload(*d, CMD_DEVICE_QUERY, request.serial(), request.timestamp());
+        }
+    }
+    uint8_t errcode = status.empty() ? 1 : 0;
+
+    delay();
+    reply(conn, request, errcode, {}); // ack
+    delay();
+    reply(conn, request, errcode, status);
+}
+
+void MockHub::on_control(Connection& conn, const ProtocolMessageView& request) {
+    ByteSpan payload = request.payload();
+    uint8_t errcode = 0;
+    std::vector<uint8_t> status;
+    {
+        std::lock_guard<std::mutex> lock(fleet_mutex_);
+        // Both layouts start with the device id, user id and encrypted password
+        Device* d = payload.size() >= 40 ? find_device(static_cast<int32_t>(wire::U32::get(payload.data()))) : nullptr;
+        if (!d) {
+            errcode = 1;
+        } else {
+            // The password arrives as raw NATIVE-key blocks of the zero-padded plaintext
+            uint8_t expected[32] = {};
+            std::memcpy(expected, d->password.data(), std::min(d->password.size(), sizeof(expected)));
+            protocol_cipher(ProtocolKey::NATIVE).encrypt_blocks(expected, expected, sizeof(expected));
+            if (std::memcmp(expected, payload.data() + 8, sizeof(expected)) != 0) errcode = 3;
+        }
+
+        if (errcode == 0 && d->is_ac) {
+            ACControlHeader header = schema::ACControl::decode<ACControlHeader>(payload);
+            size_t control_len = header.control_len >= 4 ? header.control_len - 4u : 0u;
+            ByteSpan control = payload.subspan(schema::ACControl::size, control_len);
+            std::string control_str(control.begin(), control.end());
+            size_t bar = control_str.find('|');
+            std::string key = bar == std::string::npos ? "" : unhex(control_str.substr(bar + 1));
+
+            if (key == "off") {
+                d->set_on(false, 0);
+            } else {
+                // e.g. "aa24_f1_d0"
+                size_t u1 = key.find('_'), u2 = key.rfind('_');
+                int mode = token_index(fixtures::ac_mode_tokens(), key.substr(0, 2));
+                int fan = u1 == std::string::npos ? -1 : token_index(fixtures::ac_fan_tokens(), key.substr(u1 + 1, 2));
+                int swing = u2 == std::string::npos ? -1 : token_index(fixtures::ac_swing_tokens(), key.substr(u2 + 1));
+                if (mode < 0 || fan < 0 || swing < 0) {
+                    errcode = 2;
+                } else {
+                    d->mode = mode + 1;
+                    d->temperature = std::stoi(key.substr(2, u1 - 2));
+                    d->fan = fan + 1;
+                    d->swing = swing;
+                    d->set_on(true, static_cast<int>(header.operation_time));
+                }
+            }
+        } else if (errcode == 0) {
+            SwitchControlPayload control = schema::SwitchControl::decode<SwitchControlPayload>(payload);
+            d->set_on(control.on_or_off != 0, static_cast<int>(control.operation_time));
+        }
+
+        if (d) {
+            status = status_payload(*d, CMD_DEVICE_CONTROL, request.serial(), request.timestamp());
+        }
+    }
+
+    delay();
+    reply(conn, request, errcode, {});
+    delay();
+    push(conn, errcode, status);
+}
+
+void MockHub::on_ir_config(Connection& conn, const ProtocolMessageView& request) {
+    IRConfigQueryRequest query = schema::IRConfigQuery::decode<IRConfigQueryRequest>(request.payload());
+    delay();
+    if (query.ac_code_id != AC_CODE_ID) {
+        reply(conn, request, 1, {});
+        return;
+    }
+    reply(conn, request, 0, ir_config_payload_);
+}
+
+void MockHub::reply(Connection& conn, const ProtocolMessageView& request, uint8_t errcode,
+                    const std::vector<uint8_t>& payload) {
+    std::lock_guard<std::mutex> lock(conn.send_mutex);
+    build_protocol_frame(conn.tx, request.cmd(), conn.session_id, request.serial(), request.control_attr(), 0,
+                         errcode, conn.user_id, payload.data(), payload.size(), conn.crc);
+    conn.stream->send_message(conn.tx);
+}
+
+void MockHub::push(Connection& conn, uint8_t errcode, const std::vector<uint8_t>& payload) {
+    std::lock_guard<std::mutex> lock(conn.send_mutex);
+    if (!conn.logged_in) return;
+    build_protocol_frame(conn.tx, CMD_DEVICE_QUERY, conn.session_id, 0, 0, 0, errcode, conn.user_id,
+                         payload.data(), payload.size(), conn.crc);
+    conn.stream->send_message(conn.tx);
+}
+
+std::vector<uint8_t> MockHub::status_payload(Device& device, uint16_t original_cmd, uint16_t serial,
+                                             uint32_t timestamp) {
+    device.refresh();
+    std::vector<uint8_t> status = device.work_status();
+
+    DeviceQueryPrefix prefix;
+    prefix.original_cmd = original_cmd;
+    prefix.original_serial = serial;
+    prefix.original_timestamp = timestamp;
+    prefix.state_flag = 0;
+    prefix.rest_len = static_cast<uint16_t>(32 + 1 + 2 + status.size());
+    std::memcpy(prefix.device_name.data(), device.name.data(), std::min(device.name.size(), prefix.device_name.size()));
+    prefix.online_state = 1;
+    prefix.status_len = static_cast<uint16_t>(status.size());
+
+    std::vector<uint8_t> out(schema::QueryPrefix::size);
+    schema::QueryPrefix::encode(prefix, out.data());
+    out.insert(out.end(), status.begin(), status.end());
+    return out;
+}
+
+void MockHub::push_loop() {
+    auto next = Clock::now();
+    while (running_) {
+        next += std::chrono::milliseconds(options_.push_interval_ms);
+        while (running_ && Clock::now() < next) {
+            std::this_thread::sleep_for(std::min<Clock::duration>(next - Clock::now(), std::chrono::milliseconds(100)));
+        }
+        if (!running_ || fleet_.empty()) continue;
+
+        std::vector<uint8_t> status;
+        {
+            std::lock_guard<std::mutex> rng_lock(rng_mutex_);
+            std::lock_guard<std::mutex> lock(fleet_mutex_);
+            Device& d = fleet_[rng_() % fleet_.size()];
+            d.set_on(!d.on, 0);
+            status = status_payload(d, 0, 0, 0);
+        }
+
+        std::vector<std::shared_ptr<Connection>> targets;
+        {
+            std::lock_guard<std::mutex> lock(workers_mutex_);
+            for (const Worker& w : workers_) {
+                if (w.conn->logged_in) targets.push_back(w.conn);
+            }
+        }
+        for (const auto& conn : targets) {
+            try {
+                push(*conn, 0, status);
+            } catch (const std::exception&) {
+                // connection went away; its serving thread cleans up
+            }
+        }
+    }
+}
+
+void MockHub::delay() {
+    int ms = options_.latency_ms;
+    if (options_.jitter_ms > 0) {
+        std::lock_guard<std::mutex> lock(rng_mutex_);
+        ms += static_cast<int>(rng_() % static_cast<uint32_t>(options_.jitter_ms + 1));
+    }
+    if (ms > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+}
+
+MockHub::Device* MockHub::find_device(int32_t did) {
+    for (Device& d : fleet_) {
+        if (d.did == did) return &d;
+    }
+    return nullptr;
+}
+
+} // namespace e7_switcher
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "e7-switcher/parser.h"
+#include "e7-switcher/socket_utils.h"
+
+namespace e7_switcher {
+
+struct MockHubOptions {
+    std::string host = "127.0.0.1";
+    int port = 9091;        // 0 picks a free port (see MockHub::port())
+    int switches = 4;       // named "Switch 1" .. "Switch N"
+    int acs = 2;            // named "AC 1" .. "AC N"
+    int latency_ms = 0;     // added before every reply
+    int jitter_ms = 0;      // plus a uniform 0..jitter_ms on top
+    int push_interval_ms = 0; // unsolicited status pushes; 0 disables them
+    uint32_t seed = 1;
+};
+
+/**
+ * Local stand-in for the Switcher hub, for running the client (and load
+ * generators) offline. Frames are read and written with the library's own
+ * framing, CRC and cipher code, so the client cannot tell it from the hub.
+ *
+ * Any account and password log in. Each login gets a fresh session id and
+ * communication key; all sessions share one synthetic fleet, so a control
+ * from one connection shows up in another's queries. Device passwords are
+ * checked on control commands, and AC control strings are decoded back into
+ * mode, temperature, fan and swing (the served IR sets encode each key name
+ * in its HexCode).
+ *
+ * Controls are answered with an ack and then a status push, as the hub does.
+ * Periodic pushes (push_interval_ms) toggle a random device and notify every
+ * logged-in connection; clients that expect strict request/response pairs
+ * will see them as stray frames.
+ */
+class MockHub {
+public:
+    explicit MockHub(MockHubOptions options);
+    ~MockHub();
+
+    MockHub(const MockHub&) = delete;
+    MockHub& operator=(const MockHub&) = delete;
+
+    // Bind and start serving on background threads; throws std::runtime_error
+    void start();
+    // Close the listener and every connection, then join all threads
+    void stop();
+
+    // Port actually bound (differs from options.port when that was 0)
+    int port() const { return port_; }
+
+    // Requests served so far, all connections together
+    uint64_t requests() const { return requests_.load(std::memory_order_relaxed); }
+    uint64_t connections() const { return connections_.load(std::memory_order_relaxed); }
+
+private:
+    struct Device;
+    struct Connection;
+    struct Worker {
+        std::shared_ptr<Connection> conn;
+        std::thread thread;
+    };
+
+    void accept_loop();
+    void serve(Connection& conn);
+    void push_loop();
+
+    // Per-command handlers; each sends its replies on conn
+    void on_login(Connection& conn, const ProtocolMessageView& request);
+    void on_device_list(Connection& conn, const ProtocolMessageView& request);
+    void on_query(Connection& conn, const ProtocolMessageView& request);
+    void on_control(Connection& conn, const ProtocolMessageView& request);
+    void on_ir_config(Connection& conn, const ProtocolMessageView& request);
+
+    // Frame answering request (same cmd and serial) in the connection's session
+    void reply(Connection& conn, const ProtocolMessageView& request, uint8_t errcode,
+               const std::vector<uint8_t>& payload);
+    // Status push in the query response layout; payload from status_payload()
+    void push(Connection& conn, uint8_t errcode, const std::vector<uint8_t>& payload);
+    // Query prefix and work status of a device; needs fleet_mutex_ held
+    std::vector<uint8_t> status_payload(Device& device, uint16_t original_cmd, uint16_t serial,
+                                        uint32_t timestamp);
+    // Sleep for the configured latency plus jitter
+    void delay();
+
+    // Needs fleet_mutex_ held; nullptr if there is no such device
+    Device* find_device(int32_t did);
+
+    MockHubOptions options_;
+    int port_ = 0;
+    net::SocketHandle listener_ = net::INVALID_SOCKET_HANDLE;
+    std::atomic<bool> running_{false};
+
+    std::thread accept_thread_;
+    std::thread push_thread_;
+
+    // One per accepted connection; finished ones are joined on the next accept
+    std::mutex workers_mutex_;
+    std::vector<Worker> workers_;
+
+    // Fleet state, shared by every session
+    std::mutex fleet_mutex_;
+    std::vector<Device> fleet_;
+    // IR config reply for every AC: 3 bytes, then the gzipped code set
+    std::vector<uint8_t> ir_config_payload_;
+
+    std::mutex rng_mutex_;
+    std::mt19937 rng_;
+
+    std::atomic<uint64_t> requests_{0};
+    std::atomic<uint64_t> connections_{0};
+    std::atomic<uint32_t> next_session_{0x1000};
+};
+
+} // namespace e7_switcher